@@ -0,0 +1,26 @@
+// SentinelLED — shared helpers for the Sentinel UNO Q sketches.
+//
+// Include this header first; it pulls in every module and makes the
+// library's src/ directory visible to the Arduino library resolver.
+
+#pragma once
+
+#include "color.h"
+#include "fixmath.h"
+#include "oscillator.h"
+#include "warp_field.h"
+#include "perf_stats.h"
+#include "wire_format.h"
+#include "ws2812_out.h"
+#include "led_mode.h"
+#include "compositor.h"
+#include "triple_buffer.h"
+#include "state_store.h"
+#include "mcu_watchdog.h"
+#include "mode_abacus.h"
+#include "mode_orbital.h"
+#include "mode_heatmap.h"
+#include "mode_treemap.h"
+#include "anim_vm.h"
+#include "mode_anim.h"
+#include "text_scroller.h"
@@ -0,0 +1,254 @@
+#include "anim_vm.h"
+
+#include <string.h>
+
+#include "fixmath.h"
+#include "oscillator.h"
+#include "wire_format.h"
+
+// WAVE duty per OscWave: full-cycle saws, a 30% pulse, square blink.
+static const uint32_t WAVE_DUTY[OSC_WAVE_COUNT] = {
+  OSC_DUTY_HALF, OSC_DUTY_FULL, OSC_DUTY_FULL, OSC_DUTY_HALF, 19661, OSC_DUTY_HALF,
+};
+
+// Operand bytes and stack effect of each opcode; pops < 0 marks an invalid one.
+struct OpInfo {
+  int8_t pops;
+  int8_t pushes;
+  uint8_t operand;
+};
+
+static OpInfo opInfo(uint8_t op) {
+  switch (op) {
+    case ANIM_OP_END: return {0, 0, 0};
+    case ANIM_OP_PUSH8: return {0, 1, 1};
+    case ANIM_OP_PUSH16: return {0, 1, 2};
+    case ANIM_OP_LD: return {0, 1, 1};
+    case ANIM_OP_ST: return {1, 0, 1};
+    case ANIM_OP_DUP: return {1, 2, 0};
+    case ANIM_OP_DROP: return {1, 0, 0};
+    case ANIM_OP_SWAP: return {2, 2, 0};
+    case ANIM_OP_NEG:
+    case ANIM_OP_ABS:
+    case ANIM_OP_SIN:
+    case ANIM_OP_CLAMP8:
+    case ANIM_OP_PHASE: return {1, 1, 0};
+    case ANIM_OP_WAVE: return {1, 1, 1};
+    case ANIM_OP_JMP: return {0, 0, 1};
+    case ANIM_OP_JZ: return {1, 0, 1};
+    case ANIM_OP_OUT: return {3, 0, 0};
+    default:
+      if (op >= ANIM_OP_ADD && op <= ANIM_OP_MULQ) return {2, 1, 0};
+      return {-1, 0, 0};
+  }
+}
+
+AnimChunkResult anim_loader_feed(AnimLoader &loader, const uint8_t *chunk, uint16_t n) {
+  if (n < ANIM_CHUNK_HEADER) return ANIM_CHUNK_REJECTED;
+  uint16_t offset = rd_u16le(chunk);
+  uint16_t total = rd_u16le(chunk + 2);
+  uint16_t len = n - ANIM_CHUNK_HEADER;
+  if (offset == 0) {
+    loader.len = 0;
+    loader.total = total;
+  }
+  if (offset != loader.len || total != loader.total || total > ANIM_IMAGE_MAX || len > total - offset) {
+    loader.len = 0;
+    loader.total = 0;
+    return ANIM_CHUNK_REJECTED;
+  }
+  memcpy(loader.image + offset, chunk + ANIM_CHUNK_HEADER, len);
+  loader.len += len;
+  return loader.len == total ? ANIM_CHUNK_COMPLETE : ANIM_CHUNK_MORE;
+}
+
+bool anim_parse(const uint8_t *image, uint16_t n, AnimProgram &out) {
+  if (n < ANIM_HEADER + 2 || image[0] != ANIM_MAGIC || image[1] != ANIM_VERSION) return false;
+  uint16_t frame_ms = rd_u16le(image + 2);
+  uint16_t code_len = rd_u16le(image + 4);
+  if (code_len > ANIM_CODE_MAX || n != ANIM_HEADER + code_len + 2) return false;
+  if (rd_u16le(image + n - 2) != crc16_ccitt(image, n - 2)) return false;
+  if (frame_ms != 0 && (frame_ms < ANIM_MIN_FRAME_MS || frame_ms > ANIM_MAX_FRAME_MS)) return false;
+  const uint8_t *code = image + ANIM_HEADER;
+
+  // Stack depth on entry to each byte offset (and to code_len, the implied
+  // END) that a jump lands on, -1 if none; a fall-through must agree with it.
+  // Jumps only go forward, so one pass sees every jump before its target.
+  int8_t joinDepth[ANIM_CODE_MAX + 1];
+  memset(joinDepth, -1, sizeof(joinDepth));
+  int8_t depth = 0;  // -1 while unreachable, after END, OUT or JMP
+  uint16_t steps = 0;
+  uint16_t pc = 0;
+  while (pc < code_len) {
+    if (joinDepth[pc] >= 0) {
+      if (depth >= 0 && depth != joinDepth[pc]) return false;
+      depth = joinDepth[pc];
+    }
+    uint8_t op = code[pc];
+    OpInfo info = opInfo(op);
+    if (info.pops < 0 || pc + 1 + info.operand > code_len) return false;
+    uint16_t next = pc + 1 + info.operand;
+    uint8_t arg = info.operand ? code[pc + 1] : 0;
+    if (op == ANIM_OP_LD && arg >= ANIM_REG_COUNT) return false;
+    if (op == ANIM_OP_ST && (arg < ANIM_REG_V0 || arg >= ANIM_REG_V0 + ANIM_VARS)) return false;
+    if (op == ANIM_OP_WAVE && arg >= OSC_WAVE_COUNT) return false;
+    if (++steps > ANIM_PIXEL_BUDGET) return false;
+
+    if (depth >= 0) {
+      if (depth < info.pops) return false;
+      depth = (int8_t)(depth - info.pops + info.pushes);
+      if (depth > ANIM_STACK_DEPTH) return false;
+      if (op == ANIM_OP_JMP || op == ANIM_OP_JZ) {
+        uint16_t target = next + arg;
+        if (target > code_len) return false;
+        if (joinDepth[target] >= 0 && joinDepth[target] != depth) return false;
+        joinDepth[target] = depth;
+      }
+      if (op == ANIM_OP_END || op == ANIM_OP_OUT || op == ANIM_OP_JMP) depth = -1;
+    }
+    // A jump into an operand byte would run it as an opcode.
+    for (uint16_t b = pc + 1; b < next; b++) {
+      if (joinDepth[b] >= 0) return false;
+    }
+    pc = next;
+  }
+
+  memcpy(out.code, code, code_len);
+  out.code_len = code_len;
+  out.frame_ms = frame_ms;
+  out.id = crc16_ccitt(image, n);
+  out.steps = (uint8_t)steps;
+  return true;
+}
+
+static inline int32_t wrapAdd(int32_t a, int32_t b) {
+  return (int32_t)((uint32_t)a + (uint32_t)b);
+}
+
+static inline int32_t wrapSub(int32_t a, int32_t b) {
+  return (int32_t)((uint32_t)a - (uint32_t)b);
+}
+
+static inline int32_t wrapMul(int32_t a, int32_t b) {
+  return (int32_t)((uint32_t)a * (uint32_t)b);
+}
+
+static inline uint8_t clamp8(int32_t v) {
+  return v < 0 ? 0 : v > 255 ? 255 : (uint8_t)v;
+}
+
+// One pixel. The program is verified, so pc and sp stay in range.
+static void runPixel(const AnimProgram &prog, int32_t *regs, uint8_t *rgb) {
+  int32_t stack[ANIM_STACK_DEPTH];
+  int32_t *sp = stack;  // next free slot
+  const uint8_t *code = prog.code;
+  uint16_t pc = 0;
+  rgb[0] = rgb[1] = rgb[2] = 0;
+  while (pc < prog.code_len) {
+    uint8_t op = code[pc++];
+    int32_t a, b;
+    switch (op) {
+      case ANIM_OP_END:
+        return;
+      case ANIM_OP_PUSH8:
+        *sp++ = (int8_t)code[pc++];
+        break;
+      case ANIM_OP_PUSH16:
+        *sp++ = (int16_t)rd_u16le(code + pc);
+        pc += 2;
+        break;
+      case ANIM_OP_LD:
+        *sp++ = regs[code[pc++]];
+        break;
+      case ANIM_OP_ST:
+        regs[code[pc++]] = *--sp;
+        break;
+      case ANIM_OP_DUP:
+        sp[0] = sp[-1];
+        sp++;
+        break;
+      case ANIM_OP_DROP:
+        sp--;
+        break;
+      case ANIM_OP_SWAP:
+        a = sp[-1];
+        sp[-1] = sp[-2];
+        sp[-2] = a;
+        break;
+      case ANIM_OP_NEG:
+        sp[-1] = wrapSub(0, sp[-1]);
+        break;
+      case ANIM_OP_ABS:
+        if (sp[-1] < 0) sp[-1] = wrapSub(0, sp[-1]);
+        break;
+      case ANIM_OP_SIN:
+        sp[-1] = fx_sin((uint16_t)sp[-1]);
+        break;
+      case ANIM_OP_WAVE: {
+        OscWave wave = (OscWave)code[pc++];
+        Osc o;
+        o.wave = wave;
+        o.duty = WAVE_DUTY[wave];
+        o.phase = (uint32_t)(uint16_t)sp[-1] << 16;
+        sp[-1] = osc_value(o);
+        break;
+      }
+      case ANIM_OP_CLAMP8:
+        sp[-1] = clamp8(sp[-1]);
+        break;
+      case ANIM_OP_PHASE:
+        sp[-1] = sp[-1] > 0 && sp[-1] < 65536 ? fx_phase((uint32_t)regs[ANIM_REG_T], (uint32_t)sp[-1]) : 0;
+        break;
+      case ANIM_OP_JMP:
+        pc += 1 + code[pc];
+        break;
+      case ANIM_OP_JZ:
+        a = *--sp;
+        pc += a == 0 ? 1 + code[pc] : 1;
+        break;
+      case ANIM_OP_OUT:
+        rgb[2] = clamp8(*--sp);
+        rgb[1] = clamp8(*--sp);
+        rgb[0] = clamp8(*--sp);
+        return;
+      default:
+        b = *--sp;
+        a = sp[-1];
+        switch (op) {
+          case ANIM_OP_ADD: a = wrapAdd(a, b); break;
+          case ANIM_OP_SUB: a = wrapSub(a, b); break;
+          case ANIM_OP_MUL: a = wrapMul(a, b); break;
+          case ANIM_OP_DIV: a = b == 0 ? 0 : b == -1 ? wrapSub(0, a) : a / b; break;
+          case ANIM_OP_MOD: a = b == 0 || b == -1 ? 0 : a % b; break;
+          case ANIM_OP_MIN: a = a < b ? a : b; break;
+          case ANIM_OP_MAX: a = a > b ? a : b; break;
+          case ANIM_OP_AND: a &= b; break;
+          case ANIM_OP_OR: a |= b; break;
+          case ANIM_OP_XOR: a ^= b; break;
+          case ANIM_OP_SHL: a = (int32_t)((uint32_t)a << (b & 31)); break;
+          case ANIM_OP_SHR: a >>= (b & 31); break;
+          case ANIM_OP_LT: a = a < b; break;
+          case ANIM_OP_EQ: a = a == b; break;
+          case ANIM_OP_MULQ: a = (int32_t)(((int64_t)a * b) >> 15); break;
+        }
+        sp[-1] = a;
+        break;
+    }
+  }
+}
+
+void anim_run(const AnimProgram &prog, const int16_t *params, uint32_t t_ms, uint8_t *rgb) {
+  int32_t regs[ANIM_REG_COUNT];
+  for (uint8_t p = 0; p < ANIM_PARAMS; p++) regs[ANIM_REG_P0 + p] = params[p];
+  regs[ANIM_REG_T] = (int32_t)(t_ms & 0x7FFFFFFF);
+  for (uint8_t y = 0; y < SHIELD_HEIGHT; y++) {
+    for (uint8_t x = 0; x < SHIELD_WIDTH; x++) {
+      uint8_t i = y * SHIELD_WIDTH + x;
+      regs[ANIM_REG_X] = x;
+      regs[ANIM_REG_Y] = y;
+      regs[ANIM_REG_I] = i;
+      for (uint8_t v = 0; v < ANIM_VARS; v++) regs[ANIM_REG_V0 + v] = 0;
+      runPixel(prog, regs, rgb + i * 3);
+    }
+  }
+}
@@ -0,0 +1,125 @@
+// Tiny bytecode VM for host-uploaded NeoPixel shield animations.
+//
+// A program is a per-pixel colour function: it runs once for each of the 40
+// shield pixels per frame, reads the pixel's position, the time since it was
+// loaded and up to ANIM_PARAMS host-set parameters, and ends with OUT r g b.
+// The host assembles it (sentinel/led/anim.py), uploads it once in chunks
+// through anim.load, and afterwards only changes parameters with anim.set, so
+// a new effect needs neither a reflash nor a stream of frames over the bridge.
+//
+// Values are int32 on a stack of ANIM_STACK_DEPTH. Jumps only go forward, so a
+// pixel executes each instruction at most once, and anim_parse() rejects a
+// program with more than ANIM_PIXEL_BUDGET instructions: the cost of a frame
+// is bounded by ANIM_FRAME_BUDGET instructions before the program ever runs.
+// anim_parse() also checks every opcode, operand, jump target and the stack
+// depth at each instruction, so anim_run() needs no checks of its own.
+// Arithmetic wraps, division or modulo by zero yields 0, and shift counts are
+// taken mod 32.
+
+#pragma once
+
+#include <stdint.h>
+
+#include "led_mode.h"
+
+// Image: ['A', version, frame_ms u16, code_len u16, code x code_len, crc u16],
+// the CRC-16/CCITT (wire_format.h) of everything before it. frame_ms 0 draws
+// only when the program or its parameters change.
+#define ANIM_MAGIC 'A'
+#define ANIM_VERSION 1
+#define ANIM_HEADER 6
+#define ANIM_CODE_MAX 192
+#define ANIM_IMAGE_MAX (ANIM_HEADER + ANIM_CODE_MAX + 2)
+#define ANIM_MIN_FRAME_MS 16
+// The render thread sleeps frame_ms between frames; keep it far inside the
+// MCU watchdog timeout.
+#define ANIM_MAX_FRAME_MS 1000
+
+// anim.load chunk: [offset u16, total u16, image bytes ...]. Offset 0 starts a
+// new image; later chunks must continue exactly where the last one ended.
+#define ANIM_CHUNK_HEADER 4
+#define ANIM_CHUNK_MAX 64
+
+#define ANIM_PARAMS 8
+#define ANIM_VARS 4
+#define ANIM_STACK_DEPTH 8
+#define ANIM_FRAME_BUDGET 4096
+#define ANIM_PIXEL_BUDGET (ANIM_FRAME_BUDGET / SHIELD_PIXELS)
+
+// Registers for LD; ST only writes the per-pixel variables, which start at 0.
+enum AnimReg : uint8_t {
+  ANIM_REG_X = 0,    // column, 0 .. SHIELD_WIDTH - 1
+  ANIM_REG_Y = 1,    // row, 0 .. SHIELD_HEIGHT - 1
+  ANIM_REG_I = 2,    // pixel index, y * SHIELD_WIDTH + x
+  ANIM_REG_T = 3,    // ms since the program was loaded
+  ANIM_REG_V0 = 4,   // V0 .. V3
+  ANIM_REG_P0 = 8,   // P0 .. P7, set by anim.set
+  ANIM_REG_COUNT = 16,
+};
+
+// Stack effects are written (inputs -- outputs); "a b" means b is on top.
+enum AnimOp : uint8_t {
+  ANIM_OP_END = 0x00,     // ( -- ) pixel off; also implied past the last byte
+  ANIM_OP_PUSH8 = 0x01,   // + int8 ( -- v )
+  ANIM_OP_PUSH16 = 0x02,  // + int16 LE ( -- v )
+  ANIM_OP_LD = 0x03,      // + AnimReg ( -- v )
+  ANIM_OP_ST = 0x04,      // + V0 .. V3 ( v -- )
+  ANIM_OP_DUP = 0x05,     // ( a -- a a )
+  ANIM_OP_DROP = 0x06,    // ( a -- )
+  ANIM_OP_SWAP = 0x07,    // ( a b -- b a )
+  ANIM_OP_ADD = 0x10,     // ( a b -- a+b ), and likewise down to EQ
+  ANIM_OP_SUB = 0x11,
+  ANIM_OP_MUL = 0x12,
+  ANIM_OP_DIV = 0x13,
+  ANIM_OP_MOD = 0x14,
+  ANIM_OP_MIN = 0x15,
+  ANIM_OP_MAX = 0x16,
+  ANIM_OP_AND = 0x17,
+  ANIM_OP_OR = 0x18,
+  ANIM_OP_XOR = 0x19,
+  ANIM_OP_SHL = 0x1A,
+  ANIM_OP_SHR = 0x1B,     // arithmetic
+  ANIM_OP_LT = 0x1C,      // 1 if a < b, else 0
+  ANIM_OP_EQ = 0x1D,
+  ANIM_OP_MULQ = 0x1E,    // ( a b -- a*b >> 15 ), for Q15 amplitudes
+  ANIM_OP_NEG = 0x20,     // ( a -- -a )
+  ANIM_OP_ABS = 0x21,
+  ANIM_OP_SIN = 0x22,     // ( phase -- Q15 sine ), phase in 65536ths of a turn
+  ANIM_OP_WAVE = 0x23,    // + OscWave ( phase -- Q16 unit value ), see oscillator.h
+  ANIM_OP_CLAMP8 = 0x24,  // ( a -- a clamped to 0 .. 255 )
+  ANIM_OP_PHASE = 0x25,   // ( period_ms -- T's position in the period, 0 .. 65535 )
+  ANIM_OP_JMP = 0x30,     // + uint8 skip: continue that many bytes past the operand
+  ANIM_OP_JZ = 0x31,      // + uint8 skip ( a -- ), jump if a == 0
+  ANIM_OP_OUT = 0x3F,     // ( r g b -- ) set the pixel, each clamped to 0 .. 255; ends it
+};
+
+struct AnimProgram {
+  uint8_t code[ANIM_CODE_MAX];
+  uint16_t code_len;
+  uint16_t frame_ms;
+  uint16_t id;      // the image CRC, reported by anim.s
+  uint8_t steps;    // instructions, each at most once per pixel
+};
+
+// Reassembles an image from anim.load chunks.
+struct AnimLoader {
+  uint8_t image[ANIM_IMAGE_MAX];
+  uint16_t len;
+  uint16_t total;
+};
+
+enum AnimChunkResult : uint8_t {
+  ANIM_CHUNK_REJECTED = 0,  // malformed or out of order; the partial image is dropped
+  ANIM_CHUNK_MORE = 1,      // accepted, more to come
+  ANIM_CHUNK_COMPLETE = 2,  // accepted, loader.image holds all loader.total bytes
+};
+
+AnimChunkResult anim_loader_feed(AnimLoader &loader, const uint8_t *chunk, uint16_t n);
+
+// Decode and verify an image into out. Returns false, leaving out untouched,
+// if the image is malformed or over budget.
+bool anim_parse(const uint8_t *image, uint16_t n, AnimProgram &out);
+
+// Run prog for every shield pixel at t_ms since load, writing r, g, b bytes
+// (SHIELD_PIXELS * 3, in pixel order) to rgb.
+void anim_run(const AnimProgram &prog, const int16_t *params, uint32_t t_ms, uint8_t *rgb);
@@ -0,0 +1,77 @@
+#include "compositor.h"
+
+#include <string.h>
+
+#include "perf_stats.h"
+
+void compositor_init(Compositor &c, uint8_t width, uint8_t height, uint8_t bpp) {
+  memset(&c, 0, sizeof(c));
+  c.width = width;
+  c.height = height;
+  c.bpp = bpp;
+}
+
+uint8_t compositor_add(Compositor &c, LedLayerDraw draw, uint8_t x, uint8_t y, uint8_t w, uint8_t h) {
+  if (c.count >= COMPOSITOR_MAX_LAYERS || x >= c.width || y >= c.height) return COMPOSITOR_NONE;
+  if (w > c.width - x) w = c.width - x;
+  if (h > c.height - y) h = c.height - y;
+  uint8_t i = c.count++;
+  c.layers[i] = {draw, x, y, w, h};
+  compositor_mark(c, i);
+  return i;
+}
+
+static bool overlaps(const LedLayer &a, const LedLayer &b) {
+  return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+bool compositor_compose(Compositor &c, uint8_t *surface) {
+  uint8_t redraw = c.dirty & (uint8_t)((1u << c.count) - 1);
+  c.dirty = 0;
+  if (!redraw) return false;
+
+  // Clearing a layer wipes whatever others drew inside it, so grow the set
+  // until no clean layer touches a flagged one.
+  bool grew = true;
+  while (grew) {
+    grew = false;
+    for (uint8_t i = 0; i < c.count; i++) {
+      if (redraw & (1u << i)) continue;
+      for (uint8_t j = 0; j < c.count; j++) {
+        if ((redraw & (1u << j)) && overlaps(c.layers[i], c.layers[j])) {
+          redraw |= (uint8_t)(1u << i);
+          grew = true;
+          break;
+        }
+      }
+    }
+  }
+
+  uint16_t stride = (uint16_t)c.width * c.bpp;
+  for (uint8_t i = 0; i < c.count; i++) {
+    if (!(redraw & (1u << i))) continue;
+    const LedLayer &l = c.layers[i];
+    uint8_t *row = surface + l.y * stride + l.x * c.bpp;
+    for (uint8_t y = 0; y < l.h; y++, row += stride) memset(row, 0, (size_t)l.w * c.bpp);
+  }
+  for (uint8_t i = 0; i < c.count; i++) {
+    if (redraw & (1u << i)) c.layers[i].draw(surface);
+  }
+  return true;
+}
+
+bool frame_gate_pass(LedFrameGate &g, const uint8_t *frame, uint16_t n) {
+  if (n > LED_FRAME_GATE_BYTES) {
+    g.size = 0;
+    perf_frame(true);
+    return true;
+  }
+  if (n == g.size && memcmp(g.last, frame, n) == 0) {
+    perf_frame(false);
+    return false;
+  }
+  memcpy(g.last, frame, n);
+  g.size = n;
+  perf_frame(true);
+  return true;
+}
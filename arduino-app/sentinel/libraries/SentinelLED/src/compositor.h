@@ -0,0 +1,84 @@
+// Retained-mode frame composition and elision of unchanged output frames.
+//
+// Layers: a mode splits its surface into up to COMPOSITOR_MAX_LAYERS fixed
+// rectangles (the abacus digits and indicator column, the orbital bodies,
+// ...), each drawn by its own callback. Pixels stay in the surface between
+// frames; compositor_mark() flags a layer whose inputs changed, and
+// compositor_compose() clears and redraws only the flagged layers (plus any
+// layer overlapping one of them, in z order). When nothing is flagged the
+// mode leaves canvas.dirty unset and the sketch skips the output.
+//
+// Rectangles address the surface as row-major width x height pixels of bpp
+// bytes, before any wiring remap. A mode that remaps pixels (the portrait
+// heatmap) uses one full-surface layer.
+//
+// LedFrameGate sits in front of one physical output and keeps a copy of the
+// last frame sent to it. frame_gate_pass() returns false for a frame that
+// matches, so the bus transfer (and, for the bit-bang WS2812 backend, its
+// interrupts-masked window) is skipped. Shown and elided frames are counted
+// in perf_stats.
+
+#pragma once
+
+#include <stdint.h>
+
+#include "led_mode.h"
+
+#define COMPOSITOR_MAX_LAYERS 4
+#define COMPOSITOR_NONE 0xFF
+
+// Draw one layer into the surface, touching only pixels inside its rectangle.
+typedef void (*LedLayerDraw)(uint8_t *surface);
+
+struct LedLayer {
+  LedLayerDraw draw;
+  uint8_t x;
+  uint8_t y;
+  uint8_t w;
+  uint8_t h;
+};
+
+struct Compositor {
+  LedLayer layers[COMPOSITOR_MAX_LAYERS];
+  uint8_t count;
+  uint8_t dirty;  // bit per layer
+  uint8_t width;
+  uint8_t height;
+  uint8_t bpp;
+};
+
+void compositor_init(Compositor &c, uint8_t width, uint8_t height, uint8_t bpp);
+
+// Add a layer above the existing ones, flagged dirty. Returns its index, or
+// COMPOSITOR_NONE when the compositor is full.
+uint8_t compositor_add(Compositor &c, LedLayerDraw draw, uint8_t x, uint8_t y, uint8_t w, uint8_t h);
+
+static inline void compositor_mark(Compositor &c, uint8_t layer) {
+  c.dirty |= (uint8_t)(1u << layer);
+}
+
+static inline void compositor_mark_all(Compositor &c) {
+  c.dirty = (uint8_t)((1u << c.count) - 1);
+}
+
+// Redraw the flagged layers into surface and clear the flags. Returns true
+// if anything was drawn.
+bool compositor_compose(Compositor &c, uint8_t *surface);
+
+// Large enough for either surface in LedCanvas.
+#define LED_FRAME_GATE_BYTES (SHIELD_PIXELS * 3)
+
+struct LedFrameGate {
+  uint8_t last[LED_FRAME_GATE_BYTES];
+  uint16_t size;  // bytes in last; 0 until the first frame is sent
+};
+
+// Forget the last frame, so the next one is sent whatever it holds. Use after
+// something else has driven the output.
+static inline void frame_gate_reset(LedFrameGate &g) {
+  g.size = 0;
+}
+
+// True when frame differs from the last one passed for this output (which
+// the caller must then send). Frames longer than LED_FRAME_GATE_BYTES always pass.
+bool frame_gate_pass(LedFrameGate &g, const uint8_t *frame, uint16_t n);
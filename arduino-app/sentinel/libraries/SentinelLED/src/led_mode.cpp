@@ -0,0 +1,7 @@
+#include "led_mode.h"
+
+static uint64_t modeArena[LED_MODE_ARENA_SIZE / sizeof(uint64_t)];
+
+void *led_mode_arena() {
+  return modeArena;
+}
@@ -0,0 +1,89 @@
+// Runtime-selectable renderers behind one frame interface.
+//
+// A mode draws into an LedCanvas; the sketch owns the physical outputs (the
+// NeoPixel shield through ws2812_out, the 8x13 matrix through
+// Arduino_LED_Matrix) and pushes the surface named by LedMode::output whenever
+// render() marks the canvas dirty. The canvas is retained between frames, so
+// a mode only redraws what changed (see compositor.h).
+//
+// All mode state lives in one shared arena, so only the active mode's state is
+// resident. enter() initializes it from scratch; a mode's data entry points
+// (abacus_apply(), orbital_update(), heatmap_load(), treemap_load(), anim_load(), ...) are
+// only valid while that mode is the active one.
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#define SHIELD_WIDTH 8
+#define SHIELD_HEIGHT 5
+#define SHIELD_PIXELS (SHIELD_WIDTH * SHIELD_HEIGHT)
+#define MATRIX_WIDTH 13
+#define MATRIX_HEIGHT 8
+#define MATRIX_PIXELS (MATRIX_WIDTH * MATRIX_HEIGHT)
+
+enum LedOutput : uint8_t {
+  LED_OUT_SHIELD = 0,
+  LED_OUT_MATRIX = 1,
+};
+
+struct LedCanvas {
+  uint8_t shield[SHIELD_PIXELS * 3];  // GRB bytes at final brightness, for ws2812_show()
+  uint8_t matrix[MATRIX_PIXELS];      // 8-bit grayscale, for ArduinoLEDMatrix::draw()
+  bool dirty;                         // set by render() when its surface changed
+};
+
+struct LedMode {
+  const char *name;
+  LedOutput output;
+  void (*enter)(uint32_t now_ms);
+  // Draw the frame for now_ms, setting canvas.dirty if anything changed.
+  // Returns how many ms may pass before the mode needs to run again; new data
+  // should wake the caller earlier.
+  uint32_t (*render)(uint32_t now_ms, LedCanvas &canvas);
+};
+
+// Mode ids as used by the mode.set RPC and the /api/led/mode setting.
+enum LedModeId : uint8_t {
+  LED_MODE_ABACUS = 0,
+  LED_MODE_ORBITAL = 1,
+  LED_MODE_HEATMAP = 2,
+  LED_MODE_TREEMAP = 3,
+  LED_MODE_ANIM = 4,
+  LED_MODE_COUNT,
+};
+
+#define LED_MODE_ARENA_SIZE 1536
+
+void *led_mode_arena();
+
+// The active mode's state, zero-filled by led_mode_reset_state<T>() in enter().
+template <typename T>
+static inline T &led_mode_state() {
+  static_assert(sizeof(T) <= LED_MODE_ARENA_SIZE, "mode state does not fit LED_MODE_ARENA_SIZE");
+  return *static_cast<T *>(led_mode_arena());
+}
+
+template <typename T>
+static inline T &led_mode_reset_state() {
+  T &s = led_mode_state<T>();
+  memset(&s, 0, sizeof(T));
+  return s;
+}
+
+static inline void shield_set_rgb(uint8_t *shield, uint16_t i, uint8_t r, uint8_t g, uint8_t b) {
+  uint8_t *p = &shield[i * 3];
+  p[0] = g;
+  p[1] = r;
+  p[2] = b;
+}
+
+static inline void canvas_set_rgb(LedCanvas &c, uint16_t i, uint8_t r, uint8_t g, uint8_t b) {
+  shield_set_rgb(c.shield, i, r, g, b);
+}
+
+// Adafruit_NeoPixel::setBrightness() scaling: level 0..255, applied per channel.
+static inline uint8_t canvas_scale(uint8_t v, uint8_t level) {
+  return (uint8_t)(((uint16_t)v * ((uint16_t)level + 1)) >> 8);
+}
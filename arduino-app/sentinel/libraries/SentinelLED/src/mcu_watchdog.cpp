@@ -0,0 +1,83 @@
+#include "mcu_watchdog.h"
+
+#if !defined(SENTINEL_LED_NATIVE) && defined(CONFIG_WATCHDOG)
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/watchdog.h>
+#if DT_NODE_HAS_STATUS(DT_ALIAS(watchdog0), okay)
+#define MCU_WATCHDOG_HW 1
+#endif
+#endif
+
+#ifndef MCU_WATCHDOG_HW
+#define MCU_WATCHDOG_HW 0
+#endif
+
+#if !defined(SENTINEL_LED_NATIVE) && defined(CONFIG_REBOOT)
+#include <zephyr/sys/reboot.h>
+#endif
+
+#define REG32(addr) (*(volatile uint32_t *)(addr))
+
+// SCB->AIRCR: VECTKEY plus SYSRESETREQ.
+#define AIRCR REG32(0xE000ED0CUL)
+#define AIRCR_SYSRESET 0x05FA0004UL
+
+#if MCU_WATCHDOG_HW
+static const struct device *const wdt = DEVICE_DT_GET(DT_ALIAS(watchdog0));
+static int wdtChannel = -1;
+#endif
+
+static bool resetPending = false;
+static uint32_t resetAtMs = 0;
+
+bool mcu_watchdog_begin(uint32_t timeout_ms) {
+#if MCU_WATCHDOG_HW
+  if (!device_is_ready(wdt)) return false;
+  struct wdt_timeout_cfg cfg = {};
+  cfg.window.min = 0;
+  cfg.window.max = timeout_ms;
+  cfg.flags = WDT_FLAG_RESET_SOC;
+  wdtChannel = wdt_install_timeout(wdt, &cfg);
+  if (wdtChannel < 0) return false;
+  // Keep a debugger session from tripping it.
+  if (wdt_setup(wdt, WDT_OPT_PAUSE_HALTED_BY_DBG) != 0) {
+    wdtChannel = -1;
+    return false;
+  }
+  return true;
+#else
+  (void)timeout_ms;
+  return false;
+#endif
+}
+
+static void resetNow() {
+#if defined(SENTINEL_LED_NATIVE)
+  native_mcu_reset();
+#elif defined(CONFIG_REBOOT)
+  sys_reboot(SYS_REBOOT_WARM);
+#else
+  __asm volatile("dsb" ::: "memory");
+  AIRCR = AIRCR_SYSRESET;
+  for (;;) {
+  }
+#endif
+}
+
+void mcu_watchdog_poll(uint32_t now_ms, bool alive) {
+#if MCU_WATCHDOG_HW
+  if (alive && wdtChannel >= 0) wdt_feed(wdt, wdtChannel);
+#else
+  (void)alive;
+#endif
+  if (resetPending && (int32_t)(now_ms - resetAtMs) >= 0) {
+    resetPending = false;
+    resetNow();
+  }
+}
+
+void mcu_reset_request(uint32_t now_ms, uint32_t delay_ms) {
+  resetAtMs = now_ms + delay_ms;
+  resetPending = true;
+}
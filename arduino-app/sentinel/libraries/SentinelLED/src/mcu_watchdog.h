@@ -0,0 +1,34 @@
+// MCU end of the MPU app's recovery ladder: a hardware watchdog backstop and
+// a deferred soft reset for the sys.reset RPC.
+//
+// mcu_watchdog_begin() arms the board's watchdog0 (the STM32U5 IWDG), which
+// resets the MCU unless mcu_watchdog_poll() feeds it within the timeout. The
+// sketch feeds only while its threads make progress, so a wedged
+// Bridge.update() or a hung renderer ends in a reset rather than a dark
+// display, even when the MPU can no longer reach the MCU to ask for one.
+//
+// mcu_reset_request() schedules a reset a little later, so the RPC that asked
+// for it can still reply; mcu_watchdog_poll() performs it. The reset is warm,
+// so state_store.h's retained records survive it.
+//
+// Builds without CONFIG_WATCHDOG or a watchdog0 alias run without the backstop.
+
+#pragma once
+
+#include <stdint.h>
+
+// Arm the watchdog. Returns false when the board has none. Once armed it
+// cannot be stopped until the next reset.
+bool mcu_watchdog_begin(uint32_t timeout_ms);
+
+// Call from the bridge loop. Feeds the watchdog if alive, and resets the MCU
+// once a requested reset is due.
+void mcu_watchdog_poll(uint32_t now_ms, bool alive);
+
+// Reset the MCU delay_ms from now.
+void mcu_reset_request(uint32_t now_ms, uint32_t delay_ms);
+
+#ifdef SENTINEL_LED_NATIVE
+// Host builds (firmware/native) supply the reset.
+void native_mcu_reset();
+#endif
@@ -0,0 +1,214 @@
+#include "mode_abacus.h"
+
+#include "compositor.h"
+#include "oscillator.h"
+
+#define BRIGHTNESS 3  // raw RGB value
+
+// Incoming data considered fresh if an update arrived within 10 minutes.
+#define HEARTBEAT_TIMEOUT_MS 600000UL
+
+// Blink cycles: on for the first *_ON_MS of every *_PERIOD_MS.
+#define PNL_BLINK_PERIOD_MS 1600UL
+#define PNL_BLINK_ON_MS      800UL
+#define HEARTBEAT_PERIOD_MS 1200UL
+#define HEARTBEAT_ON_MS      200UL
+#define REC_BLINK_PERIOD_MS  400UL
+#define REC_BLINK_ON_MS      100UL
+
+// Upper bound on one idle sleep, as a backstop for a missed wake-up.
+#define IDLE_MAX_SLEEP_MS   1000UL
+
+// Indicator blinks in the oscillator bank, aligned with millis().
+enum AbacusBlink : uint8_t {
+  PNL_BLINK = 0,
+  HEARTBEAT = 1,
+  REC_BLINK = 2,
+};
+
+// Layers in the compositor: the beads on columns 1-7 and the column-0
+// indicators, so a blink edge only redraws one column.
+enum AbacusLayer : uint8_t {
+  DIGITS = 0,
+  INDICATORS = 1,
+};
+
+struct AbacusState {
+  AbacusData data;
+  uint32_t lastUpdateMs;
+  uint32_t lastTickMs;
+  OscBank blinks;
+  Compositor layers;
+
+  // Blink states (computed from time modulo).
+  bool pnlBlinkOn;
+  bool heartbeatOn;
+  bool recBlinkOn;
+  bool dataFresh;
+};
+
+static AbacusState &state() {
+  return led_mode_state<AbacusState>();
+}
+
+static void drawDigits(uint8_t *shield) {
+  const AbacusState &s = state();
+  int32_t val = s.data.value;
+
+  // Extract 8 decimal digits, most-significant first.
+  uint8_t digits[8];
+  for (int i = 7; i >= 0; i--) {
+    digits[i] = val % 10;
+    val /= 10;
+  }
+
+  // Abacus on columns 1-7 (column 0 reserved for indicators).
+  for (int col = 1; col < SHIELD_WIDTH; col++) {
+    uint8_t d = digits[col];
+
+    // Heaven bead (row 0) — orange, lit if digit >= 5.
+    if (d >= 5) {
+      shield_set_rgb(shield, col, BRIGHTNESS, BRIGHTNESS / 3, 0);
+    }
+
+    // Earth bead — amber, single pixel at position.
+    // earth 1 -> row 4, earth 2 -> row 3, earth 3 -> row 2, earth 4 -> row 1.
+    uint8_t earth = d % 5;
+    if (earth > 0) {
+      int row = 5 - earth;
+      shield_set_rgb(shield, row * SHIELD_WIDTH + col, BRIGHTNESS, BRIGHTNESS * 2 / 3, 0);
+    }
+  }
+}
+
+static void drawIndicators(uint8_t *shield) {
+  const AbacusState &s = state();
+
+  // Broker connected: c0r0, red, 200ms on / 1000ms off.
+  if (s.heartbeatOn && s.dataFresh && s.data.broker) {
+    shield_set_rgb(shield, 0, BRIGHTNESS, 0, 0);
+  }
+
+  // P/L bar: c0r1-r3, green/red, 800ms blink.
+  if (s.pnlBlinkOn && s.data.pnl != 0) {
+    int pnl = s.data.pnl;
+    if (pnl > 0) {
+      shield_set_rgb(shield, 2 * SHIELD_WIDTH, 0, BRIGHTNESS, 0);
+      if (pnl > 10) {
+        shield_set_rgb(shield, 1 * SHIELD_WIDTH, 0, BRIGHTNESS, 0);
+      }
+    } else {
+      shield_set_rgb(shield, 2 * SHIELD_WIDTH, BRIGHTNESS, 0, 0);
+      if (pnl < -10) {
+        shield_set_rgb(shield, 3 * SHIELD_WIDTH, BRIGHTNESS, 0, 0);
+      }
+    }
+  }
+
+  // Recommendations: c0r4, blue, 100ms on / 300ms off.
+  if (s.recBlinkOn && s.data.recs) {
+    shield_set_rgb(shield, 4 * SHIELD_WIDTH, 0, 0, BRIGHTNESS);
+  }
+}
+
+static uint32_t minu(uint32_t a, uint32_t b) {
+  return a < b ? a : b;
+}
+
+// Milliseconds until the next visible change: the nearest edge of an active
+// indicator blink, or the moment the last payload stops counting as fresh.
+static uint32_t untilNextChange(const AbacusState &s, uint32_t now) {
+  uint32_t wait = IDLE_MAX_SLEEP_MS;
+  uint32_t age = now - s.lastUpdateMs;
+  bool fresh = age < HEARTBEAT_TIMEOUT_MS;
+
+  if (s.data.pnl != 0) {
+    wait = minu(wait, osc_ms_to_edge(s.blinks.osc[PNL_BLINK]));
+  }
+  if (fresh && s.data.broker) {
+    wait = minu(wait, osc_ms_to_edge(s.blinks.osc[HEARTBEAT]));
+  }
+  if (s.data.recs) {
+    wait = minu(wait, osc_ms_to_edge(s.blinks.osc[REC_BLINK]));
+  }
+  if (fresh) {
+    wait = minu(wait, HEARTBEAT_TIMEOUT_MS - age);
+  }
+  return wait;
+}
+
+static void abacusEnter(uint32_t now_ms) {
+  AbacusState &s = led_mode_reset_state<AbacusState>();
+  // Nothing received yet: treat the (empty) data as already expired.
+  s.lastUpdateMs = now_ms - HEARTBEAT_TIMEOUT_MS;
+  s.pnlBlinkOn = true;
+  s.dataFresh = false;
+
+  // Added in AbacusLayer order, both flagged for the first frame.
+  compositor_init(s.layers, SHIELD_WIDTH, SHIELD_HEIGHT, 3);
+  compositor_add(s.layers, drawDigits, 1, 0, SHIELD_WIDTH - 1, SHIELD_HEIGHT);
+  compositor_add(s.layers, drawIndicators, 0, 0, 1, SHIELD_HEIGHT);
+
+  // Added in AbacusBlink order.
+  osc_bank_add(s.blinks, OSC_BLINK, PNL_BLINK_PERIOD_MS, PNL_BLINK_ON_MS * OSC_DUTY_FULL / PNL_BLINK_PERIOD_MS);
+  osc_bank_add(s.blinks, OSC_BLINK, HEARTBEAT_PERIOD_MS, HEARTBEAT_ON_MS * OSC_DUTY_FULL / HEARTBEAT_PERIOD_MS);
+  osc_bank_add(s.blinks, OSC_BLINK, REC_BLINK_PERIOD_MS, REC_BLINK_ON_MS * OSC_DUTY_FULL / REC_BLINK_PERIOD_MS);
+  osc_bank_sync(s.blinks, now_ms);
+  s.lastTickMs = now_ms;
+}
+
+static uint32_t abacusRender(uint32_t now, LedCanvas &canvas) {
+  AbacusState &s = state();
+
+  // Blink states from the oscillator bank (avoids per-feature timers).
+  osc_bank_tick(s.blinks, now - s.lastTickMs);
+  s.lastTickMs = now;
+  bool newPnlBlink = s.blinks.value[PNL_BLINK] != 0;
+  bool newHeartbeat = s.blinks.value[HEARTBEAT] != 0;
+  bool newRecBlink  = s.blinks.value[REC_BLINK] != 0;
+  bool newDataFresh = (now - s.lastUpdateMs < HEARTBEAT_TIMEOUT_MS);
+
+  // Redraw only when a visible blink state changes.
+  bool changed = false;
+  if (newPnlBlink != s.pnlBlinkOn && s.data.pnl != 0) changed = true;
+  if (newHeartbeat != s.heartbeatOn && newDataFresh && s.data.broker) changed = true;
+  if (newDataFresh != s.dataFresh) changed = true;
+  if (newRecBlink != s.recBlinkOn && s.data.recs) changed = true;
+
+  s.pnlBlinkOn = newPnlBlink;
+  s.heartbeatOn = newHeartbeat;
+  s.recBlinkOn = newRecBlink;
+  s.dataFresh = newDataFresh;
+
+  if (changed) compositor_mark(s.layers, INDICATORS);
+  if (compositor_compose(s.layers, canvas.shield)) canvas.dirty = true;
+  return untilNextChange(s, now);
+}
+
+void abacus_apply(const AbacusData &data, uint32_t now_ms) {
+  AbacusState &s = state();
+  AbacusData prev = s.data;
+  s.data = data;
+
+  if (s.data.value < 0) s.data.value = 0;
+  if (s.data.value > 99999999) s.data.value = 99999999;
+  if (s.data.pnl < -99) s.data.pnl = -99;
+  if (s.data.pnl >  99) s.data.pnl =  99;
+
+  s.lastUpdateMs = data.stale ? now_ms - HEARTBEAT_TIMEOUT_MS : now_ms;
+  if (s.data.value != prev.value) compositor_mark(s.layers, DIGITS);
+  if (s.data.pnl != prev.pnl || s.data.recs != prev.recs || s.data.broker != prev.broker) {
+    compositor_mark(s.layers, INDICATORS);
+  }
+}
+
+AbacusData abacus_current() {
+  return state().data;
+}
+
+const LedMode MODE_ABACUS = {
+  "abacus",
+  LED_OUT_SHIELD,
+  abacusEnter,
+  abacusRender,
+};
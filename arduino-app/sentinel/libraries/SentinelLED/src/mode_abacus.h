@@ -0,0 +1,28 @@
+// Soroban abacus view of the portfolio value on the 8x5 NeoPixel shield.
+//
+// Columns 1-7 show the eight-digit value (digits 1..7, most significant
+// first): row 0 is the heaven bead (worth 5), rows 1-4 the earth bead
+// position. Column 0 carries the broker heartbeat, P/L bar and
+// recommendations indicators. render() only redraws on a visible change and
+// sleeps until the next blink edge or data-freshness expiry.
+
+#pragma once
+
+#include "led_mode.h"
+
+extern const LedMode MODE_ABACUS;
+
+struct AbacusData {
+  int32_t value;   // portfolio value, 0..99999999
+  int pnl;         // return percent, -99..99
+  bool recs;       // pending recommendations
+  bool broker;     // broker connected
+  bool stale;      // restored after a reset, not live: shown without the heartbeat
+};
+
+// Apply a portfolio update; out-of-range fields are clamped. Stale data counts
+// as already expired, so the broker heartbeat stays dark until a live update.
+void abacus_apply(const AbacusData &data, uint32_t now_ms);
+
+// The values currently on display (all zero right after enter()).
+AbacusData abacus_current();
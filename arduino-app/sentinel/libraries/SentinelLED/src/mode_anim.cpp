@@ -0,0 +1,81 @@
+#include "mode_anim.h"
+
+#include "color.h"
+
+static const uint8_t BRIGHTNESS_CAP = 8;
+
+// How long a static program (frame_ms 0) may sleep between frames.
+static const uint32_t IDLE_MS = 1000;
+
+struct AnimState {
+  AnimProgram prog;
+  int16_t params[ANIM_PARAMS];
+  bool loaded;
+  bool restart;    // set T to 0 on the next frame
+  bool redraw;     // program or parameters changed since the last frame
+  uint32_t start_ms;
+};
+
+static AnimState &state() {
+  return led_mode_state<AnimState>();
+}
+
+void anim_load(const AnimProgram &prog) {
+  AnimState &s = state();
+  s.prog = prog;
+  s.loaded = true;
+  s.restart = true;
+  s.redraw = true;
+}
+
+void anim_set_params(const int16_t *params) {
+  AnimState &s = state();
+  memcpy(s.params, params, sizeof(s.params));
+  s.redraw = true;
+}
+
+static void animEnter(uint32_t now_ms) {
+  AnimState &s = led_mode_reset_state<AnimState>();
+  s.start_ms = now_ms;
+  s.redraw = true;
+}
+
+static uint32_t animRender(uint32_t now_ms, LedCanvas &canvas) {
+  AnimState &s = state();
+  if (s.restart) {
+    s.start_ms = now_ms;
+    s.restart = false;
+  }
+  bool animated = s.loaded && s.prog.frame_ms != 0;
+  if (!animated && !s.redraw) return IDLE_MS;
+  s.redraw = false;
+
+  uint8_t rgb[SHIELD_PIXELS * 3];
+  if (s.loaded) {
+    anim_run(s.prog, s.params, now_ms - s.start_ms, rgb);
+  } else {
+    memset(rgb, 0, sizeof(rgb));
+  }
+
+  // Only push the strip when a pixel actually moved at the capped brightness.
+  bool changed = false;
+  for (uint8_t i = 0; i < SHIELD_PIXELS; i++) {
+    const uint8_t *p = &rgb[i * 3];
+    uint8_t r = canvas_scale(GAMMA8[p[0]], BRIGHTNESS_CAP);
+    uint8_t g = canvas_scale(GAMMA8[p[1]], BRIGHTNESS_CAP);
+    uint8_t b = canvas_scale(GAMMA8[p[2]], BRIGHTNESS_CAP);
+    uint8_t *q = &canvas.shield[i * 3];
+    if (q[0] == g && q[1] == r && q[2] == b) continue;
+    canvas_set_rgb(canvas, i, r, g, b);
+    changed = true;
+  }
+  if (changed) canvas.dirty = true;
+  return animated ? s.prog.frame_ms : IDLE_MS;
+}
+
+const LedMode MODE_ANIM = {
+  "anim",
+  LED_OUT_SHIELD,
+  animEnter,
+  animRender,
+};
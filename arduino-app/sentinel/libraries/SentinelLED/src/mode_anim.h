@@ -0,0 +1,20 @@
+// Host-programmed animation on the NeoPixel shield.
+//
+// Runs an anim_vm.h program, uploaded with anim.load, once per pixel each
+// frame, and its parameters set with anim.set, so the host can ship a new
+// effect once and afterwards steer it with a few bytes. Output goes through
+// the same gamma and brightness cap as the heatmap; a program that has not
+// been loaded, or that draws nothing, leaves the shield dark.
+
+#pragma once
+
+#include "anim_vm.h"
+#include "led_mode.h"
+
+extern const LedMode MODE_ANIM;
+
+// Replace the program; its T register restarts at 0 on the next frame.
+void anim_load(const AnimProgram &prog);
+
+// Replace all ANIM_PARAMS parameters.
+void anim_set_params(const int16_t *params);
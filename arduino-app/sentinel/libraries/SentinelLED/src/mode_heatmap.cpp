@@ -0,0 +1,237 @@
+#include "mode_heatmap.h"
+
+#include <math.h>
+
+#include "color.h"
+#include "oscillator.h"
+#include "warp_field.h"
+
+#define W 5
+#define H 8
+
+static const uint8_t BRIGHTNESS_CAP = 8;
+static const uint8_t STALE_BRIGHTNESS_CAP = 4;
+static const uint32_t PULSE_PERIOD_MS = 2000;
+
+static const float DRIFT_SPEED = 0.10f;
+
+// The warp field animates continuously; this is the frame pacing.
+static const uint32_t FRAME_MS = 12;
+
+struct HeatmapState {
+  // blendBase/blendSpan: palette index = base + span * pulse, with span
+  // already scaled by the auto-scaled recommendation strength. Rebuilt by
+  // heatmap_load(), read every frame.
+  uint8_t blendBase[HEATMAP_COUNT];
+  int16_t blendSpan[HEATMAP_COUNT];
+  // Raster (x, y) -> strip index, serpentine wiring resolved up front.
+  uint8_t pixelMap[SHIELD_PIXELS];
+  bool stale;
+
+  // Recommendation pulse and the drift wobble, see HeatmapOsc.
+  OscBank osc;
+  uint32_t lastFrameMs;
+  float cx, cy;
+  float ex, ey;
+  float cdx, cdy;
+  float edx, edy;
+};
+
+// Bank slots: the pulse, then sin(0.7 t), cos(0.9 t), cos(0.8 t), sin(0.6 t)
+// (t in seconds) nudging the drift velocities. The warp field's time terms
+// are the phases of 0.9 t and 0.6 t; the latter is DRIFT_EDY's.
+enum HeatmapOsc : uint8_t {
+  PULSE_OSC = 0,
+  DRIFT_CDX = 1,
+  DRIFT_CDY = 2,
+  DRIFT_EDX = 3,
+  DRIFT_EDY = 4,
+  WARP_T1 = 5,
+  WARP_T2 = DRIFT_EDY,
+};
+
+// Bipolar float of a bank value: 0 .. 65535 -> -1 .. +1.
+static float oscSigned(const HeatmapState &s, HeatmapOsc i) {
+  return (float)((int32_t)s.osc.value[i] - 32768) * (1.0f / 32768.0f);
+}
+
+static HeatmapState &state() {
+  return led_mode_state<HeatmapState>();
+}
+
+static int XY(int x, int y) {
+  const bool serpentine = true;
+  if (!serpentine) return y * W + x;
+  if (y & 1) return y * W + (W - 1 - x);
+  return y * W + x;
+}
+
+static float clampf(float v, float lo, float hi) {
+  if (v < lo) return lo;
+  if (v > hi) return hi;
+  return v;
+}
+
+// Score palette: red (-0.5) through yellow (0) to green (+0.5), i.e. the
+// hue 0..120 deg sweep at full saturation and value, gamma-corrected.
+static constexpr uint32_t scorePaletteEntry(uint8_t q) {
+  uint16_t up = 2 * q;
+  uint8_t r = (up <= 255) ? 255 : (uint8_t)(510 - up);
+  uint8_t g = (up <= 255) ? (uint8_t)up : 255;
+  return rgb_pack(GAMMA8[r], GAMMA8[g], 0);
+}
+
+struct ScorePalette {
+  uint32_t rgb[256];
+  constexpr ScorePalette() : rgb() {
+    for (int i = 0; i < 256; i++) rgb[i] = scorePaletteEntry((uint8_t)i);
+  }
+};
+
+static constexpr ScorePalette SCORE_PALETTE{};
+
+// Quantize a score in [-0.5, +0.5] to a SCORE_PALETTE index.
+static uint8_t scoreIndex(float score) {
+  score = clampf(score, -0.5f, 0.5f);
+  return (uint8_t)((score + 0.5f) * 255.0f + 0.5f);
+}
+
+void heatmap_load(const float *before, const float *after, bool stale) {
+  HeatmapState &s = state();
+  s.stale = stale;
+
+  float maxAbsDiff = 0.0f;
+  for (int i = 0; i < HEATMAP_COUNT; i++) {
+    float d = fabsf(after[i] - before[i]);
+    if (d > maxAbsDiff) maxAbsDiff = d;
+  }
+  if (maxAbsDiff < 0.001f) maxAbsDiff = 0.001f;
+
+  for (int i = 0; i < HEATMAP_COUNT; i++) {
+    float diff = fabsf(after[i] - before[i]);
+    float strength = clampf(diff / maxAbsDiff, 0.0f, 1.0f);
+    uint8_t qa = scoreIndex(after[i]);
+    uint8_t qb = scoreIndex(before[i]);
+    s.blendBase[i] = qa;
+    s.blendSpan[i] = (int16_t)lroundf(((int)qb - (int)qa) * strength);
+  }
+}
+
+bool heatmap_decode_bin(const uint8_t *data, uint16_t n, float *before, float *after, bool *stale) {
+  if (n != HEATMAP_BIN_SIZE) return false;
+  if (data[0] != HEATMAP_BIN_MAGIC || data[1] != HEATMAP_BIN_VERSION || data[2] != HEATMAP_COUNT) {
+    return false;
+  }
+  *stale = (data[3] & HEATMAP_BIN_FLAG_STALE) != 0;
+
+  for (int i = 0; i < HEATMAP_COUNT; i++) {
+    before[i] = (int8_t)data[HEATMAP_BIN_HEADER + i] * (0.5f / 127.0f);
+    after[i] = (int8_t)data[HEATMAP_BIN_HEADER + HEATMAP_COUNT + i] * (0.5f / 127.0f);
+  }
+  return true;
+}
+
+static void driftPoints(HeatmapState &s, float dt) {
+  s.cx += s.cdx * dt * DRIFT_SPEED * 10.0f;
+  s.cy += s.cdy * dt * DRIFT_SPEED * 10.0f;
+  s.ex += s.edx * dt * DRIFT_SPEED * 10.0f;
+  s.ey += s.edy * dt * DRIFT_SPEED * 10.0f;
+
+  if (s.cx < 0.0f) { s.cx = 0.0f; s.cdx = fabsf(s.cdx); }
+  if (s.cx > (float)(W - 1)) { s.cx = (float)(W - 1); s.cdx = -fabsf(s.cdx); }
+  if (s.cy < 0.0f) { s.cy = 0.0f; s.cdy = fabsf(s.cdy); }
+  if (s.cy > (float)(H - 1)) { s.cy = (float)(H - 1); s.cdy = -fabsf(s.cdy); }
+
+  if (s.ex < 0.0f) { s.ex = 0.0f; s.edx = fabsf(s.edx); }
+  if (s.ex > (float)(W - 1)) { s.ex = (float)(W - 1); s.edx = -fabsf(s.edx); }
+  if (s.ey < 0.0f) { s.ey = 0.0f; s.edy = fabsf(s.edy); }
+  if (s.ey > (float)(H - 1)) { s.ey = (float)(H - 1); s.edy = -fabsf(s.edy); }
+
+  s.cdx += 0.002f * oscSigned(s, DRIFT_CDX);
+  s.cdy += 0.002f * oscSigned(s, DRIFT_CDY);
+  s.edx += 0.002f * oscSigned(s, DRIFT_EDX);
+  s.edy += 0.002f * oscSigned(s, DRIFT_EDY);
+}
+
+static uint16_t oscPhase(const HeatmapState &s, HeatmapOsc i) {
+  return (uint16_t)(s.osc.osc[i].phase >> 16);
+}
+
+static void renderField(const HeatmapState &s, LedCanvas &c) {
+  int32_t pulseQ8 = (int32_t)(((uint32_t)s.osc.value[PULSE_OSC] * 257) >> 16);
+
+  float dx = s.ex - s.cx;
+  float dy = s.ey - s.cy;
+  float len = sqrtf(dx * dx + dy * dy);
+  if (len < 0.001f) { dx = 1.0f; dy = 0.0f; len = 1.0f; }
+
+  WarpField f;
+  f.cx = (int16_t)lroundf(s.cx * 256.0f);
+  f.cy = (int16_t)lroundf(s.cy * 256.0f);
+  f.dx = (int16_t)lroundf(dx / len * 32767.0f);
+  f.dy = (int16_t)lroundf(dy / len * 32767.0f);
+  f.phase1 = oscPhase(s, WARP_T1);
+  f.phase2 = oscPhase(s, WARP_T2);
+
+  int32_t uField[SHIELD_PIXELS];
+  uint8_t bands[SHIELD_PIXELS];
+  warp_field_eval(f, W, H, HEATMAP_COUNT, uField, bands);
+
+  uint8_t cap = s.stale ? STALE_BRIGHTNESS_CAP : BRIGHTNESS_CAP;
+  for (int i = 0; i < SHIELD_PIXELS; i++) {
+    uint8_t idx = bands[i];
+    int32_t q = s.blendBase[idx] + ((s.blendSpan[idx] * pulseQ8) >> 8);
+    if (q < 0) q = 0;
+    if (q > 255) q = 255;
+    uint32_t rgb = SCORE_PALETTE.rgb[q];
+    canvas_set_rgb(c, s.pixelMap[i],
+                   canvas_scale((uint8_t)(rgb >> 16), cap),
+                   canvas_scale((uint8_t)(rgb >> 8), cap),
+                   canvas_scale((uint8_t)rgb, cap));
+  }
+}
+
+static void heatmapEnter(uint32_t now_ms) {
+  HeatmapState &s = led_mode_reset_state<HeatmapState>();
+  for (int y = 0; y < H; y++) {
+    for (int x = 0; x < W; x++) s.pixelMap[y * W + x] = (uint8_t)XY(x, y);
+  }
+  s.cx = 2.0f; s.cy = 3.5f;
+  s.ex = 4.0f; s.ey = 7.0f;
+  s.cdx = 0.31f; s.cdy = -0.17f;
+  s.edx = -0.23f; s.edy = 0.19f;
+  s.lastFrameMs = now_ms;
+
+  // Added in HeatmapOsc order; periods are 2 pi / rate, cosines start a
+  // quarter turn in.
+  osc_bank_add(s.osc, OSC_SINE, PULSE_PERIOD_MS);
+  osc_bank_add(s.osc, OSC_SINE, 8976);
+  osc_bank_add(s.osc, OSC_SINE, 6981, OSC_DUTY_HALF, 0x4000);
+  osc_bank_add(s.osc, OSC_SINE, 7854, OSC_DUTY_HALF, 0x4000);
+  osc_bank_add(s.osc, OSC_SINE, 10472);
+  osc_bank_add(s.osc, OSC_SINE, 6981);
+
+  float zeros[HEATMAP_COUNT] = {};
+  heatmap_load(zeros, zeros, false);
+}
+
+static uint32_t heatmapRender(uint32_t now_ms, LedCanvas &canvas) {
+  HeatmapState &s = state();
+  uint32_t dtMs = now_ms - s.lastFrameMs;
+  if (dtMs > 100) dtMs = 100;
+  s.lastFrameMs = now_ms;
+  float dt = (float)dtMs / 1000.0f;
+  osc_bank_tick(s.osc, dtMs);
+
+  driftPoints(s, dt);
+  renderField(s, canvas);
+  canvas.dirty = true;
+  return FRAME_MS;
+}
+
+const LedMode MODE_HEATMAP = {
+  "heatmap",
+  LED_OUT_SHIELD,
+  heatmapEnter,
+  heatmapRender,
+};
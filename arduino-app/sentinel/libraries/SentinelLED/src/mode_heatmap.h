@@ -0,0 +1,30 @@
+// Drifting before/after heatmap on the NeoPixel shield, mounted portrait
+// (5 wide, 8 high, serpentine wiring).
+//
+// 40 scores in [-0.5, +0.5] are laid out along a warp field driven by a
+// drifting center and end point. Recommendations pulse between the current
+// (before) and proposed (after) score over 2s, with strength auto-scaled to
+// the largest change. Stale data is drawn at half brightness.
+
+#pragma once
+
+#include "led_mode.h"
+
+#define HEATMAP_COUNT 40
+
+// heatmap/bin payload: ['H', version, count, flags, before int8 x40, after int8 x40],
+// scores quantized as round(score * 254), i.e. +-127 <=> +-0.5.
+#define HEATMAP_BIN_MAGIC 'H'
+#define HEATMAP_BIN_VERSION 1
+#define HEATMAP_BIN_HEADER 4
+#define HEATMAP_BIN_SIZE (HEATMAP_BIN_HEADER + 2 * HEATMAP_COUNT)
+#define HEATMAP_BIN_FLAG_STALE 0x01
+
+extern const LedMode MODE_HEATMAP;
+
+// Load a new dataset and rebuild the blend table. Scores are clamped.
+void heatmap_load(const float *before, const float *after, bool stale);
+
+// Decode a heatmap/bin payload into 40 + 40 scores. Returns false and leaves
+// the outputs untouched if the payload is malformed.
+bool heatmap_decode_bin(const uint8_t *data, uint16_t n, float *before, float *after, bool *stale);
@@ -0,0 +1,302 @@
+#include "mode_orbital.h"
+
+#include "compositor.h"
+#include "fixmath.h"
+#include "oscillator.h"
+
+// Sun center position (Q8 pixels)
+static const int16_t SUN_X = 6 * 256;
+static const int16_t SUN_Y = 3 * 256 + 128;
+
+// Orbital radii (Q8 pixels)
+static const int16_t INNER_RADIUS = 2 * 256 + 128;
+static const int16_t OUTER_RADIUS = 3 * 256 + 128;
+
+// Entry animation progress is Q15: 0 = just arrived, ENTRY_DONE = settled.
+static const uint16_t ENTRY_DONE = 32768;
+// 0.002 per ms in Q15.
+static const uint16_t ENTRY_RATE = 66;
+
+// Orbital speed in Q32 turns per ms: 0.0015 rad/ms inner, 0.001 rad/ms outer.
+static const uint32_t INNER_SPEED = 1025348;
+static const uint32_t OUTER_SPEED = 683565;
+
+// Physics runs at a fixed 250 Hz whatever the frame rate.
+static const uint32_t PHYSICS_STEP_MS = 4;
+// A frame runs the steps of one frame period plus at most this many more;
+// after a longer stall the backlog is dropped instead of fast-forwarding the
+// orbits. Sizing by the period keeps motion real-time down to ORBITAL_MIN_FPS.
+static const uint16_t MAX_CATCHUP_STEPS = 25;
+
+// id -> index into bodies[], NO_SLOT when the id is not on display.
+static const uint8_t NO_SLOT = 0xFF;
+
+// Animation patterns
+enum Pattern : uint8_t {
+  BREATHE = 0,    // Stable
+  FADE_IN = 1,    // Growing
+  FADE_OUT = 2,   // Shrinking
+  PULSE = 3,      // Concern
+  BLINK = 4,      // Warning
+  PATTERN_COUNT
+};
+
+struct Body {
+  uint8_t id;
+  Pattern pattern;
+  uint8_t orbit;      // 0=core, 1=inner, 2=outer
+  uint32_t angle;     // Orbital angle (Q32 turns)
+  uint16_t entry;     // Entry animation progress (Q15, 0..ENTRY_DONE)
+};
+
+struct OrbitalState {
+  Body bodies[ORBITAL_MAX_BODIES];
+  uint8_t body_count;
+  uint8_t global_brightness;
+  uint8_t target_fps;
+  uint8_t id_slot[256];
+  // Per-slot stamp of the last update that listed the body.
+  uint8_t seen_gen[ORBITAL_MAX_BODIES];
+  uint8_t update_gen;
+  uint32_t last_tick;
+  uint32_t physics_acc;   // ms not yet consumed by physics steps
+  // One oscillator per pattern (bank index == Pattern), advanced with the
+  // simulated time, and the brightness each pattern gives this frame.
+  OscBank patterns;
+  uint8_t pattern_level[PATTERN_COUNT];
+  // One full-matrix bodies layer: redrawn when physics advanced with bodies
+  // on display or the data changed, so an empty or paused view sends nothing.
+  Compositor layers;
+};
+
+static OrbitalState &state() {
+  return led_mode_state<OrbitalState>();
+}
+
+/**
+ * Set up the pattern oscillators, in Pattern order.
+ */
+static void init_patterns(OscBank &bank) {
+  bank.count = 0;
+  osc_bank_add(bank, OSC_SINE, 2500);                  // BREATHE: sine, 2.5s cycle
+  osc_bank_add(bank, OSC_SAW_UP, 1500, 52429);         // FADE_IN: ramp up over 80%, quick drop
+  osc_bank_add(bank, OSC_SAW_DOWN, 1500, 52429);       // FADE_OUT: ramp down over 80%, quick rise
+  osc_bank_add(bank, OSC_PULSE, 1000, 19661);          // PULSE: soft bump over 30%, 1s cycle
+  osc_bank_add(bank, OSC_BLINK, 500);                  // BLINK: hard on/off, 500ms cycle
+}
+
+/**
+ * Map each pattern's oscillator onto brightness, once per frame.
+ */
+static void update_pattern_levels(OrbitalState &s) {
+  const uint16_t *v = s.patterns.value;
+  s.pattern_level[BREATHE] = fx_lerp8(30, 255, v[BREATHE]);
+  s.pattern_level[FADE_IN] = fx_lerp8(30, 255, v[FADE_IN]);
+  s.pattern_level[FADE_OUT] = fx_lerp8(30, 255, v[FADE_OUT]);
+  // The bump rises from the half-brightness floor to full and back.
+  s.pattern_level[PULSE] = fx_lerp8(142, 255, v[PULSE]);
+  s.pattern_level[BLINK] = v[BLINK] ? 255 : 40;
+}
+
+/**
+ * Get orbital position for a body, in Q8 pixels.
+ */
+static void get_position(const Body &b, int16_t &x, int16_t &y) {
+  if (b.orbit == 0) {
+    // Core body - 2x2 sun grid
+    x = SUN_X + (b.id % 2) * 256 - 128;
+    y = SUN_Y + (b.id / 2) * 256 - 128;
+  } else {
+    // Satellite - orbital position
+    int32_t radius = (b.orbit == 1) ? INNER_RADIUS : OUTER_RADIUS;
+    radius = (radius * b.entry) >> 15;  // Entry animation scaling
+    uint16_t angle = (uint16_t)(b.angle >> 16);
+    x = SUN_X + (int16_t)((fx_cos(angle) * radius) >> 15);
+    y = SUN_Y + (int16_t)((fx_sin(angle) * radius) >> 15);
+  }
+}
+
+/**
+ * Set pixel in frame buffer with bounds checking.
+ */
+static void set_pixel(uint8_t *frame, uint8_t x, uint8_t y, uint8_t brightness) {
+  if (x >= MATRIX_WIDTH || y >= MATRIX_HEIGHT) return;
+  uint16_t idx = y * MATRIX_WIDTH + x;
+  // Additive blending with clamping
+  uint16_t sum = frame[idx] + brightness;
+  frame[idx] = (sum > 255) ? 255 : (uint8_t)sum;
+}
+
+/**
+ * Update orbital physics.
+ */
+static void update_physics(OrbitalState &s, uint32_t dt_ms) {
+  for (int i = 0; i < s.body_count; i++) {
+    Body &b = s.bodies[i];
+
+    // Update entry animation
+    if (b.entry < ENTRY_DONE) {
+      uint32_t entry = b.entry + ENTRY_RATE * dt_ms;
+      b.entry = (entry > ENTRY_DONE) ? ENTRY_DONE : (uint16_t)entry;
+    }
+
+    // Update orbital angle (satellites only); Q32 turns wrap on their own.
+    if (b.orbit > 0) {
+      uint32_t speed = (b.orbit == 1) ? INNER_SPEED : OUTER_SPEED;
+      speed = speed / 10 * (10 + b.id % 5);  // Slight variation
+      b.angle += speed * dt_ms;
+    }
+  }
+}
+
+/**
+ * Render current state into the (already cleared) matrix surface.
+ */
+static void render_frame(const OrbitalState &s, uint8_t *frame) {
+  for (int i = 0; i < s.body_count; i++) {
+    const Body &b = s.bodies[i];
+
+    int16_t x, y;
+    get_position(b, x, y);
+
+    // Round to pixel
+    int px = (x + 128) >> 8;
+    int py = (y + 128) >> 8;
+
+    uint8_t brightness = b.pattern < PATTERN_COUNT ? s.pattern_level[b.pattern] : 128;
+
+    // Apply entry fade
+    brightness = (uint8_t)((brightness * b.entry) >> 15);
+
+    // Apply global brightness
+    brightness = (uint8_t)((brightness * s.global_brightness) >> 8);
+
+    if (px >= 0 && px < MATRIX_WIDTH && py >= 0 && py < MATRIX_HEIGHT) {
+      set_pixel(frame, px, py, brightness);
+    }
+  }
+}
+
+static void draw_bodies(uint8_t *frame) {
+  render_frame(state(), frame);
+}
+
+/**
+ * Drop bodies[slot] by moving the last body into its place, keeping the
+ * array dense without a compaction pass.
+ */
+static void remove_body(OrbitalState &s, uint8_t slot) {
+  s.id_slot[s.bodies[slot].id] = NO_SLOT;
+  uint8_t last = s.body_count - 1;
+  if (slot != last) {
+    s.bodies[slot] = s.bodies[last];
+    s.seen_gen[slot] = s.seen_gen[last];
+    s.id_slot[s.bodies[slot].id] = slot;
+  }
+  s.body_count = last;
+}
+
+void orbital_update(const uint8_t *data, uint16_t n) {
+  OrbitalState &s = state();
+  if (n == 0) return;
+  if (n > ORBITAL_STATE_BYTES) n = ORBITAL_STATE_BYTES;
+
+  uint8_t new_count = data[0];
+  if (new_count > ORBITAL_MAX_BODIES) new_count = ORBITAL_MAX_BODIES;
+  if (new_count > (n - 1) / 3) new_count = (n - 1) / 3;
+
+  // Zero is never a valid stamp, so stale seen_gen entries cannot match.
+  if (++s.update_gen == 0) s.update_gen = 1;
+
+  for (uint8_t i = 0; i < new_count; i++) {
+    const uint8_t *rec = &data[1 + i * 3];
+    uint8_t id = rec[0];
+
+    uint8_t slot = s.id_slot[id];
+    if (slot == NO_SLOT) {
+      if (s.body_count >= ORBITAL_MAX_BODIES) continue;
+      // Add new with entry animation
+      slot = s.body_count++;
+      s.id_slot[id] = slot;
+      Body &b = s.bodies[slot];
+      b.id = id;
+      b.angle = (uint32_t)id * 2529191520UL;  // Stagger angles (id * 3.7 rad)
+      b.entry = 0;
+    }
+    s.bodies[slot].pattern = (Pattern)rec[1];
+    s.bodies[slot].orbit = rec[2];
+    s.seen_gen[slot] = s.update_gen;
+  }
+
+  // Drop bodies missing from this update. Walk backwards so a swapped-in
+  // body has already been checked.
+  for (int i = s.body_count - 1; i >= 0; i--) {
+    if (s.seen_gen[i] != s.update_gen) remove_body(s, i);
+  }
+  compositor_mark_all(s.layers);
+}
+
+void orbital_set_brightness(uint8_t level) {
+  OrbitalState &s = state();
+  s.global_brightness = level;
+  compositor_mark_all(s.layers);
+}
+
+uint8_t orbital_set_fps(uint8_t fps) {
+  if (fps < ORBITAL_MIN_FPS) fps = ORBITAL_MIN_FPS;
+  if (fps > ORBITAL_MAX_FPS) fps = ORBITAL_MAX_FPS;
+  state().target_fps = fps;
+  return fps;
+}
+
+uint8_t orbital_fps() {
+  return state().target_fps;
+}
+
+void orbital_clear() {
+  OrbitalState &s = state();
+  s.body_count = 0;
+  memset(s.id_slot, NO_SLOT, sizeof(s.id_slot));
+  compositor_mark_all(s.layers);
+}
+
+static void orbitalEnter(uint32_t now_ms) {
+  OrbitalState &s = led_mode_reset_state<OrbitalState>();
+  memset(s.id_slot, NO_SLOT, sizeof(s.id_slot));
+  s.global_brightness = 200;
+  s.target_fps = ORBITAL_DEFAULT_FPS;
+  s.last_tick = now_ms;
+  init_patterns(s.patterns);
+  compositor_init(s.layers, MATRIX_WIDTH, MATRIX_HEIGHT, 1);
+  compositor_add(s.layers, draw_bodies, 0, 0, MATRIX_WIDTH, MATRIX_HEIGHT);
+}
+
+static uint32_t orbitalRender(uint32_t now_ms, LedCanvas &canvas) {
+  OrbitalState &s = state();
+  s.physics_acc += now_ms - s.last_tick;
+  s.last_tick = now_ms;
+
+  // Fixed-timestep physics with catch-up limiting
+  uint16_t budget = 1000 / s.target_fps / PHYSICS_STEP_MS + MAX_CATCHUP_STEPS;
+  uint16_t steps = 0;
+  while (s.physics_acc >= PHYSICS_STEP_MS && steps < budget) {
+    update_physics(s, PHYSICS_STEP_MS);
+    s.physics_acc -= PHYSICS_STEP_MS;
+    steps++;
+  }
+  if (s.physics_acc >= PHYSICS_STEP_MS) s.physics_acc = 0;
+
+  osc_bank_tick(s.patterns, steps * PHYSICS_STEP_MS);
+  update_pattern_levels(s);
+
+  if (steps > 0 && s.body_count > 0) compositor_mark_all(s.layers);
+  if (compositor_compose(s.layers, canvas.matrix)) canvas.dirty = true;
+  return 1000 / s.target_fps;
+}
+
+const LedMode MODE_ORBITAL = {
+  "orbital",
+  LED_OUT_MATRIX,
+  orbitalEnter,
+  orbitalRender,
+};
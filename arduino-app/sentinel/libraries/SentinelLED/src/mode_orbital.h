@@ -0,0 +1,32 @@
+// Orbital portfolio view on the UNO Q's 8x13 LED matrix.
+//
+// Top holdings sit in the 2x2 sun, the rest orbit it on two rings; each
+// body's animation pattern encodes its health. State arrives as an
+// updateState bin: [count, id0, pattern0, orbit0, id1, ...]. Physics runs in
+// fixed steps, so motion does not depend on when a frame got to run.
+
+#pragma once
+
+#include "led_mode.h"
+
+#define ORBITAL_MAX_BODIES 40
+// updateState bin: 1 count byte + 3 bytes per body.
+#define ORBITAL_STATE_BYTES (1 + ORBITAL_MAX_BODIES * 3)
+
+#define ORBITAL_DEFAULT_FPS 60
+#define ORBITAL_MIN_FPS 1
+#define ORBITAL_MAX_FPS 100
+
+extern const LedMode MODE_ORBITAL;
+
+// Replace the set of bodies. Ids are matched in O(1), so an update is
+// O(count); listed bodies keep their orbit position, new ones fly in.
+void orbital_update(const uint8_t *data, uint16_t n);
+
+void orbital_set_brightness(uint8_t level);
+
+// Clamp and apply the target frame rate; returns the rate now in effect.
+uint8_t orbital_set_fps(uint8_t fps);
+uint8_t orbital_fps();
+
+void orbital_clear();
@@ -0,0 +1,116 @@
+#include "mode_treemap.h"
+
+#include "fixmath.h"
+#include "oscillator.h"
+
+// 60 fps.
+static const uint32_t FRAME_MS = 16;
+
+// Brightness range per P/L band, from the README table.
+static const uint8_t BAND_MIN[TREEMAP_BANDS] = {25, 40, 60, 80, 100, 120, 150, 180};
+static const uint8_t BAND_MAX[TREEMAP_BANDS] = {95, 110, 130, 150, 170, 190, 220, 250};
+
+// Saws ramp over 80% of the cycle, pulses bump over 30%.
+static const uint32_t WAVE_DUTY[OSC_WAVE_COUNT] = {
+  OSC_DUTY_HALF, 52429, 52429, OSC_DUTY_HALF, 19661, OSC_DUTY_HALF,
+};
+
+struct Region {
+  Osc osc;
+  uint8_t x, y, w, h;
+  uint8_t lo, hi;
+  uint8_t level;   // brightness drawn last frame
+};
+
+struct TreemapState {
+  Region regions[TREEMAP_MAX_REGIONS];
+  uint8_t count;
+  bool redraw;     // regions changed since the last frame
+  uint32_t last_tick;
+};
+
+static TreemapState &state() {
+  return led_mode_state<TreemapState>();
+}
+
+bool treemap_valid(const uint8_t *data, uint16_t n) {
+  if (n < TREEMAP_BIN_HEADER) return false;
+  if (data[0] != TREEMAP_BIN_MAGIC || data[1] != TREEMAP_BIN_VERSION) return false;
+  uint8_t count = data[2];
+  if (count > TREEMAP_MAX_REGIONS || n != TREEMAP_BIN_HEADER + count * TREEMAP_REGION_BYTES) return false;
+
+  for (uint8_t i = 0; i < count; i++) {
+    const uint8_t *r = &data[TREEMAP_BIN_HEADER + i * TREEMAP_REGION_BYTES];
+    uint8_t x = r[0] >> 4, w = (r[0] & 0x0F) + 1;
+    uint8_t y = r[1] >> 4, h = (r[1] & 0x0F) + 1;
+    if (x + w > MATRIX_WIDTH || y + h > MATRIX_HEIGHT) return false;
+    if ((r[2] >> 4) >= OSC_WAVE_COUNT || (r[2] & 0x0F) >= OSC_URGENCY_COUNT) return false;
+  }
+  return true;
+}
+
+bool treemap_load(const uint8_t *data, uint16_t n) {
+  if (!treemap_valid(data, n)) return false;
+  TreemapState &s = state();
+  s.count = data[2];
+  for (uint8_t i = 0; i < s.count; i++) {
+    const uint8_t *r = &data[TREEMAP_BIN_HEADER + i * TREEMAP_REGION_BYTES];
+    Region &g = s.regions[i];
+    g.x = r[0] >> 4;
+    g.w = (r[0] & 0x0F) + 1;
+    g.y = r[1] >> 4;
+    g.h = (r[1] & 0x0F) + 1;
+    OscWave wave = (OscWave)(r[2] >> 4);
+    osc_init(g.osc, wave, OSC_URGENCY_PERIOD_MS[r[2] & 0x0F], WAVE_DUTY[wave], (uint16_t)((r[3] & 0x1F) << 11));
+    uint8_t band = r[3] >> 5;
+    g.lo = BAND_MIN[band];
+    g.hi = BAND_MAX[band];
+  }
+  s.redraw = true;
+  return true;
+}
+
+void treemap_clear() {
+  TreemapState &s = state();
+  s.count = 0;
+  s.redraw = true;
+}
+
+static void treemapEnter(uint32_t now_ms) {
+  TreemapState &s = led_mode_reset_state<TreemapState>();
+  s.last_tick = now_ms;
+  s.redraw = true;
+}
+
+static uint32_t treemapRender(uint32_t now_ms, LedCanvas &canvas) {
+  TreemapState &s = state();
+  uint32_t dt = now_ms - s.last_tick;
+  s.last_tick = now_ms;
+
+  // Uncovered pixels stay dark; only regions whose level moved are refilled.
+  bool full = s.redraw;
+  bool changed = full;
+  if (full) memset(canvas.matrix, 0, MATRIX_PIXELS);
+  s.redraw = false;
+
+  for (uint8_t i = 0; i < s.count; i++) {
+    Region &g = s.regions[i];
+    osc_advance(g.osc, dt);
+    uint8_t level = fx_lerp8(g.lo, g.hi, osc_value(g.osc));
+    if (level == g.level && !full) continue;
+    g.level = level;
+    uint8_t *row = &canvas.matrix[g.y * MATRIX_WIDTH + g.x];
+    for (uint8_t y = 0; y < g.h; y++, row += MATRIX_WIDTH) memset(row, level, g.w);
+    changed = true;
+  }
+
+  if (changed) canvas.dirty = true;
+  return FRAME_MS;
+}
+
+const LedMode MODE_TREEMAP = {
+  "treemap",
+  LED_OUT_MATRIX,
+  treemapEnter,
+  treemapRender,
+};
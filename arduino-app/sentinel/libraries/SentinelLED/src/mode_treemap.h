@@ -0,0 +1,39 @@
+// Portfolio treemap on the 8x13 matrix.
+//
+// The host lays the portfolio out once (a squarified treemap, see
+// sentinel/led/treemap.py) and ships the rectangles; the MCU only animates
+// them. Each region breathes between the brightness band of its P/L with an
+// oscillator of its own (waveform = planner action, period = urgency, see
+// oscillator.h), and is drawn as one span fill per row, so per-frame cost
+// depends on the region count, not the number of holdings behind it.
+
+#pragma once
+
+#include "led_mode.h"
+
+#define TREEMAP_MAX_REGIONS 24
+
+// updateTreemap payload: ['T', version, count, region x count], each region
+// four bytes:
+//   [0] x << 4 | (w - 1)      [1] y << 4 | (h - 1)
+//   [2] wave << 4 | urgency   [3] band << 5 | phase
+// with wave an OscWave, urgency an OscUrgency, band the README's P/L band
+// (0 = below -20% .. 7 = above +20%) and phase the start phase in 32nds of a
+// turn. Regions must lie inside the matrix.
+#define TREEMAP_BIN_MAGIC 'T'
+#define TREEMAP_BIN_VERSION 1
+#define TREEMAP_BIN_HEADER 3
+#define TREEMAP_REGION_BYTES 4
+#define TREEMAP_BIN_MAX_SIZE (TREEMAP_BIN_HEADER + TREEMAP_MAX_REGIONS * TREEMAP_REGION_BYTES)
+#define TREEMAP_BANDS 8
+
+extern const LedMode MODE_TREEMAP;
+
+// True if data is a well-formed updateTreemap payload.
+bool treemap_valid(const uint8_t *data, uint16_t n);
+
+// Replace the regions. Returns false and keeps the current ones if the
+// payload is malformed.
+bool treemap_load(const uint8_t *data, uint16_t n);
+
+void treemap_clear();
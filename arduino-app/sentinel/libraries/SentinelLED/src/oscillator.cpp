@@ -0,0 +1,80 @@
+#include "oscillator.h"
+
+#include "fixmath.h"
+
+void osc_init(Osc &o, OscWave wave, uint32_t period_ms, uint32_t duty, uint16_t phase_q16) {
+  if (period_ms < 2) period_ms = 2;
+  if (duty < 1) duty = 1;
+  if (duty > OSC_DUTY_FULL) duty = OSC_DUTY_FULL;
+  o.wave = wave;
+  o.period_ms = period_ms;
+  o.inc = (uint32_t)(((1ULL << 32) + period_ms / 2) / period_ms);
+  o.duty = duty;
+  o.phase = (uint32_t)phase_q16 << 16;
+}
+
+// Rise over [0, duty), fall over [duty, 1).
+static uint16_t ramp(uint32_t p, uint32_t duty) {
+  if (p < duty) return (uint16_t)((p * 65535UL) / duty);
+  return (uint16_t)(65535UL - ((p - duty) * 65535UL) / (OSC_DUTY_FULL - duty));
+}
+
+uint16_t osc_value(const Osc &o) {
+  uint32_t p = o.phase >> 16;
+  switch (o.wave) {
+    case OSC_SINE:
+      return fx_unipolar(fx_sin((uint16_t)p));
+    case OSC_SAW_UP:
+      return ramp(p, o.duty);
+    case OSC_SAW_DOWN:
+      return (uint16_t)(65535 - ramp(p, o.duty));
+    case OSC_TRIANGLE:
+      return ramp(p, OSC_DUTY_HALF);
+    case OSC_PULSE:
+      if (p >= o.duty) return 0;
+      // (1 - cos) / 2 over the duty part, with the angle in Q16 turns.
+      return (uint16_t)(32767 - fx_cos((uint16_t)((p << 16) / o.duty)));
+    case OSC_BLINK:
+      return p < o.duty ? 65535 : 0;
+    default:
+      return 0;
+  }
+}
+
+uint32_t osc_ms_to_edge(const Osc &o) {
+  // The other edge is the wrap at one full turn (0 in Q32).
+  uint32_t edge = osc_high(o) && o.duty < OSC_DUTY_FULL ? o.duty << 16 : 0;
+  uint32_t dist = edge - o.phase;
+  uint32_t ms = dist / o.inc + (dist % o.inc != 0);
+  return ms > 0 ? ms : 1;
+}
+
+uint8_t osc_bank_add(OscBank &b, OscWave wave, uint32_t period_ms, uint32_t duty, uint16_t phase_q16) {
+  Osc o;
+  osc_init(o, wave, period_ms, duty, phase_q16);
+  for (uint8_t i = 0; i < b.count; i++) {
+    const Osc &q = b.osc[i];
+    if (q.wave == o.wave && q.period_ms == o.period_ms && q.duty == o.duty && q.phase == o.phase) {
+      return i;
+    }
+  }
+  if (b.count >= OSC_BANK_SIZE) return OSC_NONE;
+  uint8_t i = b.count++;
+  b.osc[i] = o;
+  b.value[i] = osc_value(o);
+  return i;
+}
+
+void osc_bank_tick(OscBank &b, uint32_t dt_ms) {
+  for (uint8_t i = 0; i < b.count; i++) {
+    osc_advance(b.osc[i], dt_ms);
+    b.value[i] = osc_value(b.osc[i]);
+  }
+}
+
+void osc_bank_sync(OscBank &b, uint32_t t_ms) {
+  for (uint8_t i = 0; i < b.count; i++) {
+    osc_sync(b.osc[i], t_ms);
+    b.value[i] = osc_value(b.osc[i]);
+  }
+}
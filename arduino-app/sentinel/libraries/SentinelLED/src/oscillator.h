@@ -0,0 +1,94 @@
+// Phase-accumulator oscillators shared by the LED animations.
+//
+// An Osc keeps a Q32 phase (2^32 = one turn) and a per-ms increment, so
+// advancing it is one multiply-add whatever the period, and wrap-around is
+// free. Waveforms are evaluated from the top 16 bits (a fixmath.h phase) with
+// the quarter-wave table or a few integer ops, as Q16 unit values
+// (0 .. 65535). dt may exceed the period: the product wraps modulo one turn.
+//
+// An OscBank advances a few oscillators once per tick and caches their values,
+// so a renderer whose elements share waveforms pays one array read per element
+// per frame, however many elements there are.
+
+#pragma once
+
+#include <stdint.h>
+
+// The waveform vocabulary of arduino-app/sentinel/README.md.
+enum OscWave : uint8_t {
+  OSC_SINE = 0,       // hold / accumulate: 0.5 + 0.5 sin
+  OSC_SAW_UP = 1,     // buy: rises over the duty part of the cycle, drops over the rest
+  OSC_SAW_DOWN = 2,   // sell / reduce: OSC_SAW_UP upside down
+  OSC_TRIANGLE = 3,   // rebalance: OSC_SAW_UP at half duty
+  OSC_PULSE = 4,      // urgent: raised-cosine bump over the duty part, 0 otherwise
+  OSC_BLINK = 5,      // full for the duty part, 0 otherwise
+  OSC_WAVE_COUNT,
+};
+
+// Urgency -> period, slowest first.
+enum OscUrgency : uint8_t {
+  OSC_URGENCY_LOW = 0,
+  OSC_URGENCY_NORMAL = 1,
+  OSC_URGENCY_ELEVATED = 2,
+  OSC_URGENCY_HIGH = 3,
+  OSC_URGENCY_URGENT = 4,
+  OSC_URGENCY_COUNT,
+};
+
+static const uint16_t OSC_URGENCY_PERIOD_MS[OSC_URGENCY_COUNT] = {4000, 2500, 1500, 800, 300};
+
+// Duty cycles are Q16 fractions of the period, 1 .. OSC_DUTY_FULL.
+#define OSC_DUTY_FULL 65536UL
+#define OSC_DUTY_HALF 32768UL
+
+struct Osc {
+  uint32_t phase;      // Q32 turns
+  uint32_t inc;        // Q32 turns per ms
+  uint32_t period_ms;
+  uint32_t duty;       // Q16
+  OscWave wave;
+};
+
+// Start at phase_q16 (0 .. 65535 of a turn). period_ms is clamped to >= 2.
+void osc_init(Osc &o, OscWave wave, uint32_t period_ms, uint32_t duty = OSC_DUTY_HALF,
+              uint16_t phase_q16 = 0);
+
+static inline void osc_advance(Osc &o, uint32_t dt_ms) {
+  o.phase += o.inc * dt_ms;
+}
+
+// Align the phase with wall time, as if the oscillator had run since t = 0.
+static inline void osc_sync(Osc &o, uint32_t t_ms) {
+  o.phase = (t_ms % o.period_ms) * o.inc;
+}
+
+// Q16 unit value at the current phase.
+uint16_t osc_value(const Osc &o);
+
+// True during the duty part of the cycle (the "on" half of a blink).
+static inline bool osc_high(const Osc &o) {
+  return (o.phase >> 16) < o.duty;
+}
+
+// Whole ms until osc_high() next changes, at least 1.
+uint32_t osc_ms_to_edge(const Osc &o);
+
+#define OSC_BANK_SIZE 8
+#define OSC_NONE 0xFF
+
+struct OscBank {
+  Osc osc[OSC_BANK_SIZE];
+  uint16_t value[OSC_BANK_SIZE];   // osc_value() as of the last tick
+  uint8_t count;
+};
+
+// Add an oscillator, or return the index of an identical running one so
+// elements with the same waveform share it. Returns OSC_NONE when full.
+uint8_t osc_bank_add(OscBank &b, OscWave wave, uint32_t period_ms, uint32_t duty = OSC_DUTY_HALF,
+                     uint16_t phase_q16 = 0);
+
+// Advance every oscillator by dt_ms and refresh value[].
+void osc_bank_tick(OscBank &b, uint32_t dt_ms);
+
+// osc_sync() every oscillator to t_ms and refresh value[].
+void osc_bank_sync(OscBank &b, uint32_t t_ms);
@@ -0,0 +1,192 @@
+#include "perf_stats.h"
+
+#include <Arduino.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+
+#define REG32(addr) (*(volatile uint32_t *)(addr))
+
+#define DEMCR       REG32(0xE000EDFCUL)
+#define DEMCR_TRCENA (1UL << 24)
+#define DWT_CTRL    REG32(0xE0001000UL)
+#define DWT_CYCCNTENA (1UL << 0)
+
+#define CYCLES_PER_US (PERF_CPU_HZ / 1000000UL)
+
+// Render-time histogram: buckets 0..3 are 0..3 us, then four buckets per
+// power of two, which keeps p99 within 25% of the true value up to ~16 s.
+#define HIST_LINEAR 4
+#define HIST_BUCKETS 96
+
+struct PerfStat {
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint64_t sum;
+};
+
+struct PerfWindow {
+  PerfStat sections[PERF_SECTION_COUNT];
+  uint16_t renderHist[HIST_BUCKETS];
+  uint32_t loops;
+  uint32_t irqMasked;
+  uint32_t rpcDecoded;
+  uint32_t rpcRejected;
+  uint32_t framesShown;
+  uint32_t framesElided;
+  uint32_t startMs;
+};
+
+static PerfWindow window;
+static struct k_spinlock lock;
+static k_tid_t loopThread;
+
+static constexpr uint32_t fnv1a(const char *s, uint32_t h = 2166136261UL) {
+  return *s ? fnv1a(s + 1, (h ^ (uint8_t)*s) * 16777619UL) : h;
+}
+
+static constexpr uint32_t BUILD_ID = fnv1a(__DATE__ " " __TIME__);
+
+static uint8_t histBucket(uint32_t us) {
+  if (us < HIST_LINEAR) return (uint8_t)us;
+  uint8_t e = 31 - __builtin_clz(us);
+  uint32_t idx = HIST_LINEAR + (e - 2) * 4 + ((us >> (e - 2)) & 3);
+  return idx < HIST_BUCKETS ? (uint8_t)idx : HIST_BUCKETS - 1;
+}
+
+// Largest value that lands in bucket idx.
+static uint32_t histUpper(uint8_t idx) {
+  if (idx < HIST_LINEAR) return idx;
+  uint8_t e = (idx - HIST_LINEAR) / 4 + 2;
+  uint32_t sub = (idx - HIST_LINEAR) % 4;
+  return ((4 + sub + 1) << (e - 2)) - 1;
+}
+
+static void resetWindow(uint32_t nowMs) {
+  memset(&window, 0, sizeof(window));
+  for (uint8_t i = 0; i < PERF_SECTION_COUNT; i++) window.sections[i].min = UINT32_MAX;
+  window.startMs = nowMs;
+}
+
+static uint32_t toUs(uint32_t cycles) {
+  return cycles / CYCLES_PER_US;
+}
+
+void perf_begin() {
+#ifndef SENTINEL_LED_NATIVE
+  DEMCR |= DEMCR_TRCENA;
+  PERF_DWT_CYCCNT = 0;
+  DWT_CTRL |= DWT_CYCCNTENA;
+#endif
+  loopThread = k_current_get();
+  resetWindow(millis());
+}
+
+void perf_record(PerfSection section, uint32_t start) {
+  uint32_t cycles = perf_cycles() - start;
+  k_spinlock_key_t key = k_spin_lock(&lock);
+  PerfStat &s = window.sections[section];
+  s.count++;
+  s.sum += cycles;
+  if (cycles < s.min) s.min = cycles;
+  if (cycles > s.max) s.max = cycles;
+  if (section == PERF_RENDER) {
+    uint16_t &bucket = window.renderHist[histBucket(toUs(cycles))];
+    if (bucket < UINT16_MAX) bucket++;
+  }
+  k_spin_unlock(&lock, key);
+}
+
+void perf_loop() {
+  k_spinlock_key_t key = k_spin_lock(&lock);
+  window.loops++;
+  k_spin_unlock(&lock, key);
+}
+
+void perf_irq_masked(uint32_t cycles) {
+  k_spinlock_key_t key = k_spin_lock(&lock);
+  window.irqMasked += cycles;
+  k_spin_unlock(&lock, key);
+}
+
+void perf_rpc(bool accepted) {
+  k_spinlock_key_t key = k_spin_lock(&lock);
+  if (accepted) {
+    window.rpcDecoded++;
+  } else {
+    window.rpcRejected++;
+  }
+  k_spin_unlock(&lock, key);
+}
+
+void perf_frame(bool shown) {
+  k_spinlock_key_t key = k_spin_lock(&lock);
+  if (shown) {
+    window.framesShown++;
+  } else {
+    window.framesElided++;
+  }
+  k_spin_unlock(&lock, key);
+}
+
+static uint32_t renderP99(const PerfWindow &w) {
+  uint32_t count = w.sections[PERF_RENDER].count;
+  if (count == 0) return 0;
+  uint32_t target = count - count / 100;
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < HIST_BUCKETS; i++) {
+    seen += w.renderHist[i];
+    if (seen >= target) return histUpper(i);
+  }
+  return toUs(w.sections[PERF_RENDER].max);
+}
+
+static uint32_t freeStack() {
+#ifdef CONFIG_THREAD_STACK_INFO
+  size_t unused;
+  if (loopThread && k_thread_stack_space_get(loopThread, &unused) == 0) return (uint32_t)unused;
+#endif
+  return PERF_UNAVAILABLE;
+}
+
+static uint32_t freeHeap() {
+#if defined(CONFIG_SYS_HEAP_RUNTIME_STATS) && defined(CONFIG_COMMON_LIBC_MALLOC)
+  struct sys_memory_stats stats;
+  if (malloc_runtime_stats_get(&stats) == 0) return (uint32_t)stats.free_bytes;
+#endif
+  return PERF_UNAVAILABLE;
+}
+
+void perf_snapshot(uint32_t *out) {
+  uint32_t now = millis();
+  static PerfWindow w;
+  k_spinlock_key_t key = k_spin_lock(&lock);
+  w = window;
+  resetWindow(now);
+  k_spin_unlock(&lock, key);
+
+  uint32_t windowMs = now - w.startMs;
+  const PerfStat &render = w.sections[PERF_RENDER];
+  const PerfStat &show = w.sections[PERF_SHOW];
+  const PerfStat &bridge = w.sections[PERF_BRIDGE];
+
+  out[0] = PERF_STATS_VERSION;
+  out[1] = BUILD_ID;
+  out[2] = windowMs;
+  out[3] = windowMs ? (uint32_t)((uint64_t)w.loops * 1000 / windowMs) : 0;
+  out[4] = render.count ? toUs(render.min) : 0;
+  out[5] = render.count ? toUs((uint32_t)(render.sum / render.count)) : 0;
+  out[6] = toUs(render.max);
+  out[7] = renderP99(w);
+  out[8] = show.count ? toUs((uint32_t)(show.sum / show.count)) : 0;
+  out[9] = toUs(show.max);
+  out[10] = bridge.count ? toUs((uint32_t)(bridge.sum / bridge.count)) : 0;
+  out[11] = toUs(bridge.max);
+  out[12] = toUs(w.irqMasked);
+  out[13] = w.rpcDecoded;
+  out[14] = w.rpcRejected;
+  out[15] = freeStack();
+  out[16] = freeHeap();
+  out[17] = w.framesShown;
+  out[18] = w.framesElided;
+}
@@ -0,0 +1,69 @@
+// MCU-side timing counters for the diag/stats RPC.
+//
+// Sections are timed with the Cortex-M33 DWT cycle counter (CYCCNT, enabled
+// by perf_begin()). Counters cover a window that starts at boot or at the
+// previous perf_snapshot(), so each diag/stats poll reports the interval since
+// the last one.
+//
+// perf_snapshot() fills PERF_STATS_FIELDS uint32 values, in this order:
+//    0 version (PERF_STATS_VERSION)   1 build id (hash of __DATE__ __TIME__)
+//    2 window_ms                      3 frame-loop passes per second
+//    4 render min us   5 render mean us   6 render max us   7 render p99 us
+//    8 show mean us    9 show max us     (ws2812_show / matrix.draw)
+//   10 bridge mean us 11 bridge max us   (Bridge.update)
+//   12 interrupts-masked us (window total)
+//   13 RPC payloads decoded  14 RPC payloads rejected
+//   15 loop thread free stack bytes  16 free heap bytes
+//   17 frames sent to an output   18 frames elided as unchanged (compositor.h)
+// Fields the build cannot measure read PERF_UNAVAILABLE.
+
+#pragma once
+
+#include <stdint.h>
+
+#define PERF_STATS_VERSION 2
+#define PERF_STATS_FIELDS 19
+#define PERF_UNAVAILABLE 0xFFFFFFFFUL
+
+// Core clock CYCCNT counts at.
+#define PERF_CPU_HZ 160000000UL
+
+enum PerfSection : uint8_t {
+  PERF_RENDER = 0,
+  PERF_SHOW = 1,
+  PERF_BRIDGE = 2,
+  PERF_SECTION_COUNT,
+};
+
+#ifdef SENTINEL_LED_NATIVE
+// Host builds (firmware/native) supply a clock scaled to PERF_CPU_HZ.
+uint32_t perf_cycles();
+#else
+#define PERF_DWT_CYCCNT (*(volatile uint32_t *)0xE0001004UL)
+
+static inline uint32_t perf_cycles() {
+  return PERF_DWT_CYCCNT;
+}
+#endif
+
+// Enable the cycle counter and remember the calling thread for the stack
+// report. Call at the top of setup().
+void perf_begin();
+
+// Record one run of a section that started at perf_cycles() == start.
+void perf_record(PerfSection section, uint32_t start);
+
+// Count one pass of the sketch's frame loop (the render thread where there is one).
+void perf_loop();
+
+// Add time spent with interrupts masked.
+void perf_irq_masked(uint32_t cycles);
+
+// Count an incoming RPC payload as decoded or rejected.
+void perf_rpc(bool accepted);
+
+// Count one frame that went out to an LED output, or was dropped as a repeat.
+void perf_frame(bool shown);
+
+// Copy the current window into out[PERF_STATS_FIELDS] and start a new one.
+void perf_snapshot(uint32_t *out);
@@ -0,0 +1,138 @@
+#include "state_store.h"
+
+#include <string.h>
+
+#include "wire_format.h"
+
+#ifdef SENTINEL_LED_NATIVE
+#define STATE_NOINIT
+#else
+#include <zephyr/linker/section_tags.h>
+#define STATE_NOINIT __noinit
+#endif
+
+#if defined(CONFIG_NVS) && defined(CONFIG_FLASH_MAP)
+#include <zephyr/device.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/fs/nvs.h>
+#include <zephyr/storage/flash_map.h>
+#if FIXED_PARTITION_EXISTS(storage_partition)
+#define STATE_STORE_FLASH 1
+#endif
+#endif
+
+#ifndef STATE_STORE_FLASH
+#define STATE_STORE_FLASH 0
+#endif
+
+// XORed with the key, so a block left by older firmware or another key's
+// slot never validates.
+#define RETAINED_MAGIC 0x53544154UL
+// NVS ids for the records, clear of anything else sharing the partition.
+#define NVS_ID_BASE 0x5E00
+#define NVS_SECTORS 3
+
+struct RetainedRecord {
+  uint32_t magic;
+  uint16_t len;
+  uint16_t crc;  // crc16_ccitt of data, XOR len
+  uint8_t data[STATE_STORE_MAX_BYTES];
+};
+
+static RetainedRecord retained[STATE_KEY_COUNT] STATE_NOINIT;
+
+struct FlashSlot {
+  bool pending;  // retained copy not yet written to flash
+  bool written;  // written at least once since boot
+  uint32_t lastWriteMs;
+};
+
+static FlashSlot slots[STATE_KEY_COUNT];
+
+static uint16_t recordCrc(const uint8_t *data, uint16_t n) {
+  return (uint16_t)(crc16_ccitt(data, n) ^ n);
+}
+
+static bool retainedValid(StateKey key) {
+  const RetainedRecord &r = retained[key];
+  return r.magic == (RETAINED_MAGIC ^ key) && r.len <= STATE_STORE_MAX_BYTES &&
+         r.crc == recordCrc(r.data, r.len);
+}
+
+static void retain(StateKey key, const uint8_t *data, uint16_t n) {
+  RetainedRecord &r = retained[key];
+  memcpy(r.data, data, n);
+  r.len = n;
+  r.crc = recordCrc(data, n);
+  r.magic = RETAINED_MAGIC ^ key;
+}
+
+#if STATE_STORE_FLASH
+static struct nvs_fs nvs;
+static bool nvsReady = false;
+
+static void mountFlash() {
+  nvs.flash_device = FIXED_PARTITION_DEVICE(storage_partition);
+  if (!device_is_ready(nvs.flash_device)) return;
+  nvs.offset = FIXED_PARTITION_OFFSET(storage_partition);
+  struct flash_pages_info info;
+  if (flash_get_page_info_by_offs(nvs.flash_device, nvs.offset, &info) != 0) return;
+  uint32_t sectors = FIXED_PARTITION_SIZE(storage_partition) / info.size;
+  if (sectors < 2) return;
+  nvs.sector_size = info.size;
+  nvs.sector_count = sectors < NVS_SECTORS ? sectors : NVS_SECTORS;
+  nvsReady = nvs_mount(&nvs) == 0;
+}
+#endif
+
+void state_store_begin() {
+  memset(slots, 0, sizeof(slots));
+#if STATE_STORE_FLASH
+  mountFlash();
+#endif
+  for (uint8_t k = 0; k < STATE_KEY_COUNT; k++) {
+    StateKey key = (StateKey)k;
+    if (retainedValid(key)) continue;
+    retained[key].magic = 0;
+#if STATE_STORE_FLASH
+    // Cold boot: fall back to the flash copy.
+    uint8_t buf[STATE_STORE_MAX_BYTES];
+    if (!nvsReady) continue;
+    ssize_t n = nvs_read(&nvs, NVS_ID_BASE + k, buf, sizeof(buf));
+    if (n > 0 && n <= (ssize_t)sizeof(buf)) retain(key, buf, (uint16_t)n);
+#endif
+  }
+}
+
+bool state_store_load(StateKey key, uint8_t *out, uint16_t n) {
+  if (key >= STATE_KEY_COUNT || !retainedValid(key) || retained[key].len != n) return false;
+  memcpy(out, retained[key].data, n);
+  return true;
+}
+
+void state_store_save(StateKey key, const uint8_t *data, uint16_t n) {
+  if (key >= STATE_KEY_COUNT || n > STATE_STORE_MAX_BYTES) return;
+  if (retainedValid(key) && retained[key].len == n && memcmp(retained[key].data, data, n) == 0) {
+    return;
+  }
+  retain(key, data, n);
+  slots[key].pending = true;
+}
+
+void state_store_poll(uint32_t now_ms) {
+#if STATE_STORE_FLASH
+  if (!nvsReady) return;
+  for (uint8_t k = 0; k < STATE_KEY_COUNT; k++) {
+    FlashSlot &s = slots[k];
+    if (!s.pending) continue;
+    if (s.written && now_ms - s.lastWriteMs < STATE_STORE_FLASH_INTERVAL_MS) continue;
+    const RetainedRecord &r = retained[k];
+    if (nvs_write(&nvs, NVS_ID_BASE + k, r.data, r.len) < 0) continue;
+    s.pending = false;
+    s.written = true;
+    s.lastWriteMs = now_ms;
+  }
+#else
+  (void)now_ms;
+#endif
+}
@@ -0,0 +1,47 @@
+// Last display state kept across resets, so a unit shows its last data the
+// moment it boots instead of staying dark until the MPU pushes again.
+//
+// Each record is a small blob under a StateKey. state_store_save() copies it
+// into retained RAM at once: a .noinit block, CRC-checked, that survives warm
+// resets (watchdog, sys_reboot()) but not a power cycle. The record is also
+// marked for flash, and state_store_poll() writes marked records through
+// Zephyr NVS to the storage partition. Wear is limited in two ways:
+//
+// - a key is written at most once per STATE_STORE_FLASH_INTERVAL_MS, so only
+//   the latest of a burst of updates reaches flash;
+// - NVS skips a write whose bytes match the stored record.
+//
+// One ~100 B record every 10 minutes costs a few hundred sector erases a year
+// on a three-sector ring, against 10k cycles of STM32U5 flash endurance.
+//
+// Builds without CONFIG_NVS or a storage_partition, and host builds, keep only
+// the retained copy. Calls are not thread-safe: a caller on more than one
+// thread must serialise them itself.
+
+#pragma once
+
+#include <stdint.h>
+
+enum StateKey : uint8_t {
+  STATE_KEY_ABACUS = 0,   // sketch/: the last abacus payload
+  STATE_KEY_HEATMAP = 1,  // neopixel_heatmap_router: the last heatmap/bin reply
+  STATE_KEY_COUNT,
+};
+
+#define STATE_STORE_MAX_BYTES 96
+#define STATE_STORE_FLASH_INTERVAL_MS 600000UL
+
+// Validate the retained block and mount flash. Call once, early in setup().
+void state_store_begin();
+
+// Copy the stored record for key into out. Returns false unless a record of
+// exactly n bytes exists. Prefers the retained copy, which is never older
+// than the flash one.
+bool state_store_load(StateKey key, uint8_t *out, uint16_t n);
+
+// Keep data (n <= STATE_STORE_MAX_BYTES) as the record for key.
+void state_store_save(StateKey key, const uint8_t *data, uint16_t n);
+
+// Write records that are due to flash. Cheap when nothing is due; call it
+// from the saving thread's loop.
+void state_store_poll(uint32_t now_ms);
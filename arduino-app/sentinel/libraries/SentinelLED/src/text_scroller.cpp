@@ -0,0 +1,124 @@
+#include "text_scroller.h"
+
+#include "font5x7.h"
+
+#define GLYPH_ADVANCE (FONT5X7_WIDTH + 1)
+#define GLYPH_TOP ((MATRIX_HEIGHT - FONT5X7_HEIGHT) / 2)
+
+struct TextMessage {
+  uint8_t len;
+  char text[TEXT_MAX_LEN];
+};
+
+// One slot more than the queue holds: after a clear the renderer may still be
+// drawing the old head, and setText's message must not land on top of it.
+#define RING_SLOTS (TEXT_QUEUE_LEN + 1)
+
+// Free-running message counters; a message's slot is its number % RING_SLOTS.
+// tail and flushTo are written by the producer only, head by the renderer.
+static TextMessage ring[RING_SLOTS];
+static uint32_t tail = 0;     // next message number to queue
+static uint32_t flushTo = 0;  // messages before this one were cleared
+static uint32_t head = 0;     // message on screen
+static bool started = false;
+static uint32_t startMs = 0;
+static uint32_t shown = 0;
+static uint32_t dropped = 0;
+
+static uint32_t load(const uint32_t *v) {
+  return __atomic_load_n(v, __ATOMIC_ACQUIRE);
+}
+
+static void store(uint32_t *v, uint32_t x) {
+  __atomic_store_n(v, x, __ATOMIC_RELEASE);
+}
+
+// First live message: the renderer's head, or the last clear if it is ahead.
+static uint32_t firstLive(uint32_t h, uint32_t f) {
+  return (int32_t)(f - h) > 0 ? f : h;
+}
+
+bool text_queue(const char *text, uint16_t n) {
+  if (n == 0) return true;  // nothing to show; setText("") just clears
+  uint32_t h = load(&head);
+  uint32_t live = tail - firstLive(h, flushTo);
+  if (live >= TEXT_QUEUE_LEN || tail - h >= RING_SLOTS) {
+    dropped++;
+    return false;
+  }
+  if (n > TEXT_MAX_LEN) n = TEXT_MAX_LEN;
+  TextMessage &m = ring[tail % RING_SLOTS];
+  memcpy(m.text, text, n);
+  m.len = (uint8_t)n;
+  store(&tail, tail + 1);
+  return true;
+}
+
+void text_clear() {
+  store(&flushTo, tail);
+}
+
+// head and flushTo first: both only move towards tail, so a later tail read
+// can never be behind them.
+static uint8_t pending() {
+  uint32_t h = load(&head);
+  uint32_t f = load(&flushTo);
+  return (uint8_t)(load(&tail) - firstLive(h, f));
+}
+
+bool text_active() {
+  return pending() > 0;
+}
+
+TextStatus text_status() {
+  TextStatus s = {pending(), load(&shown), dropped};
+  return s;
+}
+
+static uint8_t glyph_column(const TextMessage &m, int32_t col) {
+  int32_t index = col / GLYPH_ADVANCE;
+  int32_t x = col % GLYPH_ADVANCE;
+  if (index >= m.len || x >= FONT5X7_WIDTH) return 0;
+  uint8_t ch = (uint8_t)m.text[index];
+  if (ch < FONT5X7_FIRST || ch > FONT5X7_LAST) ch = '?';
+  return FONT5X7[ch - FONT5X7_FIRST][x];
+}
+
+uint32_t text_render(uint32_t now, uint8_t *frame) {
+  memset(frame, 0, MATRIX_PIXELS);
+
+  uint32_t f = load(&flushTo);
+  if ((int32_t)(f - head) > 0) {
+    store(&head, f);
+    started = false;
+  }
+
+  while (head != load(&tail)) {
+    if (!started) {
+      started = true;
+      startMs = now;
+    }
+    const TextMessage &m = ring[head % RING_SLOTS];
+    // The message enters at the right edge and is done once its last column
+    // has left the left edge.
+    uint32_t step = (now - startMs) / TEXT_COLUMN_MS;
+    uint32_t span = (uint32_t)m.len * GLYPH_ADVANCE + MATRIX_WIDTH;
+    if (step >= span) {
+      store(&head, head + 1);
+      store(&shown, shown + 1);
+      started = false;
+      continue;
+    }
+
+    for (int x = 0; x < MATRIX_WIDTH; x++) {
+      int32_t col = (int32_t)step + x - MATRIX_WIDTH;
+      if (col < 0) continue;
+      uint8_t bits = glyph_column(m, col);
+      for (int y = 0; y < FONT5X7_HEIGHT; y++) {
+        if (bits & (1 << y)) frame[(GLYPH_TOP + y) * MATRIX_WIDTH + x] = TEXT_LEVEL;
+      }
+    }
+    return TEXT_COLUMN_MS - (now - startMs) % TEXT_COLUMN_MS;
+  }
+  return UINT32_MAX;
+}
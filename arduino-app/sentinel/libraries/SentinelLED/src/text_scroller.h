@@ -0,0 +1,49 @@
+// Scrolling text on the 8x13 matrix, fed from an on-MCU message queue.
+//
+// Messages are queued by the setText / queueText RPCs and scrolled right to
+// left one column every TEXT_COLUMN_MS, each once, in arrival order. The RPC
+// only copies the string into the queue, so the host never waits for a scroll
+// to finish.
+//
+// The scroller is an overlay rather than an LedMode: its state lives outside
+// the mode arena, so text queued while any mode is active is kept, and while
+// messages are pending it owns the matrix (see the sketch's renderFrame()).
+//
+// The queue is a lock-free single-producer ring: one thread (the RPC
+// handlers) calls text_queue()/text_clear(), one other thread (the renderer)
+// calls text_render(), and neither waits for the other. text_active() and
+// text_status() may be called from either.
+
+#pragma once
+
+#include "led_mode.h"
+
+#define TEXT_QUEUE_LEN 8
+#define TEXT_MAX_LEN 64        // bytes per message, longer ones are truncated
+#define TEXT_COLUMN_MS 30      // one column of scroll
+#define TEXT_LEVEL 160         // matrix brightness of lit glyph pixels
+
+struct TextStatus {
+  uint8_t pending;             // messages queued, including the one on screen
+  uint32_t shown;              // messages scrolled to the end
+  uint32_t dropped;            // messages rejected because the queue was full
+};
+
+// Append a message. Returns false (and counts a drop) if the queue is full.
+// An empty message is accepted and not queued. Bytes outside printable ASCII
+// are drawn as '?'.
+bool text_queue(const char *text, uint16_t n);
+
+// Drop every queued message, including the one on screen. The renderer
+// acts on it at its next frame; messages queued after the clear are kept.
+void text_clear();
+
+// True while a message is on screen or waiting.
+bool text_active();
+
+TextStatus text_status();
+
+// Draw the current scroll position into frame (MATRIX_PIXELS grayscale).
+// Finished messages are retired here. Returns how many ms until the next
+// column is due, or UINT32_MAX once the queue is empty (frame is then blank).
+uint32_t text_render(uint32_t now_ms, uint8_t *frame);
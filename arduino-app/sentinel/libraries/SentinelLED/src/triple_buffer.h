@@ -0,0 +1,56 @@
+// Lock-free single-producer / single-consumer handoff of the latest value.
+//
+// Three slots rotate between the two sides: the producer fills its back slot
+// and publishes it by swapping it with the middle one; the consumer swaps the
+// middle slot into its front slot when a newer value is there. Neither side
+// ever waits for the other, the consumer only sees complete values, and a
+// value the consumer did not get to is replaced by the next one, which is
+// what display state wants.
+//
+// Exactly one thread may call triple_back()/triple_publish() and exactly one
+// other thread triple_take()/triple_front(). The slots start zero-filled.
+
+#pragma once
+
+#include <stdint.h>
+
+template <typename T>
+struct TripleBuffer {
+  T slots[3];
+  uint8_t back = 0;    // producer's slot
+  uint8_t middle = 1;  // last published slot, TRIPLE_FRESH set until taken
+  uint8_t front = 2;   // consumer's slot
+};
+
+#define TRIPLE_FRESH 0x80
+#define TRIPLE_INDEX 0x03
+
+// The slot the producer writes next. Its contents are whatever was there
+// last time: write every field before publishing.
+template <typename T>
+static inline T &triple_back(TripleBuffer<T> &b) {
+  return b.slots[b.back];
+}
+
+// Make the back slot the latest value and hand the producer a free slot.
+template <typename T>
+static inline void triple_publish(TripleBuffer<T> &b) {
+  uint8_t old = __atomic_exchange_n(&b.middle, (uint8_t)(b.back | TRIPLE_FRESH), __ATOMIC_ACQ_REL);
+  b.back = old & TRIPLE_INDEX;
+}
+
+// Move the latest published value to the front slot. Returns false (and
+// leaves the front slot as it was) when nothing new was published.
+template <typename T>
+static inline bool triple_take(TripleBuffer<T> &b) {
+  if (!(__atomic_load_n(&b.middle, __ATOMIC_ACQUIRE) & TRIPLE_FRESH)) return false;
+  uint8_t old = __atomic_exchange_n(&b.middle, b.front, __ATOMIC_ACQ_REL);
+  b.front = old & TRIPLE_INDEX;
+  return true;
+}
+
+// The value last taken; stable until the next triple_take().
+template <typename T>
+static inline const T &triple_front(const TripleBuffer<T> &b) {
+  return b.slots[b.front];
+}
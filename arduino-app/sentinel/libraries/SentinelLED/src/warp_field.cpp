@@ -0,0 +1,103 @@
+#include "warp_field.h"
+
+#include "fixmath.h"
+
+// Packed int16 pairs, low half first: (x, y) coordinates and (dx, dy) axes.
+#if defined(__ARM_FEATURE_DSP)
+#include <arm_acle.h>
+
+static inline uint32_t pack16(int16_t lo, int16_t hi) {
+  return __pkhbt((uint32_t)(uint16_t)lo, (uint32_t)(uint16_t)hi, 16);
+}
+
+// lo*lo + hi*hi
+static inline int32_t dot16(uint32_t a, uint32_t b) {
+  return __smuad(a, b);
+}
+
+// lo(a)*hi(b) - hi(a)*lo(b)
+static inline int32_t cross16(uint32_t a, uint32_t b) {
+  return __smusdx(a, b);
+}
+
+static inline uint32_t add16(uint32_t a, uint32_t b) {
+  return __sadd16(a, b);
+}
+#else
+static inline uint32_t pack16(int16_t lo, int16_t hi) {
+  return (uint32_t)(uint16_t)lo | ((uint32_t)(uint16_t)hi << 16);
+}
+
+static inline int16_t lo16(uint32_t a) {
+  return (int16_t)(uint16_t)a;
+}
+
+static inline int16_t hi16(uint32_t a) {
+  return (int16_t)(uint16_t)(a >> 16);
+}
+
+static inline int32_t dot16(uint32_t a, uint32_t b) {
+  return (int32_t)lo16(a) * lo16(b) + (int32_t)hi16(a) * hi16(b);
+}
+
+static inline int32_t cross16(uint32_t a, uint32_t b) {
+  return (int32_t)lo16(a) * hi16(b) - (int32_t)hi16(a) * lo16(b);
+}
+
+static inline uint32_t add16(uint32_t a, uint32_t b) {
+  return pack16((int16_t)(lo16(a) + lo16(b)), (int16_t)(hi16(a) + hi16(b)));
+}
+#endif
+
+// Warped coordinate (Q8 px) of the pixel at packed Q8 offset r.
+static inline int32_t warpAt(uint32_t r, uint32_t axis, uint16_t phase1, uint16_t phase2) {
+  // r.d and r.p with p = (-dy, dx), both Q23 -> Q8.
+  int32_t u = dot16(r, axis) >> 15;
+  int32_t v = -cross16(r, axis) >> 15;
+  u += (fx_sin((uint16_t)(phase1 + ((v * WARP_FREQ1) >> 8))) * WARP_AMP1) >> 15;
+  u += (fx_sin((uint16_t)(phase2 + ((u * WARP_FREQ2) >> 8))) * WARP_AMP2) >> 15;
+  return u;
+}
+
+void warp_field_eval(const WarpField &f, uint8_t width, uint8_t height, uint8_t levels,
+                     int32_t *u, uint8_t *bands) {
+  uint32_t axis = pack16(f.dx, f.dy);
+  const uint32_t step2 = pack16(2 << 8, 0);
+  int32_t uMin = INT32_MAX, uMax = INT32_MIN;
+
+  int32_t *out = u;
+  for (uint8_t y = 0; y < height; y++) {
+    int16_t ry = (int16_t)((y << 8) - f.cy);
+    // Offsets of pixels x and x + 1, both advanced by one packed add.
+    uint32_t r0 = pack16((int16_t)-f.cx, ry);
+    uint32_t r1 = pack16((int16_t)((1 << 8) - f.cx), ry);
+    uint8_t x = 0;
+    for (; x + 1 < width; x += 2) {
+      int32_t a = warpAt(r0, axis, f.phase1, f.phase2);
+      int32_t b = warpAt(r1, axis, f.phase1, f.phase2);
+      *out++ = a;
+      *out++ = b;
+      if (a > b) { int32_t t = a; a = b; b = t; }
+      if (a < uMin) uMin = a;
+      if (b > uMax) uMax = b;
+      r0 = add16(r0, step2);
+      r1 = add16(r1, step2);
+    }
+    if (x < width) {
+      int32_t a = warpAt(r0, axis, f.phase1, f.phase2);
+      *out++ = a;
+      if (a < uMin) uMin = a;
+      if (a > uMax) uMax = a;
+    }
+  }
+
+  // Spread min..max over the bands with one Q16 reciprocal per frame.
+  uint32_t range = (uint32_t)(uMax - uMin);
+  if (range < 1) range = 1;
+  uint32_t scale = ((uint32_t)levels << 16) / range;
+  uint16_t n = (uint16_t)width * height;
+  for (uint16_t i = 0; i < n; i++) {
+    uint32_t band = ((uint32_t)(u[i] - uMin) * scale) >> 16;
+    bands[i] = (uint8_t)(band < levels ? band : levels - 1);
+  }
+}
@@ -0,0 +1,40 @@
+// Fixed-point warp field for the heatmap, two pixels per step.
+//
+// For each pixel r of a width x height raster, relative to the field center,
+// the kernel evaluates the heatmap's warped coordinate along the center -> end
+// axis d (p is d turned a quarter):
+//
+//   u  = r.d + WARP_AMP1 * sin(WARP_FREQ1 * (r.p) + phase1)
+//   u += WARP_AMP2 * sin(WARP_FREQ2 * u + phase2)
+//
+// and quantizes u into `levels` bands spread over the frame's min..max.
+//
+// Coordinates are Q8 pixels and the axis a Q15 unit vector, packed as int16
+// pairs so each dot product is one dual 16-bit multiply-accumulate (SMUAD /
+// SMUSDX on the Cortex-M33 DSP extension). Sines come from the fixmath
+// quarter-wave table, and normalization is one multiply by a per-frame
+// reciprocal. Nothing per pixel touches the FPU. Host builds use a portable
+// version of the same integer arithmetic, so both produce identical bands.
+
+#pragma once
+
+#include <stdint.h>
+
+// sin() amplitudes (Q8 pixels) and spatial frequencies (Q8 of Q16 turns per Q8
+// pixel, i.e. round(rad_per_px * 65536 / 2pi)).
+#define WARP_AMP1 141    // 0.55 px
+#define WARP_FREQ1 6780  // 0.65 rad/px
+#define WARP_AMP2 64     // 0.25 px
+#define WARP_FREQ2 13560 // 1.3 rad/px
+
+struct WarpField {
+  int16_t cx, cy;     // field center, Q8 pixels
+  int16_t dx, dy;     // unit axis, Q15
+  uint16_t phase1;    // time terms of the two sines, Q16 turns
+  uint16_t phase2;
+};
+
+// Fill bands[y * width + x] with 0..levels-1. u is scratch for width * height
+// values. Coordinates must stay inside +-127 px of the center.
+void warp_field_eval(const WarpField &f, uint8_t width, uint8_t height, uint8_t levels,
+                     int32_t *u, uint8_t *bands);
@@ -0,0 +1,28 @@
+// Helpers for the fixed-layout binary payloads the MPU sends as MessagePack bin.
+//
+// Multi-byte fields are little-endian. Frames end in a CRC-16/CCITT-FALSE
+// (poly 0x1021, init 0xFFFF, no reflection, no final xor); the Python encoders
+// compute the same value.
+
+#pragma once
+
+#include <stdint.h>
+
+static inline uint16_t crc16_ccitt(const uint8_t *data, uint16_t n) {
+  uint16_t crc = 0xFFFF;
+  for (uint16_t i = 0; i < n; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (uint8_t b = 0; b < 8; b++) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+static inline uint16_t rd_u16le(const uint8_t *p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t rd_u32le(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
@@ -0,0 +1,221 @@
+#include "ws2812_out.h"
+
+#include <Arduino.h>
+
+#include "perf_stats.h"
+
+// --- STM32U585 registers (non-secure aliases, RM0456) ---
+#define REG32(addr) (*(volatile uint32_t *)(addr))
+
+#define RCC_BASE        0x46020C00UL
+#define RCC_AHB1ENR     REG32(RCC_BASE + 0x088)
+#define RCC_APB1ENR1    REG32(RCC_BASE + 0x09C)
+#define RCC_GPDMA1EN    (1UL << 0)
+#define RCC_TIM3EN      (1UL << 1)
+
+#define GPIOB_BASE      0x42020400UL
+#define GPIOB_MODER     REG32(GPIOB_BASE + 0x00)
+#define GPIOB_OSPEEDR   REG32(GPIOB_BASE + 0x08)
+#define GPIOB_AFRL      REG32(GPIOB_BASE + 0x20)
+#define GPIOB_BSRR      REG32(GPIOB_BASE + 0x18)
+#define PB1_SET         (1UL << 1)
+#define PB1_RESET       (1UL << 17)
+#define PB1_AF_TIM3     2UL
+
+#define TIM3_BASE       0x40000400UL
+#define TIM3_CR1        REG32(TIM3_BASE + 0x00)
+#define TIM3_DIER       REG32(TIM3_BASE + 0x0C)
+#define TIM3_SR         REG32(TIM3_BASE + 0x10)
+#define TIM3_EGR        REG32(TIM3_BASE + 0x14)
+#define TIM3_CCMR2      REG32(TIM3_BASE + 0x1C)
+#define TIM3_CCER       REG32(TIM3_BASE + 0x20)
+#define TIM3_CNT        REG32(TIM3_BASE + 0x24)
+#define TIM3_PSC        REG32(TIM3_BASE + 0x28)
+#define TIM3_ARR        REG32(TIM3_BASE + 0x2C)
+#define TIM3_CCR4_ADDR  (TIM3_BASE + 0x40)
+#define TIM3_CCR4       REG32(TIM3_CCR4_ADDR)
+
+// GPDMA1 channel 11: a linear channel the Zephyr drivers on the UNO Q leave alone.
+#define GPDMA1_BASE     0x40020000UL
+#define DMA_CH          11
+#define DMA_CH_BASE     (GPDMA1_BASE + 0x50 + 0x80 * DMA_CH)
+#define DMA_CFCR        REG32(DMA_CH_BASE + 0x0C)
+#define DMA_CSR         REG32(DMA_CH_BASE + 0x10)
+#define DMA_CCR         REG32(DMA_CH_BASE + 0x14)
+#define DMA_CTR1        REG32(DMA_CH_BASE + 0x40)
+#define DMA_CTR2        REG32(DMA_CH_BASE + 0x44)
+#define DMA_CBR1        REG32(DMA_CH_BASE + 0x48)
+#define DMA_CSAR        REG32(DMA_CH_BASE + 0x4C)
+#define DMA_CDAR        REG32(DMA_CH_BASE + 0x50)
+#define DMA_CLLR        REG32(DMA_CH_BASE + 0x7C)
+#define DMA_REQ_TIM3_UP 65
+#define DMA_FLAGS_ALL   (0x7FUL << 8)
+
+// --- WS2812 timing at 160 MHz timer clock (APB1 prescaler 1) ---
+#define WS_TIM_CLOCK_HZ 160000000UL
+#define WS_BIT_HZ       800000UL
+#define WS_PERIOD       (WS_TIM_CLOCK_HZ / WS_BIT_HZ)   // 200 ticks = 1.25 us
+#define WS_T0H          64                             // 0.40 us
+#define WS_T1H          128                            // 0.80 us
+// Zero-duty slots before and after the data. The tail doubles as the
+// >= 280 us latch, so a new frame can start the moment DMA completes.
+#define WS_LEAD_SLOTS   2
+#define WS_TAIL_SLOTS   240
+#define WS_MAX_SLOTS    (WS_LEAD_SLOTS + WS2812_MAX_PIXELS * 24 + WS_TAIL_SLOTS)
+
+static Ws2812Backend activeBackend = WS2812_BITBANG;
+static uint16_t numBytes = 0;
+
+// --- Bit-bang backend ---
+
+static uint32_t wsEndTime = 0;
+
+static void bitbang_show(const uint8_t *p, uint16_t n) {
+  while ((micros() - wsEndTime) < 300) ;
+
+  uint32_t maskedAt = perf_cycles();
+  __asm volatile ("cpsid i" ::: "memory");
+
+  for (uint16_t i = 0; i < n; i++) {
+    uint8_t pix = p[i];
+    for (uint8_t mask = 0x80; mask; mask >>= 1) {
+      uint32_t hi = (pix & mask) ? 40u : 20u;
+      GPIOB_BSRR = PB1_SET;
+      __asm volatile (
+        "1: subs %[c], #1\n"
+        "   bne 1b\n"
+        : [c] "+r" (hi) : : "cc"
+      );
+      GPIOB_BSRR = PB1_RESET;
+      uint32_t lo = 35u;
+      __asm volatile (
+        "1: subs %[c], #1\n"
+        "   bne 1b\n"
+        : [c] "+r" (lo) : : "cc"
+      );
+    }
+  }
+
+  __asm volatile ("cpsie i" ::: "memory");
+  perf_irq_masked(perf_cycles() - maskedAt);
+  wsEndTime = micros();
+}
+
+// --- TIM3 PWM + GPDMA backend ---
+
+static uint16_t slots[2][WS_MAX_SLOTS];
+static uint16_t slotCount = 0;
+static int8_t wireBuf = -1;     // buffer currently owned by DMA, -1 when idle
+static int8_t pendingBuf = -1;  // encoded buffer waiting for the wire
+
+static void dma_init() {
+  RCC_AHB1ENR |= RCC_GPDMA1EN;
+  RCC_APB1ENR1 |= RCC_TIM3EN;
+  (void)RCC_APB1ENR1;
+
+  // PWM mode 1 on CH4 with preload, so each DMA write lands on the next period.
+  TIM3_CR1 = 0;
+  TIM3_PSC = 0;
+  TIM3_ARR = WS_PERIOD - 1;
+  TIM3_CCR4 = 0;
+  TIM3_CCMR2 = (TIM3_CCMR2 & ~(0x7UL << 12 | 1UL << 24)) | (0x6UL << 12) | (1UL << 11);
+  TIM3_CCER |= (1UL << 12);
+  TIM3_EGR = 1;
+  TIM3_SR = 0;
+
+  // Hand PB1 from the GPIO output set up by Adafruit_NeoPixel to TIM3_CH4.
+  GPIOB_AFRL = (GPIOB_AFRL & ~(0xFUL << 4)) | (PB1_AF_TIM3 << 4);
+  GPIOB_OSPEEDR |= (0x3UL << 2);
+  GPIOB_MODER = (GPIOB_MODER & ~(0x3UL << 2)) | (0x2UL << 2);
+
+  DMA_CCR = 0;
+  DMA_CFCR = DMA_FLAGS_ALL;
+}
+
+static void dma_encode(uint16_t *dst, const uint8_t *p, uint16_t n) {
+  uint16_t *s = dst;
+  for (uint8_t i = 0; i < WS_LEAD_SLOTS; i++) *s++ = 0;
+  for (uint16_t i = 0; i < numBytes; i++) {
+    uint8_t pix = (i < n) ? p[i] : 0;  // short frames are padded with black
+    for (uint8_t mask = 0x80; mask; mask >>= 1) {
+      *s++ = (pix & mask) ? WS_T1H : WS_T0H;
+    }
+  }
+  for (uint16_t i = 0; i < WS_TAIL_SLOTS; i++) *s++ = 0;
+}
+
+static void dma_start(int8_t buf) {
+  DMA_CCR = 0;
+  DMA_CFCR = DMA_FLAGS_ALL;
+  // Halfword memory -> halfword peripheral, memory increment, TIM3 update request.
+  DMA_CTR1 = (1UL << 0) | (1UL << 3) | (1UL << 16);
+  DMA_CTR2 = DMA_REQ_TIM3_UP;
+  DMA_CBR1 = (uint32_t)slotCount * sizeof(uint16_t);
+  DMA_CSAR = (uint32_t)(uintptr_t)slots[buf];
+  DMA_CDAR = TIM3_CCR4_ADDR;
+  DMA_CLLR = 0;
+  DMA_CCR = (1UL << 0);
+
+  wireBuf = buf;
+  TIM3_CNT = 0;
+  TIM3_DIER |= (1UL << 8);  // UDE
+  TIM3_CR1 |= 1;            // CEN
+}
+
+static void dma_retire() {
+  // The last slot written was a zero duty cycle, so the line idles low.
+  TIM3_CR1 &= ~1UL;
+  TIM3_DIER &= ~(1UL << 8);
+  DMA_CCR = 0;
+  DMA_CFCR = DMA_FLAGS_ALL;
+  wireBuf = -1;
+}
+
+// --- Public interface ---
+
+bool ws2812_begin(Ws2812Backend backend, uint16_t num_pixels) {
+  if (backend == WS2812_TIM_DMA && num_pixels > WS2812_MAX_PIXELS) return false;
+  activeBackend = backend;
+  numBytes = num_pixels * 3;
+  if (backend == WS2812_TIM_DMA) {
+    slotCount = WS_LEAD_SLOTS + numBytes * 8 + WS_TAIL_SLOTS;
+    wireBuf = -1;
+    pendingBuf = -1;
+    dma_init();
+  }
+  return true;
+}
+
+void ws2812_show(const uint8_t *pixels, uint16_t n) {
+  if (!pixels || n == 0) return;
+  if (n > numBytes) n = numBytes;
+
+  if (activeBackend == WS2812_BITBANG) {
+    bitbang_show(pixels, n);
+    return;
+  }
+
+  // Encode into whichever buffer is not on the wire; a frame still waiting
+  // there is simply superseded.
+  int8_t buf = (wireBuf == 0) ? 1 : 0;
+  dma_encode(slots[buf], pixels, n);
+  pendingBuf = buf;
+  ws2812_poll();
+}
+
+bool ws2812_poll() {
+  if (activeBackend != WS2812_TIM_DMA) return false;
+
+  if (wireBuf >= 0) {
+    if ((DMA_CSR & (1UL << 8)) == 0) return true;  // TCF not set yet
+    dma_retire();
+  }
+
+  if (pendingBuf >= 0) {
+    int8_t buf = pendingBuf;
+    pendingBuf = -1;
+    dma_start(buf);
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,38 @@
+// WS2812 output on D6 (PB1) of the UNO Q's STM32U585.
+//
+// Two backends share one interface:
+//   WS2812_BITBANG — cycle-counted GPIO toggling with interrupts masked for the
+//                    whole frame (the original sketch.ino driver).
+//   WS2812_TIM_DMA — TIM3 channel 4 PWM on PB1 (AF2), with GPDMA1 feeding one
+//                    compare value per bit from a double-buffered slot array.
+//                    Interrupts stay enabled and ws2812_show() only queues.
+//
+// Pixel bytes are passed through unchanged (GRB order for NEO_GRB strips, as
+// returned by Adafruit_NeoPixel::getPixels()).
+
+#pragma once
+
+#include <stdint.h>
+
+enum Ws2812Backend : uint8_t {
+  WS2812_BITBANG = 0,
+  WS2812_TIM_DMA = 1,
+};
+
+// Largest strip the DMA backend has slot memory for.
+#define WS2812_MAX_PIXELS 64
+
+// Configure the output for num_pixels pixels. Call after Adafruit_NeoPixel::begin()
+// (which leaves PB1 as a GPIO output). Returns false if num_pixels does not fit.
+bool ws2812_begin(Ws2812Backend backend, uint16_t num_pixels);
+
+// Queue a frame of n bytes (3 per pixel). With WS2812_TIM_DMA this encodes into
+// the idle buffer and returns immediately; a newer frame queued while the
+// previous one is still waiting replaces it. With WS2812_BITBANG it blocks
+// until the frame has been clocked out.
+void ws2812_show(const uint8_t *pixels, uint16_t n);
+
+// Advance the DMA backend: retire a finished transfer and start the pending
+// frame, if any. Cheap; call once per pass of the frame loop. Returns true while a frame is
+// still on the wire or waiting to be sent.
+bool ws2812_poll();
@@ -8,8 +8,11 @@ MCU renders the value as soroban-style digits on an 8×5 NeoPixel shield.
 
 from __future__ import annotations
 
+import json
 import logging
 import os
+import struct
+import threading
 import time
 from dataclasses import dataclass
 from datetime import datetime, timezone
@@ -46,6 +49,55 @@ BRIDGE_RETRY_DELAY_SEC = _env_int("LED_BRIDGE_RETRY_DELAY_SEC", 1, minimum=0)
 MAX_CONSECUTIVE_FAILURES = _env_int("LED_MAX_CONSECUTIVE_FAILURES", 5)
 WATCHDOG_STALE_SEC = _env_int("LED_WATCHDOG_STALE_SEC", DEFAULT_HEARTBEAT_STALE_SEC)
 WATCHDOG_CHECK_INTERVAL_SEC = _env_int("LED_WATCHDOG_CHECK_INTERVAL_SEC", 30)
+MODE_SYNC_INTERVAL_SEC = _env_int("LED_MODE_SYNC_INTERVAL_SEC", 5)
+TREEMAP_REFRESH_INTERVAL_SEC = _env_int("LED_TREEMAP_REFRESH_INTERVAL_SEC", 300)
+# Anim mode reloads its program only when anim.s shows a different one; this is how often
+# that, and the parameters, are checked.
+ANIM_REFRESH_INTERVAL_SEC = _env_int("LED_ANIM_REFRESH_INTERVAL_SEC", 60)
+# How long a sys.reset MCU gets to answer again (its hardware watchdog fires after 8 s).
+MCU_RESET_WAIT_SEC = _env_int("LED_MCU_RESET_WAIT_SEC", 20)
+# A stage that recovered the bridge is skipped if it is needed again within this window.
+RECOVERY_ESCALATE_SEC = _env_int("LED_RECOVERY_ESCALATE_SEC", 600)
+# /api/led/events: wait between reconnects, and how long a silent stream is trusted
+# (the server sends a keepalive every 60 s).
+EVENTS_RETRY_SEC = _env_int("LED_EVENTS_RETRY_SEC", 10)
+EVENTS_READ_TIMEOUT_SEC = _env_int("LED_EVENTS_READ_TIMEOUT_SEC", 150)
+
+# LedModeId (led_mode.h in the SentinelLED library).
+LED_MODE_ORBITAL = 1
+LED_MODE_TREEMAP = 3
+LED_MODE_ANIM = 4
+# anim.load reply once the last chunk is in and the program verified (AnimChunkResult).
+ANIM_CHUNK_COMPLETE = 2
+
+
+def _env_choice(name: str, default: str, choices: tuple[str, ...]) -> str:
+    raw = os.environ.get(name)
+    if raw is None:
+        return default
+    value = raw.strip().lower()
+    if value not in choices:
+        logger.warning("Invalid value for %s=%r (expected one of %s), using default=%s", name, raw, choices, default)
+        return default
+    return value
+
+
+# "binary" sends the fixed-layout hm.b frame; "array" sends the legacy hm.u int array.
+WIRE_FORMAT = _env_choice("LED_WIRE_FORMAT", "binary", ("binary", "array"))
+# "notify" fires hm.b without waiting and confirms delivery through the hm.s sequence ack;
+# "call" blocks on each push with retries. Notify needs the binary format (it carries seq).
+PUSH_MODE = _env_choice("LED_PUSH_MODE", "notify", ("notify", "call"))
+ACK_TIMEOUT_SEC = _env_int("LED_ACK_TIMEOUT_SEC", 2)
+ACK_WINDOW_SEC = _env_int("LED_ACK_WINDOW_SEC", 5)
+
+
+# Set on a unit fed by the display hub (GET /api/led/hub/stream): the stream carries the
+# mode and every view's payload, and this app serves heatmap/bin in place of the heatmap
+# router script. Unset, the app follows /api/led/events and fetches per view as before.
+HUB_UNIT_ID = os.environ.get("LED_HUB_UNIT_ID") or None
+# The heatmap/bin served from the hub is flagged stale once this old (cf. HEATMAP_STALE_SEC).
+HUB_STALE_SEC = _env_int("LED_HUB_STALE_SEC", 900)
+HEATMAP_FLAG_STALE = 0x01
 
 
 def _default_gateway_ip() -> str | None:
@@ -102,13 +154,42 @@ class BridgeRuntime:
     started_at_ts: int
     next_push_at_ts: int
     next_watchdog_at_ts: int
+    next_mode_sync_at_ts: int = 0
+    next_treemap_at_ts: int = 0
+    mode_id: int | None = None
+    last_treemap: bytes | None = None
+    next_anim_at_ts: int = 0
+    last_anim_set: bytes | None = None
     last_attempt_ts: int | None = None
     last_success_ts: int | None = None
     last_error_ts: int | None = None
     last_error: str | None = None
     consecutive_failures: int = 0
     last_payload: list[int] | None = None
-
+    seq: int = 0
+    sent_at_ts: int | None = None
+    acked_seq: int = 0
+    mcu_rejected: int = 0
+    mcu_skipped: int = 0
+    last_recovery: dict[str, Any] | None = None
+    last_recovery_mono: float | None = None
+    summary_etag: str | None = None
+    summary_supported: bool = True
+    # Set by the event stream thread, taken by the main loop.
+    events_connected: bool = False
+    event_summary: tuple[str | None, dict[str, Any]] | None = None
+    hub_generation: int = 0
+    hub_payloads: dict[str, Any] | None = None
+    hub_received_at: float | None = None
+    # Main loop only: the hub generation applied to the MCU, and what was sent for it.
+    hub_applied_generation: int = 0
+    hub_acked_bridge_ok: bool | None = None
+    last_orbital: bytes | None = None
+    last_heatmap: bytes | None = None
+
+
+# Guards BridgeRuntime.event_summary and hub_* between the event thread and the main loop.
+_event_lock = threading.Lock()
 
 _runtime = BridgeRuntime(
     started_at_ts=int(time.time()),
@@ -117,6 +198,44 @@ _runtime = BridgeRuntime(
 )
 
 
+# diag/stats field order (perf_stats.h in the SentinelLED library).
+MCU_STATS_FIELDS = (
+    "version",
+    "build_id",
+    "window_ms",
+    "loops_per_sec",
+    "render_min_us",
+    "render_mean_us",
+    "render_max_us",
+    "render_p99_us",
+    "show_mean_us",
+    "show_max_us",
+    "bridge_mean_us",
+    "bridge_max_us",
+    "irq_masked_us",
+    "rpc_decoded",
+    "rpc_rejected",
+    "stack_free_bytes",
+    "heap_free_bytes",
+    "frames_shown",
+    "frames_elided",
+)
+MCU_STATS_UNAVAILABLE = 0xFFFFFFFF
+
+
+def _fetch_mcu_stats() -> dict[str, int | None] | None:
+    """Read the MCU's diag/stats counters for the window since the previous read."""
+    try:
+        raw = Bridge.call("diag/stats", timeout=ACK_TIMEOUT_SEC)
+    except Exception as e:  # noqa: BLE001
+        logger.debug("diag/stats unavailable: %s", e)
+        return None
+    return {
+        name: None if int(value) == MCU_STATS_UNAVAILABLE else int(value)
+        for name, value in zip(MCU_STATS_FIELDS, raw)
+    }
+
+
 def _report_bridge_health(bridge_ok: bool, watchdog_action: str | None = None) -> None:
     payload = {
         "bridge_ok": bridge_ok,
@@ -127,15 +246,67 @@ def _report_bridge_health(bridge_ok: bool, watchdog_action: str | None = None) -
         "consecutive_failures": _runtime.consecutive_failures,
         "watchdog_action": watchdog_action,
         "app_instance": "arduino-app/sentinel",
+        "last_sent_seq": _runtime.seq,
+        "last_acked_seq": _runtime.acked_seq,
+        # Skipped while the bridge is failing, so a dead MCU costs no extra timeout.
+        "mcu_stats": _fetch_mcu_stats() if bridge_ok else None,
+        "recovery": _runtime.last_recovery,
     }
     try:
         _post("/api/led/bridge/health", payload)
     except Exception as e:  # noqa: BLE001
         logger.warning("Failed to report bridge health to API: %s", e)
-
-
-def _fetch_payload() -> tuple[list[int], dict[str, int]]:
-    """Fetch data from Sentinel API and build hm.u payload."""
+    if HUB_UNIT_ID and _runtime.hub_applied_generation and bridge_ok != _runtime.hub_acked_bridge_ok:
+        _hub_ack()
+
+
+SUMMARY_FIELDS = ("value", "return_pct", "has_recs", "broker_connected")
+
+
+def _summary_payload(summary: dict[str, Any]) -> tuple[list[int], dict[str, int]]:
+    value = max(0, min(99999999, int(summary.get("value", 0))))
+    return_pct = max(-99, min(99, int(summary.get("return_pct", 0))))
+    has_recs = 1 if summary.get("has_recs") else 0
+    broker_connected = 1 if summary.get("broker_connected") else 0
+    payload = [value, return_pct, has_recs, broker_connected]
+    return payload, dict(zip(SUMMARY_FIELDS, payload))
+
+
+def _fetch_payload() -> tuple[list[int], dict[str, int]] | None:
+    """Fetch the display summary and build the hm.u payload.
+
+    Takes the summary from the last /api/led/events event if one is waiting, otherwise makes
+    one conditional GET of /api/led/summary. Returns None when the summary matches the
+    last one (same ETag, or a 304), i.e. the payload already sent still stands. Falls back
+    to the three legacy endpoints on a Sentinel without the summary route.
+    """
+    with _event_lock:
+        pushed, _runtime.event_summary = _runtime.event_summary, None
+    if pushed is not None:
+        etag, body = pushed
+        if etag and etag == _runtime.summary_etag and _runtime.last_payload is not None:
+            return None
+        _runtime.summary_etag = etag
+        return _summary_payload(body)
+    if _runtime.summary_supported:
+        headers = {}
+        if _runtime.summary_etag and _runtime.last_payload is not None:
+            headers["If-None-Match"] = _runtime.summary_etag
+        resp = _session.get(f"{SENTINEL_API_URL}/api/led/summary", headers=headers, timeout=30)
+        if resp.status_code == 304:
+            return None
+        if resp.status_code == 404:
+            logger.warning("/api/led/summary not available; using the legacy endpoints")
+            _runtime.summary_supported = False
+        else:
+            resp.raise_for_status()
+            _runtime.summary_etag = resp.headers.get("ETag")
+            return _summary_payload(resp.json())
+    return _fetch_payload_legacy()
+
+
+def _fetch_payload_legacy() -> tuple[list[int], dict[str, int]]:
+    """Fetch data from the portfolio, planner and health endpoints and build hm.u payload."""
     portfolio = _fetch("/api/portfolio")
     total_eur = portfolio.get("total_value_eur", 0)
     value = max(0, min(99999999, round(total_eur)))
@@ -166,6 +337,70 @@ def _fetch_payload() -> tuple[list[int], dict[str, int]]:
     return [value, return_pct, has_recs, broker_connected], summary
 
 
+HM_FRAME_VERSION = 1
+HM_FLAG_RECS = 0x01
+HM_FLAG_BROKER = 0x02
+
+
+def _crc16_ccitt(data: bytes) -> int:
+    """CRC-16/CCITT-FALSE, matching crc16_ccitt() in the SentinelLED library."""
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def _encode_hm_frame(payload: list[int], seq: int) -> bytes:
+    """Encode an hm.u-style payload as the 14-byte hm.b v1 frame.
+
+    Layout (little-endian): version, flags, pnl (int8), reserved, value (uint32),
+    seq (uint32), CRC-16 over the first 12 bytes.
+    """
+    value, return_pct, has_recs, broker_connected = payload
+    flags = (HM_FLAG_RECS if has_recs else 0) | (HM_FLAG_BROKER if broker_connected else 0)
+    body = struct.pack("<BBbBII", HM_FRAME_VERSION, flags, return_pct, 0, value, seq & 0xFFFFFFFF)
+    return body + struct.pack("<H", _crc16_ccitt(body))
+
+
+def _bridge_request(payload: list[int]) -> tuple[str, Any]:
+    """Return the (method, argument) pair for pushing payload in the configured wire format."""
+    if WIRE_FORMAT == "array":
+        return "hm.u", payload
+    _runtime.seq += 1
+    return "hm.b", _encode_hm_frame(payload, _runtime.seq)
+
+
+def _state_get() -> bytes:
+    """Answer the MCU's boot-time ``state/get`` pull with the cached payload.
+
+    Returned as an hm.b frame under the current sequence number, so it also settles an
+    outstanding notify ack. Empty until the first fetch; the startup push covers that case.
+    """
+    if _runtime.last_payload is None:
+        return b""
+    return _encode_hm_frame(_runtime.last_payload, _runtime.seq)
+
+
+def _notify_mode() -> bool:
+    return PUSH_MODE == "notify" and WIRE_FORMAT == "binary"
+
+
+def _mark_success() -> None:
+    _runtime.last_success_ts = int(time.time())
+    _runtime.consecutive_failures = 0
+    _runtime.last_error = None
+    _runtime.last_error_ts = None
+
+
+def _mark_failure(error: str) -> None:
+    _runtime.consecutive_failures += 1
+    _runtime.last_error_ts = int(time.time())
+    _runtime.last_error = error
+
+
 def _force_restart(reason: str) -> None:
     logger.error("Restarting LED app container: %s", reason)
     _report_bridge_health(bridge_ok=False, watchdog_action=reason)
@@ -173,8 +408,137 @@ def _force_restart(reason: str) -> None:
     os._exit(1)
 
 
+def _reopen_bridge() -> None:
+    """Drop the arduino-router socket and dial it again, keeping the process and its caches.
+
+    app_utils releases differ in which hooks Bridge exposes, so whichever exist are used.
+    A Bridge with none of them cannot be reopened here; raising moves _recover on to the
+    next stage instead of counting a probe of the same stuck socket as a reconnect.
+    """
+    close = getattr(Bridge, "close", None)
+    reconnect = getattr(Bridge, "reconnect", None) or getattr(Bridge, "connect", None)
+    if not callable(close) and not callable(reconnect):
+        raise RuntimeError("Bridge has no close/reconnect/connect hook")
+    if callable(close):
+        close()
+    if callable(reconnect):
+        reconnect()
+
+
+def _reset_mcu() -> None:
+    """Ask the MCU to warm-reset itself (sys.reset), then wait until it answers again.
+
+    An MCU too wedged to take the call is reset by its own hardware watchdog instead.
+    """
+    try:
+        Bridge.call("sys.reset", timeout=ACK_TIMEOUT_SEC)
+    except Exception as e:  # noqa: BLE001
+        logger.warning("sys.reset not acknowledged (%s); waiting for the MCU watchdog", e)
+    deadline = time.monotonic() + MCU_RESET_WAIT_SEC
+    time.sleep(1)
+    while time.monotonic() < deadline:
+        try:
+            Bridge.call("mode.get", timeout=ACK_TIMEOUT_SEC)
+            break
+        except Exception:  # noqa: BLE001
+            time.sleep(1)
+    # The MCU came back in its boot mode without a treemap layout or anim program.
+    _runtime.next_mode_sync_at_ts = 0
+    _runtime.last_treemap = None
+    _runtime.last_anim_set = None
+
+
+def _probe_bridge() -> bool:
+    """Push the cached payload with a blocking call (or read hm.s without one)."""
+    try:
+        if _runtime.last_payload is None:
+            Bridge.call("hm.s", timeout=ACK_TIMEOUT_SEC)
+        else:
+            method, arg = _bridge_request(_runtime.last_payload)
+            Bridge.call(method, arg, timeout=BRIDGE_TIMEOUT_SEC)
+            _runtime.acked_seq = _runtime.seq
+            _runtime.sent_at_ts = None
+    except Exception as e:  # noqa: BLE001
+        _mark_failure(f"recovery probe failed: {e}")
+        return False
+    _mark_success()
+    return True
+
+
+_RECOVERY_LADDER = (("reconnect", _reopen_bridge), ("mcu_reset", _reset_mcu))
+
+
+def _recover(reason: str) -> None:
+    """Bring a stalled bridge back, cheapest step first; exit the process only as a last resort.
+
+    1. reconnect: re-open the router connection in-process.
+    2. mcu_reset: soft-reset the MCU over sys.reset, with its hardware watchdog as backstop.
+    3. process_exit: let the app supervisor restart the container (_force_restart).
+
+    After each of the first two stages the cached payload is pushed to check the bridge.
+    A stage that recovered within the last RECOVERY_ESCALATE_SEC is skipped, since it did
+    not hold. Every stage's duration goes to /api/led/bridge/health under "recovery".
+    """
+    started = time.monotonic()
+    first = 0
+    previous = _runtime.last_recovery
+    if (
+        previous is not None
+        and previous.get("recovered_stage")
+        and _runtime.last_recovery_mono is not None
+        and started - _runtime.last_recovery_mono < RECOVERY_ESCALATE_SEC
+    ):
+        names = [name for name, _ in _RECOVERY_LADDER]
+        first = names.index(previous["recovered_stage"]) + 1
+
+    recovery: dict[str, Any] = {
+        "trigger": reason,
+        "started_ts": int(time.time()),
+        "in_progress": True,
+        "recovered_stage": None,
+        "time_to_recover_ms": None,
+        "stages": [],
+    }
+    _runtime.last_recovery = recovery
+    _runtime.last_recovery_mono = started
+    _report_bridge_health(bridge_ok=False, watchdog_action=f"recovery_started_{reason}")
+
+    for name, action in _RECOVERY_LADDER[first:]:
+        stage_started = time.monotonic()
+        logger.warning("Bridge recovery (%s): %s", reason, name)
+        try:
+            action()
+            ok = _probe_bridge()
+        except Exception as e:  # noqa: BLE001
+            logger.warning("Bridge recovery stage %s failed: %s", name, e)
+            ok = False
+        recovery["stages"].append(
+            {"stage": name, "ok": ok, "duration_ms": int((time.monotonic() - stage_started) * 1000)}
+        )
+        if ok:
+            recovery["in_progress"] = False
+            recovery["recovered_stage"] = name
+            recovery["time_to_recover_ms"] = int((time.monotonic() - started) * 1000)
+            logger.warning("Bridge recovered by %s in %d ms", name, recovery["time_to_recover_ms"])
+            _report_bridge_health(bridge_ok=True, watchdog_action=f"recovered_{name}")
+            return
+
+    recovery["in_progress"] = False
+    recovery["stages"].append({"stage": "process_exit", "ok": False, "duration_ms": 0})
+    _force_restart(f"process_exit_{reason}")
+
+
 def _push_once(source: str) -> None:
-    payload, summary = _fetch_payload()
+    fetched = _fetch_payload()
+    if fetched is None:
+        if _delivered_recently():
+            logger.debug("Summary unchanged (304); skipping MCU push")
+            return
+        # Unchanged, but not yet delivered or due a keepalive: re-send what we have.
+        payload = _runtime.last_payload
+        summary = dict(zip(SUMMARY_FIELDS, payload))
+    else:
+        payload, summary = fetched
     _runtime.last_payload = payload
     _runtime.last_attempt_ts = int(time.time())
     logger.info(
@@ -186,14 +550,17 @@ def _push_once(source: str) -> None:
         source,
     )
 
+    if _notify_mode():
+        _notify_push(payload)
+        return
+
+    method, arg = _bridge_request(payload)
     last_exc: Exception | None = None
     for attempt in range(1, BRIDGE_RETRIES + 1):
         try:
-            Bridge.call("hm.u", payload, timeout=BRIDGE_TIMEOUT_SEC)
-            _runtime.last_success_ts = int(time.time())
-            _runtime.consecutive_failures = 0
-            _runtime.last_error = None
-            _runtime.last_error_ts = None
+            Bridge.call(method, arg, timeout=BRIDGE_TIMEOUT_SEC)
+            _runtime.acked_seq = _runtime.seq
+            _mark_success()
             logger.info("Bridge push success at %s", _ts_to_utc(_runtime.last_success_ts))
             _report_bridge_health(bridge_ok=True)
             return
@@ -203,22 +570,93 @@ def _push_once(source: str) -> None:
             if attempt < BRIDGE_RETRIES and BRIDGE_RETRY_DELAY_SEC > 0:
                 time.sleep(BRIDGE_RETRY_DELAY_SEC)
 
-    _runtime.consecutive_failures += 1
-    _runtime.last_error_ts = int(time.time())
-    _runtime.last_error = str(last_exc) if last_exc is not None else "unknown bridge error"
+    _mark_failure(str(last_exc) if last_exc is not None else "unknown bridge error")
     _report_bridge_health(bridge_ok=False)
     raise RuntimeError(
-        f"Request 'hm.u' failed after {BRIDGE_RETRIES} attempts: {_runtime.last_error} "
+        f"Request '{method}' failed after {BRIDGE_RETRIES} attempts: {_runtime.last_error} "
         f"(consecutive_failures={_runtime.consecutive_failures})"
     )
 
 
+def _delivered_recently() -> bool:
+    """True while the MCU holds the latest payload and the last success is fresh.
+
+    Pushes double as the bridge's liveness signal, so an unchanged summary still gets
+    re-sent once the last success is half a stale window old.
+    """
+    if _runtime.last_payload is None or _runtime.consecutive_failures:
+        return False
+    if _runtime.acked_seq != _runtime.seq or _runtime.last_success_ts is None:
+        return False
+    return int(time.time()) - _runtime.last_success_ts < WATCHDOG_STALE_SEC // 2
+
+
+def _notify_push(payload: list[int]) -> None:
+    """Fire-and-forget push; delivery is confirmed later by _check_ack()."""
+    method, arg = _bridge_request(payload)
+    try:
+        Bridge.notify(method, arg)
+    except Exception as e:  # noqa: BLE001
+        _mark_failure(f"notify failed: {e}")
+        _report_bridge_health(bridge_ok=False)
+        raise RuntimeError(
+            f"Notify '{method}' failed: {e} (consecutive_failures={_runtime.consecutive_failures})"
+        ) from e
+    _runtime.sent_at_ts = int(time.time())
+    logger.info("Bridge notify sent seq=%d", _runtime.seq)
+
+
+def _check_ack() -> None:
+    """Poll hm.s for the MCU's last applied sequence number while a push is unconfirmed.
+
+    A matching sequence marks the push delivered. If the MCU is still behind once
+    ACK_WINDOW_SEC has passed, the update is treated as lost and the latest payload is
+    re-sent under a fresh sequence number.
+    """
+    if _runtime.sent_at_ts is None or _runtime.last_payload is None:
+        return
+
+    error: str | None = None
+    try:
+        status = Bridge.call("hm.s", timeout=ACK_TIMEOUT_SEC)
+        applied, rejected, skipped = (int(x) for x in status[:3])
+        if skipped > _runtime.mcu_skipped:
+            logger.warning("MCU skipped %d frame(s)", skipped - _runtime.mcu_skipped)
+        if rejected > _runtime.mcu_rejected:
+            logger.warning("MCU rejected %d frame(s)", rejected - _runtime.mcu_rejected)
+        _runtime.acked_seq = applied
+        _runtime.mcu_rejected = rejected
+        _runtime.mcu_skipped = skipped
+        if applied == _runtime.seq & 0xFFFFFFFF:
+            _runtime.sent_at_ts = None
+            _mark_success()
+            logger.info("Bridge ack seq=%d at %s", applied, _ts_to_utc(_runtime.last_success_ts))
+            _report_bridge_health(bridge_ok=True)
+            return
+    except Exception as e:  # noqa: BLE001
+        error = f"ack poll failed: {e}"
+
+    if int(time.time()) - _runtime.sent_at_ts < ACK_WINDOW_SEC:
+        return
+
+    _mark_failure(error or f"seq {_runtime.seq} not applied (MCU at {_runtime.acked_seq})")
+    logger.warning("Bridge push lost: %s; re-sending", _runtime.last_error)
+    _report_bridge_health(bridge_ok=False)
+    if _runtime.consecutive_failures >= MAX_CONSECUTIVE_FAILURES:
+        _recover("consecutive_bridge_failures")
+        return
+    try:
+        _notify_push(_runtime.last_payload)
+    except Exception as e:  # noqa: BLE001
+        logger.warning("Re-send failed: %s", e)
+
+
 def _watchdog_check() -> None:
     now = int(time.time())
 
     if _runtime.last_success_ts is None:
         if now - _runtime.started_at_ts >= WATCHDOG_STALE_SEC:
-            _force_restart("process_exit_no_success_within_stale_window")
+            _recover("no_success_within_stale_window")
         return
 
     stale_for = now - _runtime.last_success_ts
@@ -226,7 +664,8 @@ def _watchdog_check() -> None:
         return
 
     if _runtime.last_payload is None:
-        _force_restart("process_exit_stale_no_payload")
+        _recover("stale_no_payload")
+        return
 
     logger.error(
         "Bridge stale for %ds (threshold=%ds). Executing watchdog ping.",
@@ -234,19 +673,267 @@ def _watchdog_check() -> None:
         WATCHDOG_STALE_SEC,
     )
     _runtime.last_attempt_ts = int(time.time())
+    method, arg = _bridge_request(_runtime.last_payload)
     try:
-        Bridge.call("hm.u", _runtime.last_payload, timeout=BRIDGE_TIMEOUT_SEC)
-        _runtime.last_success_ts = int(time.time())
-        _runtime.consecutive_failures = 0
-        _runtime.last_error = None
-        _runtime.last_error_ts = None
+        Bridge.call(method, arg, timeout=BRIDGE_TIMEOUT_SEC)
+        _runtime.acked_seq = _runtime.seq
+        _runtime.sent_at_ts = None
+        _mark_success()
         logger.warning("Watchdog ping recovered bridge at %s", _ts_to_utc(_runtime.last_success_ts))
         _report_bridge_health(bridge_ok=True, watchdog_action="watchdog_recovered")
     except Exception as e:  # noqa: BLE001
-        _runtime.consecutive_failures += 1
-        _runtime.last_error_ts = int(time.time())
-        _runtime.last_error = f"watchdog ping failed: {e}"
-        _force_restart("process_exit_watchdog_ping_failed")
+        _mark_failure(f"watchdog ping failed: {e}")
+        _recover("watchdog_ping_failed")
+
+
+def _sync_mode() -> None:
+    """Switch the MCU renderer to the one selected via /api/led/mode.
+
+    The MCU is asked for its active mode each time rather than trusting a cached value,
+    so a rebooted MCU (which comes back in abacus mode) is switched back as well.
+    """
+    try:
+        if HUB_UNIT_ID:
+            hub = _hub_payloads()
+            if hub is None:
+                return
+            wanted = int(hub[1]["mode_id"])
+        else:
+            wanted = int(_fetch("/api/led/mode")["mode_id"])
+    except Exception as e:  # noqa: BLE001
+        logger.warning("Failed to fetch LED mode: %s", e)
+        return
+    if wanted != _runtime.mode_id:
+        # Refresh the treemap layout or anim program straight away when switching to it.
+        _runtime.next_treemap_at_ts = 0
+        _runtime.next_anim_at_ts = 0
+    _runtime.mode_id = wanted
+    try:
+        current = int(Bridge.call("mode.get", timeout=ACK_TIMEOUT_SEC))
+        if current == wanted:
+            return
+        if wanted == LED_MODE_TREEMAP:
+            # A rebooted MCU has lost its cached layout; resend it before switching.
+            _runtime.last_treemap = None
+            _push_treemap()
+        if wanted == LED_MODE_ANIM:
+            _runtime.last_anim_set = None
+            _push_anim()
+        if wanted == LED_MODE_ORBITAL and HUB_UNIT_ID:
+            _runtime.last_orbital = None
+            _push_orbital()
+        Bridge.call("mode.set", wanted, timeout=BRIDGE_TIMEOUT_SEC)
+        logger.info("LED mode switched %d -> %d", current, wanted)
+    except Exception as e:  # noqa: BLE001
+        logger.warning("LED mode switch to %d failed: %s", wanted, e)
+
+
+def _push_treemap() -> None:
+    """Send the host-side treemap layout to the MCU when it has changed."""
+    try:
+        if HUB_UNIT_ID:
+            hub = _hub_payloads()
+            if hub is None:
+                return
+            frame = bytes.fromhex(hub[1]["treemap"])
+        else:
+            frame = bytes.fromhex(_fetch("/api/led/treemap")["frame"])
+    except Exception as e:  # noqa: BLE001
+        logger.warning("Failed to fetch LED treemap: %s", e)
+        return
+    if frame == _runtime.last_treemap:
+        return
+    try:
+        if not Bridge.call("updateTreemap", frame, timeout=BRIDGE_TIMEOUT_SEC):
+            logger.warning("MCU rejected treemap frame (%d bytes)", len(frame))
+            return
+        _runtime.last_treemap = frame
+        logger.info("Treemap pushed: %d region(s)", frame[2] if len(frame) > 2 else 0)
+    except Exception as e:  # noqa: BLE001
+        logger.warning("Treemap push failed: %s", e)
+
+
+def _hub_payloads() -> tuple[int, dict[str, Any], float] | None:
+    """(generation, payloads, received_at) of the last hub bundle, None before the first."""
+    with _event_lock:
+        if _runtime.hub_payloads is None:
+            return None
+        return _runtime.hub_generation, _runtime.hub_payloads, _runtime.hub_received_at or 0.0
+
+
+def _push_orbital() -> None:
+    """Send the hub's orbital bodies to the MCU when they have changed."""
+    hub = _hub_payloads()
+    if hub is None:
+        return
+    state = bytes.fromhex(hub[1]["orbital"])
+    if state == _runtime.last_orbital:
+        return
+    try:
+        Bridge.call("updateState", state, timeout=BRIDGE_TIMEOUT_SEC)
+        _runtime.last_orbital = state
+        logger.info("Orbital state pushed: %d body(ies)", state[0] if state else 0)
+    except Exception as e:  # noqa: BLE001
+        logger.warning("Orbital push failed: %s", e)
+
+
+def _hub_heatmap(*_: Any) -> bytes:
+    """heatmap/bin for the MCU's heatmap worker, from the hub bundle.
+
+    Flagged stale while the stream is down and the bundle is older than HUB_STALE_SEC.
+    """
+    hub = _hub_payloads()
+    if hub is None:
+        raise RuntimeError("no display hub bundle yet")
+    frame = bytearray.fromhex(hub[1]["heatmap"])
+    if not _runtime.events_connected and time.time() - hub[2] > HUB_STALE_SEC:
+        frame[3] |= HEATMAP_FLAG_STALE
+    return bytes(frame)
+
+
+def _hub_ack() -> None:
+    bridge_ok = _runtime.consecutive_failures == 0
+    payload = {
+        "generation": _runtime.hub_applied_generation,
+        "applied_seq": _runtime.acked_seq,
+        "bridge_ok": bridge_ok,
+        "mode_id": _runtime.mode_id,
+        "error": None if bridge_ok else _runtime.last_error,
+    }
+    try:
+        _post(f"/api/led/hub/units/{HUB_UNIT_ID}/ack", payload)
+        _runtime.hub_acked_bridge_ok = bridge_ok
+    except Exception as e:  # noqa: BLE001
+        logger.warning("Failed to ack display hub generation %d: %s", _runtime.hub_applied_generation, e)
+
+
+def _apply_hub() -> None:
+    """Apply a new hub generation: mode, then the active view's payload, then ack it.
+
+    Every unit gets the same bundle at the same moment and applies it on its next tick,
+    so the displays move together. The abacus summary rides the same event through
+    _push_once().
+    """
+    hub = _hub_payloads()
+    if hub is None or hub[0] == _runtime.hub_applied_generation:
+        return
+    generation, payloads, _ = hub
+    _sync_mode()
+    _runtime.next_mode_sync_at_ts = int(time.time()) + MODE_SYNC_INTERVAL_SEC
+    if _runtime.mode_id == LED_MODE_TREEMAP:
+        _push_treemap()
+    elif _runtime.mode_id == LED_MODE_ORBITAL:
+        _push_orbital()
+    elif _runtime.mode_id == LED_MODE_ANIM:
+        _push_anim()
+    heatmap = bytes.fromhex(payloads["heatmap"])
+    if heatmap != _runtime.last_heatmap:
+        _runtime.last_heatmap = heatmap
+        try:
+            # The MCU's heatmap worker polls heatmap/bin at once rather than in up to 30 s.
+            Bridge.notify("heatmap/changed")
+        except Exception as e:  # noqa: BLE001
+            logger.warning("heatmap/changed notify failed: %s", e)
+    _runtime.hub_applied_generation = generation
+    _hub_ack()
+    logger.info("Display hub generation %d applied (mode %s)", generation, _runtime.mode_id)
+
+
+def _push_anim() -> None:
+    """Upload the anim program if the MCU runs a different one, then send changed parameters.
+
+    The program goes up once, in anim.load chunks; afterwards only the few bytes of anim.set
+    follow the display summary.
+    """
+    try:
+        if HUB_UNIT_ID:
+            hub = _hub_payloads()
+            if hub is None:
+                return
+            anim = hub[1]["anim"]
+        else:
+            anim = _fetch("/api/led/anim")
+    except Exception as e:  # noqa: BLE001
+        logger.warning("Failed to fetch LED anim program: %s", e)
+        return
+    try:
+        loaded = int(Bridge.call("anim.s", timeout=ACK_TIMEOUT_SEC)[0])
+        if loaded != anim["id"]:
+            result = None
+            for chunk in anim["chunks"]:
+                result = int(Bridge.call("anim.load", bytes.fromhex(chunk), timeout=BRIDGE_TIMEOUT_SEC))
+                if not result:
+                    break
+            if result != ANIM_CHUNK_COMPLETE:
+                logger.warning("MCU rejected anim program %04x (%d chunk(s))", anim["id"], len(anim["chunks"]))
+                return
+            logger.info("Anim program %04x loaded: %d bytes", anim["id"], len(anim["image"]) // 2)
+        params = bytes.fromhex(anim["set"])
+        if params == _runtime.last_anim_set:
+            return
+        if not Bridge.call("anim.set", params, timeout=BRIDGE_TIMEOUT_SEC):
+            logger.warning("MCU rejected anim parameters (%d bytes)", len(params))
+            return
+        _runtime.last_anim_set = params
+    except Exception as e:  # noqa: BLE001
+        logger.warning("Anim push failed: %s", e)
+
+
+def _parse_sse(lines: Any) -> Any:
+    """(event, data) pairs from the lines of a text/event-stream; comments are skipped."""
+    event, data = "message", []
+    for line in lines:
+        if not line:
+            if data:
+                yield event, "\n".join(data)
+            event, data = "message", []
+        elif line.startswith(":"):
+            continue
+        else:
+            field, _, value = line.partition(":")
+            value = value[1:] if value.startswith(" ") else value
+            if field == "event":
+                event = value
+            elif field == "data":
+                data.append(value)
+
+
+def _follow_events() -> None:
+    """Follow /api/led/events and hand each display event's summary to the main loop.
+
+    With LED_HUB_UNIT_ID set it follows the unit's hub stream instead, whose display
+    events also carry the bundle's generation and payloads. Runs on its own thread and
+    session. Gives up on a Sentinel without the route, which leaves the app on plain polling.
+    """
+    session = requests.Session()
+    url = f"{SENTINEL_API_URL}/api/led/events"
+    if HUB_UNIT_ID:
+        url = f"{SENTINEL_API_URL}/api/led/hub/stream?unit={HUB_UNIT_ID}"
+    while True:
+        try:
+            with session.get(url, stream=True, timeout=(10, EVENTS_READ_TIMEOUT_SEC)) as resp:
+                if resp.status_code == 404:
+                    logger.info("%s not available; polling every %ss", url, REFRESH_INTERVAL_SEC)
+                    return
+                resp.raise_for_status()
+                _runtime.events_connected = True
+                logger.info("Following display events")
+                for event, data in _parse_sse(resp.iter_lines(decode_unicode=True)):
+                    if event != "display":
+                        continue
+                    body = json.loads(data)
+                    with _event_lock:
+                        _runtime.event_summary = (body.get("etag"), body["summary"])
+                        if "payloads" in body:
+                            _runtime.hub_generation = int(body["generation"])
+                            _runtime.hub_payloads = body["payloads"]
+                            _runtime.hub_received_at = time.time()
+                    logger.info("Display event: %s", ",".join(body.get("sources") or []))
+        except Exception as e:  # noqa: BLE001
+            logger.warning("Display event stream lost: %s", e)
+        finally:
+            _runtime.events_connected = False
+        time.sleep(EVENTS_RETRY_SEC)
 
 
 def _tick() -> None:
@@ -256,14 +943,36 @@ def _tick() -> None:
         _watchdog_check()
         _runtime.next_watchdog_at_ts = now + WATCHDOG_CHECK_INTERVAL_SEC
 
-    if now >= _runtime.next_push_at_ts:
+    if HUB_UNIT_ID:
+        _apply_hub()
+
+    if now >= _runtime.next_mode_sync_at_ts:
+        _sync_mode()
+        _runtime.next_mode_sync_at_ts = now + MODE_SYNC_INTERVAL_SEC
+
+    if _runtime.mode_id == LED_MODE_TREEMAP and not HUB_UNIT_ID and now >= _runtime.next_treemap_at_ts:
+        _push_treemap()
+        _runtime.next_treemap_at_ts = now + TREEMAP_REFRESH_INTERVAL_SEC
+
+    event = _runtime.event_summary is not None
+    if _runtime.mode_id == LED_MODE_ANIM and (event or now >= _runtime.next_anim_at_ts):
+        # The parameters follow the display summary, so a display event refreshes them too.
+        _push_anim()
+        _runtime.next_anim_at_ts = now + ANIM_REFRESH_INTERVAL_SEC
+
+    if _notify_mode():
+        _check_ack()
+
+    if event or now >= _runtime.next_push_at_ts:
         try:
-            _push_once("scheduled")
+            _push_once("event" if event else "scheduled")
         except Exception as e:  # noqa: BLE001
             logger.warning("Heatmap push failed: %s", e)
             if _runtime.consecutive_failures >= MAX_CONSECUTIVE_FAILURES:
-                _force_restart("process_exit_consecutive_bridge_failures")
-        _runtime.next_push_at_ts = now + REFRESH_INTERVAL_SEC
+                _recover("consecutive_bridge_failures")
+        # With the event stream up, scheduled pushes are only the keepalive.
+        interval = WATCHDOG_STALE_SEC // 2 if _runtime.events_connected else REFRESH_INTERVAL_SEC
+        _runtime.next_push_at_ts = now + interval
 
     time.sleep(1)
 
@@ -271,7 +980,9 @@ def _tick() -> None:
 def main() -> None:
     logger.info("Sentinel LED abacus app starting...")
     logger.info(
-        "Config: refresh=%ss retries=%s timeout=%ss stale=%ss watchdog=%ss max_failures=%s api=%s",
+        "Config: wire=%s push=%s refresh=%ss retries=%s timeout=%ss stale=%ss watchdog=%ss max_failures=%s api=%s",
+        WIRE_FORMAT,
+        PUSH_MODE if _notify_mode() else "call",
         REFRESH_INTERVAL_SEC,
         BRIDGE_RETRIES,
         BRIDGE_TIMEOUT_SEC,
@@ -280,10 +991,17 @@ def main() -> None:
         MAX_CONSECUTIVE_FAILURES,
         SENTINEL_API_URL,
     )
+    # Registered before the first push, so an MCU that boots alongside the app can pull.
+    Bridge.provide("state/get", _state_get)
+    if HUB_UNIT_ID:
+        # Takes over from scripts/uno_q_heatmap_router_server.py, which a hub unit does not run.
+        Bridge.provide("heatmap/bin", _hub_heatmap)
+        logger.info("Display hub unit '%s'", HUB_UNIT_ID)
     try:
         _push_once("startup")
     except Exception as e:  # noqa: BLE001
         logger.warning("Initial push failed: %s", e)
+    threading.Thread(target=_follow_events, name="led-events", daemon=True).start()
     logger.info(
         "Ready: updates every %ss, watchdog checks every %ss, last_success=%s",
         REFRESH_INTERVAL_SEC,
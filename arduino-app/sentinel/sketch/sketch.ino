@@ -1,219 +1,853 @@
-// NeoPixel Shield (8x5) — soroban abacus portfolio value display.
+// Sentinel LED firmware — abacus, orbital, heatmap, treemap and anim views in one image.
 //
-// Shield is natively 8 wide x 5 tall, progressive (non-serpentine) wiring.
-// MPU sends Bridge.call("hm.u", [total_value_eur, return_pct, has_recs, broker_connected]).
-// MCU displays the value as soroban-style decimal digits:
-//   Row 0 (top): heaven bead (orange, worth 5)
-//   Rows 1-4: earth bead position marker (amber, worth 1-4)
-//   Only the single position-indicator bead is lit per earth section.
-// Column 0 indicators:
-//   r0: broker connected (red blink, 200ms on / 1000ms off) — only when data is fresh
-//   r1-r3: P/L bar (green up / red down, 800ms blink)
-//   r4: recommendations (blue, 100ms on / 300ms off) — pending trades exist
+// The renderers live in SentinelLED (../libraries/SentinelLED) as LedMode
+// modules sharing one state arena; this sketch owns the outputs, the Bridge
+// glue and the mode switch. Bridge.call("mode.set", id) selects the view
+// (0 abacus, 1 orbital, 2 heatmap, 3 treemap, 4 anim, see LedModeId) without reflashing;
+// "mode.get" returns the active id. The MPU app follows /api/led/mode.
 //
-// Device-only patches (not in this repo):
-// - bridge.h UPDATE_THREAD_STACK_SIZE changed from 500 to 8192
-// - Arduino_RPClite.h DECODER_BUFFER_SIZE changed from 1024 to 256
+// Abacus (NeoPixel shield, 8x5, progressive wiring), see mode_abacus.h:
+//   Bridge.notify/call("hm.b", <14-byte frame>) (see hmBinary), or the legacy
+//   Bridge.call("hm.u", [total_value_eur, return_pct, has_recs, broker_connected]).
+//   Bridge.call("hm.s") reports the last applied hm.b sequence number.
+// Orbital (8x13 matrix), see mode_orbital.h:
+//   updateState(bin), setBrightness(level), setFps(fps), clear().
+// Heatmap (NeoPixel shield, portrait), see mode_heatmap.h:
+//   a low-priority worker thread polls "heatmap/bin" every 30s while the mode
+//   is active and hands the result to the render thread, which swaps it in
+//   between frames. Bridge.notify("heatmap/changed") from the MPU polls at once.
+// Treemap (8x13 matrix), see mode_treemap.h:
+//   Bridge.call("updateTreemap", bin) with the host-computed layout; returns
+//   whether the payload was well-formed.
+// Anim (NeoPixel shield), see mode_anim.h and anim_vm.h:
+//   Bridge.call("anim.load", chunk) uploads a VM program in chunks of up to
+//   ANIM_CHUNK_MAX bytes and returns an AnimChunkResult (0 rejected, 1 more,
+//   2 loaded); the image is verified here before the renderer sees it.
+//   Bridge.call("anim.set", bin) sets parameters, [index, int16 LE] per entry.
+//   Bridge.call("anim.s") reports [program id, instructions, frame_ms], id 0
+//   while none is loaded.
+// Text (8x13 matrix, over whichever mode is active), see text_scroller.h:
+//   Bridge.call("queueText", str) appends a message to the on-MCU queue,
+//   "setText" replaces the queue with one message; both return at once with
+//   whether the message fit. "text.s" reports [pending, shown, dropped].
+//
+// Abacus, orbital, treemap and anim payloads are also kept here, so a view that was switched
+// away from comes back with its last data instead of blank.
+//
+// Boot: the last abacus payload is kept in retained RAM and, rate-limited, in
+// flash (state_store.h), and is shown as stale from the first frame. The first
+// loop() passes then pull Bridge.call("state/get"), which the MPU app answers
+// with its cached payload as an hm.b frame, so live data lands as soon as the
+// router is up rather than at the next scheduled push.
+//
+// Rendering runs on its own thread (renderLoop()) at the lowest cooperative
+// priority, above loop(), the bridge and the heatmap fetch thread, so a frame
+// is never preempted halfway and a slow RPC never delays one. RPC handlers
+// only decode and publish: each kind of state goes through a lock-free
+// single-producer/single-consumer TripleBuffer (triple_buffer.h), so neither
+// side ever blocks on the other and the renderer only sees whole updates.
+// The renderer applies them, and switches modes, between frames, sleeping for
+// as long as the active mode asks; handlers wake it early. Abacus data has a
+// second producer, loop()'s boot-time state/get pull, so its producers share
+// a mutex (abacusLock); the renderer never takes it.
+//
+// LED output goes through SentinelLED's WS2812 backends, so shield frames only
+// queue and DMA clocks them out with interrupts on. The canvas is retained
+// between frames and modes redraw only the layers that changed (compositor.h);
+// a frame equal to the one already on an output is not sent at all.
+//
+// Recovery (mcu_watchdog.h): Bridge.call("sys.reset") replies, then warm-resets
+// the MCU; the MPU app uses it when reconnecting to the router was not enough.
+// The hardware watchdog is fed from loop() only while the render thread keeps
+// completing frames and, once the MPU app has called in, RPC handlers keep
+// running, so a wedged bridge or renderer resets the MCU on its own.
+//
+// Bridge.call("diag/stats") returns the perf_stats.h counters (render, output
+// and Bridge.update timings, RPC decode counts, free stack/heap) for the
+// window since the previous call.
 
 #define MSGPACK_MAX_ARRAY_SIZE 48
-#define MSGPACK_MAX_PACKET_BYTE_SIZE 48
+#define MSGPACK_MAX_PACKET_BYTE_SIZE 128
 #define MSGPACK_MAX_OBJECT_SIZE 48
 #define ARX_HAVE_LIBSTDCPLUSPLUS 0
 
 #include <Arduino_RouterBridge.h>
 #include <Adafruit_NeoPixel.h>
+#include <Arduino_LED_Matrix.h>
+#include <SentinelLED.h>
+#include <string.h>
+#include <zephyr/kernel.h>
 
 #define PIN 6
-#define NUMPIXELS 40
-#define BRIGHTNESS 3  // raw RGB value
-
-// --- WS2812 bitbang for STM32U585 (Zephyr) ---
-#define GPIOB_BSRR (*(volatile uint32_t *)0x42020418UL)
-#define PB1_SET    (1UL << 1)
-#define PB1_RESET  (1UL << 17)
-
-static uint32_t wsEndTime = 0;
-
-static void ws2812_show(Adafruit_NeoPixel &strip) {
-  uint8_t *p = strip.getPixels();
-  uint16_t n = strip.numPixels() * 3;
-  if (!p || n == 0) return;
-
-  while ((micros() - wsEndTime) < 300) ;
-
-  __asm volatile ("cpsid i" ::: "memory");
-
-  for (uint16_t i = 0; i < n; i++) {
-    uint8_t pix = p[i];
-    for (uint8_t mask = 0x80; mask; mask >>= 1) {
-      uint32_t hi = (pix & mask) ? 40u : 20u;
-      GPIOB_BSRR = PB1_SET;
-      __asm volatile (
-        "1: subs %[c], #1\n"
-        "   bne 1b\n"
-        : [c] "+r" (hi) : : "cc"
-      );
-      GPIOB_BSRR = PB1_RESET;
-      uint32_t lo = 35u;
-      __asm volatile (
-        "1: subs %[c], #1\n"
-        "   bne 1b\n"
-        : [c] "+r" (lo) : : "cc"
-      );
-    }
-  }
+#define NUMPIXELS SHIELD_PIXELS
+
+// WS2812 output backend: WS2812_TIM_DMA queues frames to TIM3 PWM + GPDMA and
+// keeps interrupts enabled; WS2812_BITBANG is the original cpsid-masked driver.
+#define LED_BACKEND WS2812_TIM_DMA
+
+// Mode shown after boot.
+#define DEFAULT_MODE LED_MODE_ABACUS
+
+static const uint32_t HEATMAP_POLL_INTERVAL_MS = 30000;
+// state/get pull after boot: retried while the MPU app is not answering yet.
+static const uint32_t STATE_PULL_RETRY_MS = 2000;
+static const uint8_t STATE_PULL_ATTEMPTS = 30;
+#define FETCH_STACK_SIZE 4096
+#define RENDER_STACK_SIZE 4096
+#define RENDER_PRIORITY K_PRIO_COOP(CONFIG_NUM_COOP_PRIORITIES - 1)
+// loop() only services Bridge.update(); nap between passes.
+#define BRIDGE_POLL_MS 2
+// Longer than any render sleep (RENDER_MAX_WAIT_MS) plus a slow RPC.
+#define WATCHDOG_TIMEOUT_MS 8000
+// Once the MPU app has called in, this long without a handler running means
+// the RouterBridge thread is wedged; the app polls mode.get every 5 s.
+#define BRIDGE_STALL_MS 60000
+// Cap on a render sleep, whatever the mode asks for: the watchdog is only fed
+// while render passes keep coming.
+#define RENDER_MAX_WAIT_MS 1000
+// Lets the sys.reset reply go out before the reset.
+#define SYS_RESET_DELAY_MS 200
 
-  __asm volatile ("cpsie i" ::: "memory");
-  wsEndTime = micros();
+Adafruit_NeoPixel pixels(NUMPIXELS, PIN, NEO_GRB + NEO_KHZ800);
+ArduinoLEDMatrix matrix;
+
+static const LedMode *const MODES[LED_MODE_COUNT] = {
+  &MODE_ABACUS,
+  &MODE_ORBITAL,
+  &MODE_HEATMAP,
+  &MODE_TREEMAP,
+  &MODE_ANIM,
+};
+
+// Owned by the render thread.
+static LedCanvas canvas;
+static uint8_t activeMode = LED_MODE_COUNT;  // none until the first switch
+static atomic_t requestedMode = ATOMIC_INIT(DEFAULT_MODE);
+
+// Given by RPC handlers so the render thread wakes as soon as new data lands.
+static struct k_sem wakeSem;
+
+K_THREAD_STACK_DEFINE(renderStack, RENDER_STACK_SIZE);
+static struct k_thread renderThread;
+// Frames completed, read by loop() to decide whether to feed the watchdog.
+static atomic_t renderPasses = ATOMIC_INIT(0);
+// RPCs the RouterBridge thread has dispatched, bumped on entry to every
+// handler; read by loop() for the same purpose.
+static atomic_t bridgeBeats = ATOMIC_INIT(0);
+
+static inline void bridgeBeat() {
+  atomic_inc(&bridgeBeats);
 }
 
-// --- Abacus display ---
+// Last frame sent to each output; a repeat never reaches the LEDs.
+static LedFrameGate shieldGate;
+static LedFrameGate matrixGate;
+
+static void pushFrame(LedOutput out, uint8_t *frame) {
+  if (out == LED_OUT_SHIELD) {
+    if (!frame_gate_pass(shieldGate, frame, SHIELD_PIXELS * 3)) return;
+    uint32_t start = perf_cycles();
+    ws2812_show(frame, SHIELD_PIXELS * 3);
+    perf_record(PERF_SHOW, start);
+  } else {
+    if (!frame_gate_pass(matrixGate, frame, MATRIX_PIXELS)) return;
+    uint32_t start = perf_cycles();
+    matrix.draw(frame);
+    perf_record(PERF_SHOW, start);
+  }
+}
 
-Adafruit_NeoPixel pixels(NUMPIXELS, PIN, NEO_GRB + NEO_KHZ800);
+static void pushOutput(LedOutput out) {
+  pushFrame(out, out == LED_OUT_SHIELD ? canvas.shield : canvas.matrix);
+}
 
-static int displayValue = 0;
-static int displayPnl = 0;
-static int hasRecs = 0;
-static int brokerConnected = 0;
-static bool needsRedraw = false;
+// --- Abacus glue ---
+
+#define HM_FLAG_RECS   0x01
+#define HM_FLAG_BROKER 0x02
+
+static TripleBuffer<AbacusData> abacusIn;
+// Held by every abacus producer: the hm.u/hm.b handlers on the RouterBridge
+// thread and loop()'s state/get pull. It guards abacusIn's back slot,
+// abacusData, the hm.s counters and, since both threads save and flush
+// records, every state_store.h call.
+static struct k_mutex abacusLock;
+// The last payload published, which hm.u updates field by field.
+static AbacusData abacusData = {0, 0, false, false, false};
+// Render thread: abacusIn's front slot holds data.
+static bool haveAbacusData = false;
+
+// Stored abacus record: value (uint32 LE), pnl (int8), hm.b flags.
+#define ABACUS_RECORD_SIZE 6
+
+static void publishAbacus(const AbacusData &data) {
+  abacusData = data;
+  triple_back(abacusIn) = data;
+  triple_publish(abacusIn);
+  k_sem_give(&wakeSem);
+}
 
-// Last successful RPC timestamp (millis).
-static unsigned long lastRpcMs = 0;
-// Incoming data considered fresh if RPC received within 10 minutes.
-#define HEARTBEAT_TIMEOUT_MS 600000UL
+static void applyAbacus(const AbacusData &data) {
+  publishAbacus(data);
+  uint8_t rec[ABACUS_RECORD_SIZE];
+  for (int i = 0; i < 4; i++) rec[i] = (uint8_t)((uint32_t)data.value >> (8 * i));
+  rec[4] = (uint8_t)(int8_t)data.pnl;
+  rec[5] = (data.recs ? HM_FLAG_RECS : 0) | (data.broker ? HM_FLAG_BROKER : 0);
+  state_store_save(STATE_KEY_ABACUS, rec, sizeof(rec));
+}
 
-// Blink states (computed from millis modulo).
-static bool pnlBlinkOn = true;
-static bool heartbeatOn = false;
-static bool recBlinkOn = false;
+// Boot: show the stored payload as stale until a live one arrives.
+static void restoreAbacus() {
+  uint8_t rec[ABACUS_RECORD_SIZE];
+  if (!state_store_load(STATE_KEY_ABACUS, rec, sizeof(rec))) return;
+  AbacusData d;
+  d.value = (int32_t)rd_u32le(rec);
+  d.pnl = (int8_t)rec[4];
+  d.recs = (rec[5] & HM_FLAG_RECS) != 0;
+  d.broker = (rec[5] & HM_FLAG_BROKER) != 0;
+  d.stale = true;
+  publishAbacus(d);
+}
 
-static void renderDisplay() {
-  pixels.clear();
+// Legacy array payload; fields after the first are optional.
+static void hmUpdate(MsgPack::arr_t<int> data) {
+  bridgeBeat();
+  if ((int)data.size() < 1) {
+    perf_rpc(false);
+    return;
+  }
+  perf_rpc(true);
+  k_mutex_lock(&abacusLock, K_FOREVER);
+  AbacusData d = abacusData;
+  d.stale = false;
+  d.value = data[0];
+  if ((int)data.size() >= 2) d.pnl = data[1];
+  if ((int)data.size() >= 3) d.recs = data[2] > 0;
+  if ((int)data.size() >= 4) d.broker = data[3] > 0;
+  applyAbacus(d);
+  k_mutex_unlock(&abacusLock);
+}
 
-  int val = displayValue;
-  if (val < 0) val = 0;
+// hm.b v1 frame (14 bytes, little-endian):
+//   [0] version  [1] flags (bit0 has_recs, bit1 broker_connected)
+//   [2] pnl (int8)  [3] reserved
+//   [4..7] value (uint32)  [8..11] seq (uint32)  [12..13] CRC-16 over [0..11]
+#define HM_FRAME_VERSION 1
+#define HM_FRAME_SIZE 14
+
+struct HmFrame {
+  uint32_t value;
+  uint32_t seq;
+  int8_t pnl;
+  uint8_t flags;
+};
+
+static HmFrame hmFrame;
+static uint32_t hmRejected = 0;
+// Sequence number of the last applied hm.b frame, and how many sequence
+// numbers the incoming frames skipped (updates lost between MPU and MCU).
+static uint32_t hmAppliedSeq = 0;
+static uint32_t hmSkipped = 0;
+
+static bool decodeHmFrame(const uint8_t *p, uint16_t n, HmFrame &out) {
+  if (n != HM_FRAME_SIZE || p[0] != HM_FRAME_VERSION) return false;
+  if (crc16_ccitt(p, HM_FRAME_SIZE - 2) != rd_u16le(p + HM_FRAME_SIZE - 2)) return false;
+  out.flags = p[1];
+  out.pnl = (int8_t)p[2];
+  out.value = rd_u32le(p + 4);
+  out.seq = rd_u32le(p + 8);
+  return true;
+}
 
-  // Extract 8 decimal digits, most-significant first.
-  uint8_t digits[8];
-  for (int i = 7; i >= 0; i--) {
-    digits[i] = val % 10;
-    val /= 10;
+// Decode and apply one hm.b frame, from a push or the boot-time state/get.
+// Caller holds abacusLock.
+static bool acceptHmFrame(const MsgPack::bin_t<uint8_t> &data) {
+  uint8_t raw[HM_FRAME_SIZE];
+  uint16_t n = (uint16_t)data.size();
+  if (n == HM_FRAME_SIZE) {
+    for (uint16_t i = 0; i < n; i++) raw[i] = data[i];
   }
+  if (!decodeHmFrame(raw, n, hmFrame)) {
+    hmRejected++;
+    perf_rpc(false);
+    return false;
+  }
+  perf_rpc(true);
+  // A lower sequence means the MPU app restarted; only a jump ahead lost frames.
+  if (hmAppliedSeq != 0 && hmFrame.seq > hmAppliedSeq + 1) hmSkipped += hmFrame.seq - hmAppliedSeq - 1;
+  hmAppliedSeq = hmFrame.seq;
+
+  AbacusData d;
+  d.value = hmFrame.value > 99999999UL ? 99999999 : (int32_t)hmFrame.value;
+  d.pnl = hmFrame.pnl;
+  d.recs = (hmFrame.flags & HM_FLAG_RECS) != 0;
+  d.broker = (hmFrame.flags & HM_FLAG_BROKER) != 0;
+  d.stale = false;
+  applyAbacus(d);
+  return true;
+}
 
-  // Abacus on columns 1-7 (column 0 reserved for indicators).
-  for (int col = 1; col < 8; col++) {
-    uint8_t d = digits[col];
+// Binary payload. bin_t is a fixed-capacity inline buffer in this build
+// (ARX_HAVE_LIBSTDCPLUSPLUS 0), so nothing is heap-allocated per update.
+// Frames are applied (and acknowledged through hm.s) whatever the mode.
+static void hmBinary(MsgPack::bin_t<uint8_t> data) {
+  bridgeBeat();
+  k_mutex_lock(&abacusLock, K_FOREVER);
+  acceptHmFrame(data);
+  k_mutex_unlock(&abacusLock);
+}
 
-    // Heaven bead (row 0) — orange, lit if digit >= 5.
-    if (d >= 5) {
-      pixels.setPixelColor(col, pixels.Color(BRIGHTNESS, BRIGHTNESS / 3, 0));
-    }
+static bool stateArrived() {
+  k_mutex_lock(&abacusLock, K_FOREVER);
+  bool arrived = hmAppliedSeq != 0;
+  k_mutex_unlock(&abacusLock);
+  return arrived;
+}
 
-    // Earth bead — amber, single pixel at position.
-    // earth 1 -> row 4, earth 2 -> row 3, earth 3 -> row 2, earth 4 -> row 1.
-    uint8_t earth = d % 5;
-    if (earth > 0) {
-      int row = 5 - earth;
-      pixels.setPixelColor(row * 8 + col, pixels.Color(BRIGHTNESS, BRIGHTNESS * 2 / 3, 0));
-    }
+// Ask the MPU app for its cached payload. An empty reply means it has none
+// yet and will push one itself. Returns true once the app has answered.
+// The lock is not held across the call, so pushes keep landing meanwhile.
+static bool pullState() {
+  MsgPack::bin_t<uint8_t> out;
+  if (!Bridge.call("state/get").result(out)) return false;
+  k_mutex_lock(&abacusLock, K_FOREVER);
+  // A push that landed while the call was out is at least as new.
+  if (out.size() > 0 && hmAppliedSeq == 0) acceptHmFrame(out);
+  k_mutex_unlock(&abacusLock);
+  return true;
+}
+
+static uint8_t statePulls = 0;
+static uint32_t nextStatePullMs = 0;
+
+// loop() thread, unlike the hm.u/hm.b handlers on the RouterBridge thread;
+// abacusLock keeps the two apart. Retries until the app answers or pushes on
+// its own.
+static void maybePullState(uint32_t now) {
+  if (statePulls >= STATE_PULL_ATTEMPTS || stateArrived()) return;
+  if ((int32_t)(now - nextStatePullMs) < 0) return;
+  nextStatePullMs = now + STATE_PULL_RETRY_MS;
+  statePulls = pullState() ? STATE_PULL_ATTEMPTS : statePulls + 1;
+}
+
+// Delivery status for fire-and-forget hm.b pushes: [applied_seq, rejected, skipped].
+static MsgPack::arr_t<uint32_t> hmStatus() {
+  bridgeBeat();
+  MsgPack::arr_t<uint32_t> out;
+  k_mutex_lock(&abacusLock, K_FOREVER);
+  out.push_back(hmAppliedSeq);
+  out.push_back(hmRejected);
+  out.push_back(hmSkipped);
+  k_mutex_unlock(&abacusLock);
+  return out;
+}
+
+// --- Orbital glue ---
+
+// Everything the orbital view shows. gen changes with the body list, so
+// brightness and fps updates do not re-apply it.
+struct OrbitalInput {
+  uint8_t state[ORBITAL_STATE_BYTES];
+  uint16_t len;  // 0 after clear
+  uint8_t brightness;
+  uint8_t fps;
+  uint32_t gen;
+};
+
+static TripleBuffer<OrbitalInput> orbitalIn;
+// Bridge thread: the input as of the last handler, published whole each time.
+static OrbitalInput orbitalStaged = {{0}, 0, 200, ORBITAL_DEFAULT_FPS, 0};
+// Render thread: orbitalIn's front slot holds data, and the gen applied to the mode.
+static bool haveOrbital = false;
+static uint32_t orbitalGen = 0;
+
+static void publishOrbital() {
+  triple_back(orbitalIn) = orbitalStaged;
+  triple_publish(orbitalIn);
+  k_sem_give(&wakeSem);
+}
+
+static void updateState(MsgPack::bin_t<uint8_t> data) {
+  bridgeBeat();
+  uint16_t n = (uint16_t)data.size();
+  perf_rpc(n > 0);
+  if (n == 0) return;
+  if (n > ORBITAL_STATE_BYTES) n = ORBITAL_STATE_BYTES;
+
+  for (uint16_t i = 0; i < n; i++) orbitalStaged.state[i] = data[i];
+  orbitalStaged.len = n;
+  orbitalStaged.gen++;
+  publishOrbital();
+}
+
+static void setBrightness(uint8_t level) {
+  bridgeBeat();
+  orbitalStaged.brightness = level;
+  publishOrbital();
+}
+
+static void setFps(uint8_t fps) {
+  bridgeBeat();
+  if (fps < ORBITAL_MIN_FPS) fps = ORBITAL_MIN_FPS;
+  if (fps > ORBITAL_MAX_FPS) fps = ORBITAL_MAX_FPS;
+  orbitalStaged.fps = fps;
+  publishOrbital();
+}
+
+static void clearDisplay() {
+  bridgeBeat();
+  orbitalStaged.len = 0;
+  orbitalStaged.gen++;
+  publishOrbital();
+}
+
+// Render thread, orbital mode active.
+static void applyOrbital() {
+  const OrbitalInput &in = triple_front(orbitalIn);
+  orbital_set_brightness(in.brightness);
+  orbital_set_fps(in.fps);
+  if (in.gen == orbitalGen) return;
+  orbitalGen = in.gen;
+  if (in.len > 0) {
+    orbital_update(in.state, in.len);
+  } else {
+    orbital_clear();
   }
+}
+
+// --- Heatmap glue ---
+
+struct HeatmapInput {
+  float before[HEATMAP_COUNT];
+  float after[HEATMAP_COUNT];
+  bool stale;
+};
+
+// Produced by the fetch thread, taken by the render thread.
+static TripleBuffer<HeatmapInput> heatmapIn;
+// Mirrors activeMode == LED_MODE_HEATMAP for the fetch thread.
+static atomic_t heatmapActive;
+
+// Given on entering heatmap mode so the first fetch does not wait a full interval.
+static struct k_sem fetchSem;
 
-  // --- Column 0 indicators ---
+K_THREAD_STACK_DEFINE(fetchStack, FETCH_STACK_SIZE);
+static struct k_thread fetchThread;
 
-  // Broker connected: c0r0, red, 200ms on / 1000ms off.
-  unsigned long now = millis();
-  bool dataFresh = (now - lastRpcMs < HEARTBEAT_TIMEOUT_MS);
-  if (heartbeatOn && dataFresh && brokerConnected > 0) {
-    pixels.setPixelColor(0, pixels.Color(BRIGHTNESS, 0, 0));
+// One poll, decoded straight into heatmapIn's back slot and published only
+// if the reply was well-formed.
+static bool fetchHeatmap() {
+  MsgPack::bin_t<uint8_t> out;
+  if (!Bridge.call("heatmap/bin").result(out)) {
+    return false;
   }
+  uint8_t raw[HEATMAP_BIN_SIZE];
+  uint16_t n = (uint16_t)out.size();
+  if (n == HEATMAP_BIN_SIZE) {
+    for (uint16_t i = 0; i < n; i++) raw[i] = out[i];
+  }
+  HeatmapInput &in = triple_back(heatmapIn);
+  bool ok = n == HEATMAP_BIN_SIZE && heatmap_decode_bin(raw, n, in.before, in.after, &in.stale);
+  perf_rpc(ok);
+  if (ok) {
+    triple_publish(heatmapIn);
+    k_sem_give(&wakeSem);
+  }
+  return ok;
+}
+
+static void fetchLoop(void *, void *, void *) {
+  for (;;) {
+    k_sem_take(&fetchSem, K_MSEC(HEATMAP_POLL_INTERVAL_MS));
+    if (!atomic_get(&heatmapActive)) continue;
+    fetchHeatmap();
+  }
+}
 
-  // P/L bar: c0r1-r3, green/red, 500ms blink.
-  if (pnlBlinkOn && displayPnl != 0) {
-    int pnl = displayPnl;
-    if (pnl > 0) {
-      pixels.setPixelColor(2 * 8, pixels.Color(0, BRIGHTNESS, 0));
-      if (pnl > 10) {
-        pixels.setPixelColor(1 * 8, pixels.Color(0, BRIGHTNESS, 0));
-      }
+// The MPU's snapshot changed: poll now rather than at the next interval.
+static void heatmapChanged() {
+  bridgeBeat();
+  k_sem_give(&fetchSem);
+}
+
+// Swap a finished fetch into the heatmap. Render thread, heatmap mode active.
+static void takeHeatmap() {
+  if (!triple_take(heatmapIn)) return;
+  const HeatmapInput &in = triple_front(heatmapIn);
+  heatmap_load(in.before, in.after, in.stale);
+}
+
+// --- Treemap glue ---
+
+struct TreemapInput {
+  uint8_t bin[TREEMAP_BIN_MAX_SIZE];
+  uint16_t len;
+};
+
+static TripleBuffer<TreemapInput> treemapIn;
+// Render thread: treemapIn's front slot holds a layout.
+static bool haveTreemap = false;
+
+static bool updateTreemap(MsgPack::bin_t<uint8_t> data) {
+  bridgeBeat();
+  TreemapInput &in = triple_back(treemapIn);
+  uint16_t n = (uint16_t)data.size();
+  if (n > TREEMAP_BIN_MAX_SIZE) n = 0;
+  for (uint16_t i = 0; i < n; i++) in.bin[i] = data[i];
+  bool ok = treemap_valid(in.bin, n);
+  perf_rpc(ok);
+  if (!ok) return false;
+
+  in.len = n;
+  triple_publish(treemapIn);
+  k_sem_give(&wakeSem);
+  return true;
+}
+
+// --- Anim glue ---
+
+struct AnimParams {
+  int16_t values[ANIM_PARAMS];
+};
+
+// Bridge thread: the image being reassembled, the parameters as last set,
+// and what anim.s reports.
+static AnimLoader animLoader;
+static AnimParams animParams;
+static uint16_t animId = 0;
+static uint8_t animSteps = 0;
+static uint16_t animFrameMs = 0;
+
+static TripleBuffer<AnimProgram> animProgramIn;
+static TripleBuffer<AnimParams> animParamsIn;
+// Render thread: the front slots hold a program / parameters.
+static bool haveAnimProgram = false;
+static bool haveAnimParams = false;
+
+static uint8_t animLoad(MsgPack::bin_t<uint8_t> data) {
+  bridgeBeat();
+  uint8_t chunk[ANIM_CHUNK_HEADER + ANIM_CHUNK_MAX];
+  uint16_t n = (uint16_t)data.size();
+  if (n > sizeof(chunk)) n = 0;
+  for (uint16_t i = 0; i < n; i++) chunk[i] = data[i];
+  AnimChunkResult res = anim_loader_feed(animLoader, chunk, n);
+  if (res == ANIM_CHUNK_COMPLETE) {
+    AnimProgram &prog = triple_back(animProgramIn);
+    if (anim_parse(animLoader.image, animLoader.total, prog)) {
+      animId = prog.id;
+      animSteps = prog.steps;
+      animFrameMs = prog.frame_ms;
+      triple_publish(animProgramIn);
+      k_sem_give(&wakeSem);
     } else {
-      pixels.setPixelColor(2 * 8, pixels.Color(BRIGHTNESS, 0, 0));
-      if (pnl < -10) {
-        pixels.setPixelColor(3 * 8, pixels.Color(BRIGHTNESS, 0, 0));
-      }
+      res = ANIM_CHUNK_REJECTED;
     }
+    animLoader.len = 0;
+    animLoader.total = 0;
   }
+  perf_rpc(res != ANIM_CHUNK_REJECTED);
+  return res;
+}
 
-  // Recommendations: c0r4, blue, 100ms on / 300ms off.
-  if (recBlinkOn && hasRecs > 0) {
-    pixels.setPixelColor(4 * 8, pixels.Color(0, 0, BRIGHTNESS));
+static bool animSet(MsgPack::bin_t<uint8_t> data) {
+  bridgeBeat();
+  uint16_t n = (uint16_t)data.size();
+  bool ok = n > 0 && n % 3 == 0;
+  for (uint16_t i = 0; ok && i < n; i += 3) ok = data[i] < ANIM_PARAMS;
+  perf_rpc(ok);
+  if (!ok) return false;
+
+  for (uint16_t i = 0; i < n; i += 3) {
+    animParams.values[data[i]] = (int16_t)(data[i + 1] | (data[i + 2] << 8));
   }
+  triple_back(animParamsIn) = animParams;
+  triple_publish(animParamsIn);
+  k_sem_give(&wakeSem);
+  return true;
+}
 
-  ws2812_show(pixels);
+// [program id, instructions, frame_ms] of the last program loaded.
+static MsgPack::arr_t<uint32_t> animStatus() {
+  bridgeBeat();
+  MsgPack::arr_t<uint32_t> out;
+  out.push_back(animId);
+  out.push_back(animSteps);
+  out.push_back(animFrameMs);
+  return out;
 }
 
-// --- RPC handler ---
-static void hmUpdate(MsgPack::arr_t<int> data) {
-  if ((int)data.size() < 1) return;
-  int val = data[0];
-  if (val < 0) val = 0;
-  if (val > 99999999) val = 99999999;
-  displayValue = val;
+// --- Text glue ---
+
+static uint8_t textFrame[MATRIX_PIXELS];
+// The matrix is showing textFrame; the active mode's matrix output is held
+// back until the queue drains.
+static bool textShowing = false;
+
+// The text queue is itself a lock-free ring with these handlers as its only
+// producer (text_scroller.h).
+static bool queueText(MsgPack::str_t text) {
+  bridgeBeat();
+  perf_rpc(true);
+  bool ok = text_queue(text.c_str(), (uint16_t)text.length());
+  k_sem_give(&wakeSem);
+  return ok;
+}
 
-  if ((int)data.size() >= 2) {
-    displayPnl = data[1];
-    if (displayPnl < -99) displayPnl = -99;
-    if (displayPnl >  99) displayPnl =  99;
+static bool setText(MsgPack::str_t text) {
+  bridgeBeat();
+  perf_rpc(true);
+  text_clear();
+  bool ok = text_queue(text.c_str(), (uint16_t)text.length());
+  k_sem_give(&wakeSem);
+  return ok;
+}
+
+// [pending, shown, dropped], see TextStatus.
+static MsgPack::arr_t<uint32_t> textStatus() {
+  bridgeBeat();
+  TextStatus st = text_status();
+  MsgPack::arr_t<uint32_t> out;
+  out.push_back(st.pending);
+  out.push_back(st.shown);
+  out.push_back(st.dropped);
+  return out;
+}
+
+// --- Diagnostics ---
+
+// perf_stats.h counters for the window since the last call; see perf_snapshot().
+static MsgPack::arr_t<uint32_t> diagStats() {
+  bridgeBeat();
+  uint32_t fields[PERF_STATS_FIELDS];
+  perf_snapshot(fields);
+  MsgPack::arr_t<uint32_t> out;
+  for (uint8_t i = 0; i < PERF_STATS_FIELDS; i++) out.push_back(fields[i]);
+  return out;
+}
+
+// --- Recovery ---
+
+static bool sysReset() {
+  bridgeBeat();
+  perf_rpc(true);
+  mcu_reset_request(millis(), SYS_RESET_DELAY_MS);
+  return true;
+}
+
+static long fedRenderPasses = 0;
+static long fedBridgeBeats = 0;
+static bool bridgeSeen = false;
+static uint32_t lastBridgeBeatMs = 0;
+
+// loop() thread. A new frame since the last pass shows the renderer is not
+// wedged. RPC handlers run on the RouterBridge thread, so loop() running says
+// nothing about it: a handler within BRIDGE_STALL_MS shows it is not. Until
+// the first RPC after boot (no MPU app yet) only the renderer is checked.
+static bool watchdogAlive(uint32_t now) {
+  long passes = atomic_get(&renderPasses);
+  long beats = atomic_get(&bridgeBeats);
+  if (beats != fedBridgeBeats) {
+    bridgeSeen = true;
+    lastBridgeBeatMs = now;
   }
+  bool bridgeAlive = !bridgeSeen || (uint32_t)(now - lastBridgeBeatMs) < BRIDGE_STALL_MS;
+  bool alive = passes != fedRenderPasses && bridgeAlive;
+  fedRenderPasses = passes;
+  fedBridgeBeats = beats;
+  return alive;
+}
+
+static void feedWatchdog(uint32_t now) {
+  mcu_watchdog_poll(now, watchdogAlive(now));
+}
+
+// --- Mode switching ---
+
+// Request a mode; the render thread switches between frames. Returns false for an unknown id.
+static bool modeSet(uint8_t id) {
+  bridgeBeat();
+  if (id >= LED_MODE_COUNT) return false;
+  atomic_set(&requestedMode, id);
+  k_sem_give(&wakeSem);
+  return true;
+}
 
-  if ((int)data.size() >= 3) {
-    hasRecs = data[2];
+static uint8_t modeGet() {
+  bridgeBeat();
+  return (uint8_t)atomic_get(&requestedMode);
+}
+
+// Render thread.
+static void enterMode(uint8_t id, uint32_t now) {
+  LedOutput prev = activeMode < LED_MODE_COUNT ? MODES[activeMode]->output : MODES[id]->output;
+  if (prev != MODES[id]->output && !(prev == LED_OUT_MATRIX && textShowing)) {
+    // Blank the surface the previous mode was drawing on.
+    memset(&canvas, 0, sizeof(canvas));
+    pushOutput(MODES[activeMode]->output);
+  }
+  memset(&canvas, 0, sizeof(canvas));
+
+  atomic_set(&heatmapActive, 0);
+  activeMode = id;
+  MODES[id]->enter(now);
+
+  switch (id) {
+    case LED_MODE_ABACUS:
+      if (haveAbacusData) abacus_apply(triple_front(abacusIn), now);
+      break;
+    case LED_MODE_ORBITAL:
+      orbitalGen = 0;
+      if (haveOrbital) applyOrbital();
+      break;
+    case LED_MODE_HEATMAP:
+      triple_take(heatmapIn);  // drop a fetch from an earlier visit
+      atomic_set(&heatmapActive, 1);
+      k_sem_give(&fetchSem);
+      break;
+    case LED_MODE_TREEMAP:
+      if (haveTreemap) treemap_load(triple_front(treemapIn).bin, triple_front(treemapIn).len);
+      break;
+    case LED_MODE_ANIM:
+      if (haveAnimProgram) anim_load(triple_front(animProgramIn));
+      if (haveAnimParams) anim_set_params(triple_front(animParamsIn).values);
+      break;
+  }
+}
+
+// Take whatever the handlers published since the last frame. Data for other
+// modes stays in the front slots for enterMode().
+static void takeInputs(uint32_t now) {
+  if (triple_take(abacusIn)) {
+    haveAbacusData = true;
+    if (activeMode == LED_MODE_ABACUS) abacus_apply(triple_front(abacusIn), now);
+  }
+  if (triple_take(orbitalIn)) {
+    haveOrbital = true;
+    if (activeMode == LED_MODE_ORBITAL) applyOrbital();
+  }
+  if (triple_take(treemapIn)) {
+    haveTreemap = true;
+    const TreemapInput &in = triple_front(treemapIn);
+    if (activeMode == LED_MODE_TREEMAP) treemap_load(in.bin, in.len);
+  }
+  if (triple_take(animProgramIn)) {
+    haveAnimProgram = true;
+    if (activeMode == LED_MODE_ANIM) anim_load(triple_front(animProgramIn));
+  }
+  if (triple_take(animParamsIn)) {
+    haveAnimParams = true;
+    if (activeMode == LED_MODE_ANIM) anim_set_params(triple_front(animParamsIn).values);
+  }
+  if (activeMode == LED_MODE_HEATMAP) takeHeatmap();
+}
+
+// One frame: take new inputs, render the active mode and the text overlay,
+// push whatever changed. Returns how long the render thread may sleep.
+static uint32_t renderFrame(uint32_t now) {
+  perf_loop();
+  ws2812_poll();
+
+  uint8_t want = (uint8_t)atomic_get(&requestedMode);
+  if (want != activeMode) enterMode(want, now);
+  takeInputs(now);
+  const LedMode *mode = MODES[activeMode];
+  canvas.dirty = false;
+  uint32_t start = perf_cycles();
+  uint32_t wait = mode->render(now, canvas);
+  perf_record(PERF_RENDER, start);
+
+  bool textWasShowing = textShowing;
+  uint32_t textWait = UINT32_MAX;
+  if (textShowing || text_active()) {
+    textWait = text_render(now, textFrame);
+    textShowing = text_active();
   }
 
-  if ((int)data.size() >= 4) {
-    brokerConnected = data[3] > 0 ? 1 : 0;
+  bool matrixMode = mode->output == LED_OUT_MATRIX;
+  if (canvas.dirty && !(matrixMode && textShowing)) pushOutput(mode->output);
+  if (textShowing || (textWasShowing && !matrixMode)) {
+    // The last column has scrolled off once the queue drains, so this also
+    // blanks the matrix for a shield mode.
+    pushFrame(LED_OUT_MATRIX, textFrame);
+  } else if (textWasShowing && !canvas.dirty) {
+    pushOutput(LED_OUT_MATRIX);
   }
+  if (textWait < wait) wait = textWait;
 
-  lastRpcMs = millis();
-  needsRedraw = true;
+  // A frame still on the wire only needs a short nap before ws2812_poll()
+  // can retire it.
+  if (ws2812_poll() && wait > 1) wait = 1;
+  return wait < RENDER_MAX_WAIT_MS ? wait : RENDER_MAX_WAIT_MS;
+}
+
+static void renderLoop(void *, void *, void *) {
+  for (;;) {
+    uint32_t wait = renderFrame(millis());
+    atomic_inc(&renderPasses);
+    k_sem_take(&wakeSem, K_MSEC(wait));
+  }
 }
 
 void setup() {
+  perf_begin();
   pixels.begin();
+  ws2812_begin(LED_BACKEND, NUMPIXELS);
   pixels.clear();
-  ws2812_show(pixels);
+  ws2812_show(pixels.getPixels(), pixels.numPixels() * 3);
+
+  matrix.begin();
+  matrix.setGrayscaleBits(8);
+  matrix.clear();
+
+  k_sem_init(&wakeSem, 0, 1);
+  k_sem_init(&fetchSem, 0, 1);
+  k_mutex_init(&abacusLock);
+
+  state_store_begin();
+  restoreAbacus();
 
   Bridge.begin();
   Bridge.provide("hm.u", hmUpdate);
+  Bridge.provide("hm.b", hmBinary);
+  Bridge.provide("hm.s", hmStatus);
+  Bridge.provide("updateState", updateState);
+  Bridge.provide("setBrightness", setBrightness);
+  Bridge.provide("setFps", setFps);
+  Bridge.provide("clear", clearDisplay);
+  Bridge.provide("mode.set", modeSet);
+  Bridge.provide("mode.get", modeGet);
+  Bridge.provide("updateTreemap", updateTreemap);
+  Bridge.provide("anim.load", animLoad);
+  Bridge.provide("anim.set", animSet);
+  Bridge.provide("anim.s", animStatus);
+  Bridge.provide("setText", setText);
+  Bridge.provide("queueText", queueText);
+  Bridge.provide("text.s", textStatus);
+  Bridge.provide("diag/stats", diagStats);
+  Bridge.provide("sys.reset", sysReset);
+  Bridge.provide("heatmap/changed", heatmapChanged);
+
+  k_thread_create(&fetchThread, fetchStack, K_THREAD_STACK_SIZEOF(fetchStack),
+                  fetchLoop, NULL, NULL, NULL,
+                  K_LOWEST_APPLICATION_THREAD_PRIO, 0, K_NO_WAIT);
+  k_thread_name_set(&fetchThread, "heatmap_fetch");
+
+  k_thread_create(&renderThread, renderStack, K_THREAD_STACK_SIZEOF(renderStack),
+                  renderLoop, NULL, NULL, NULL,
+                  RENDER_PRIORITY, 0, K_NO_WAIT);
+  k_thread_name_set(&renderThread, "led_render");
+
+  mcu_watchdog_begin(WATCHDOG_TIMEOUT_MS);
 }
 
 void loop() {
+  uint32_t start = perf_cycles();
   Bridge.update();
-
-  unsigned long now = millis();
-
-  // Compute blink states from time (avoids per-feature timers).
-  bool newPnlBlink = (now % 1600) < 800;
-  bool newHeartbeat = (now % 1200) < 200;
-  bool newRecBlink  = (now % 400) < 100;
-  bool newDataFresh = (now - lastRpcMs < HEARTBEAT_TIMEOUT_MS);
-  static bool dataFresh = false;
-
-  // Redraw only when a visible blink state changes.
-  bool changed = false;
-  if (newPnlBlink != pnlBlinkOn && displayPnl != 0) changed = true;
-  if (newHeartbeat != heartbeatOn && newDataFresh && brokerConnected > 0) changed = true;
-  if (newDataFresh != dataFresh) changed = true;
-  if (newRecBlink != recBlinkOn && hasRecs > 0) changed = true;
-
-  pnlBlinkOn = newPnlBlink;
-  heartbeatOn = newHeartbeat;
-  recBlinkOn = newRecBlink;
-  dataFresh = newDataFresh;
-
-  if (changed) needsRedraw = true;
-
-  if (needsRedraw) {
-    needsRedraw = false;
-    renderDisplay();
-  }
+  perf_record(PERF_BRIDGE, start);
+  maybePullState(millis());
+  k_mutex_lock(&abacusLock, K_FOREVER);
+  state_store_poll(millis());
+  k_mutex_unlock(&abacusLock);
+  feedWatchdog(millis());
+  k_msleep(BRIDGE_POLL_MS);
 }
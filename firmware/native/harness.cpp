@@ -0,0 +1,595 @@
+// Host-native build of the Sentinel LED firmware (arduino-app/sentinel/sketch)
+// for golden-frame tests and render/decode benchmarks.
+//
+// The sketch is compiled into this translation unit against the stubs in
+// stubs/, so its static RPC handlers and renderFrame() can be driven directly;
+// the stub k_thread_create() never starts the render or fetch threads. Time is
+// virtual: each step sets millis() and renders one frame. Frames pushed through
+// ws2812_show() and ArduinoLEDMatrix::draw() are captured here.
+//
+//   sentinel_native golden          print the reference scenario's frames
+//   sentinel_native bench [iters]   ns per frame / per decode for each mode
+
+#include "../../arduino-app/sentinel/sketch/sketch.ino"
+
+#include <chrono>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+// --- Stub backing state ---
+
+NativeSerial Serial;
+BridgeClass Bridge;
+
+static uint32_t nowMs = 0;
+
+uint32_t millis() {
+  return nowMs;
+}
+
+uint32_t micros() {
+  return nowMs * 1000;
+}
+
+void delay(uint32_t ms) {
+  nowMs += ms;
+}
+
+void native_set_millis(uint32_t ms) {
+  nowMs = ms;
+}
+
+uint32_t perf_cycles() {
+  using namespace std::chrono;
+  uint64_t ns = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+  return (uint32_t)(ns * (PERF_CPU_HZ / 1000000UL) / 1000);
+}
+
+static std::map<std::string, std::vector<uint8_t>> bridgeReplies;
+
+void native_bridge_reply(const char *method, const uint8_t *data, uint16_t n) {
+  bridgeReplies[method] = std::vector<uint8_t>(data, data + n);
+}
+
+bool native_bridge_take(const char *method, std::vector<uint8_t> &out) {
+  auto it = bridgeReplies.find(method);
+  if (it == bridgeReplies.end()) return false;
+  out = it->second;
+  bridgeReplies.erase(it);
+  return true;
+}
+
+static uint32_t mcuResets = 0;
+
+void native_mcu_reset() {
+  mcuResets++;
+}
+
+static uint8_t shieldFrame[WS2812_MAX_PIXELS * 3];
+static uint16_t shieldBytes = 0;
+static uint32_t shieldPushes = 0;
+static uint8_t matrixFrame[MATRIX_PIXELS];
+static uint32_t matrixPushes = 0;
+
+bool ws2812_begin(Ws2812Backend, uint16_t num_pixels) {
+  return num_pixels <= WS2812_MAX_PIXELS;
+}
+
+void ws2812_show(const uint8_t *pixels, uint16_t n) {
+  if (n > sizeof(shieldFrame)) n = sizeof(shieldFrame);
+  memcpy(shieldFrame, pixels, n);
+  shieldBytes = n;
+  shieldPushes++;
+}
+
+bool ws2812_poll() {
+  return false;
+}
+
+void native_shield_show(const uint8_t *pixels, uint16_t n) {
+  ws2812_show(pixels, n);
+}
+
+void native_matrix_draw(const uint8_t *frame) {
+  memcpy(matrixFrame, frame, sizeof(matrixFrame));
+  matrixPushes++;
+}
+
+// --- Payload builders ---
+
+static MsgPack::bin_t<uint8_t> toBin(const uint8_t *p, uint16_t n) {
+  return MsgPack::bin_t<uint8_t>(p, p + n);
+}
+
+static void wrU32le(uint8_t *p, uint32_t v) {
+  for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void buildHmFrame(uint8_t *out, uint32_t value, int8_t pnl, uint8_t flags, uint32_t seq) {
+  memset(out, 0, HM_FRAME_SIZE);
+  out[0] = HM_FRAME_VERSION;
+  out[1] = flags;
+  out[2] = (uint8_t)pnl;
+  wrU32le(out + 4, value);
+  wrU32le(out + 8, seq);
+  uint16_t crc = crc16_ccitt(out, HM_FRAME_SIZE - 2);
+  out[12] = (uint8_t)crc;
+  out[13] = (uint8_t)(crc >> 8);
+}
+
+// count bodies: ids 0..3 in the sun, the rest split over the two rings, all
+// five patterns in turn.
+static uint16_t buildOrbitalState(uint8_t *out, uint8_t count) {
+  out[0] = count;
+  for (uint8_t i = 0; i < count; i++) {
+    uint8_t *rec = &out[1 + i * 3];
+    rec[0] = i;
+    rec[1] = i % 5;
+    rec[2] = i < 4 ? 0 : (i % 2) + 1;
+  }
+  return 1 + count * 3;
+}
+
+static void buildHeatmapBin(uint8_t *out, uint8_t flags) {
+  out[0] = HEATMAP_BIN_MAGIC;
+  out[1] = HEATMAP_BIN_VERSION;
+  out[2] = HEATMAP_COUNT;
+  out[3] = flags;
+  for (int i = 0; i < HEATMAP_COUNT; i++) {
+    int before = i * 6 - 117;
+    int after = (i % 7 == 0) ? -before : before;
+    out[HEATMAP_BIN_HEADER + i] = (uint8_t)(int8_t)before;
+    out[HEATMAP_BIN_HEADER + HEATMAP_COUNT + i] = (uint8_t)(int8_t)after;
+  }
+}
+
+// A fixed 4-region layout tiling the matrix, one of each action.
+static uint16_t buildTreemapBin(uint8_t *out) {
+  static const uint8_t regions[4][4] = {
+    {0x05, 0x07, 0x00, 0xE0},  // 6x8 at (0,0): sine, low urgency, band 7
+    {0x66, 0x03, 0x12, 0x88},  // 7x4 at (6,0): saw up, elevated, band 4
+    {0x63, 0x43, 0x23, 0x50},  // 4x4 at (6,4): saw down, high, band 2
+    {0xA2, 0x43, 0x44, 0x1F},  // 3x4 at (10,4): pulse, urgent, band 0
+  };
+  out[0] = TREEMAP_BIN_MAGIC;
+  out[1] = TREEMAP_BIN_VERSION;
+  out[2] = 4;
+  memcpy(out + TREEMAP_BIN_HEADER, regions, sizeof(regions));
+  return TREEMAP_BIN_HEADER + sizeof(regions);
+}
+
+// A colour wash: red follows a sine that travels along the rows with period
+// P0 ms, green is P1, blue grows down the columns, and column 7 stays dark.
+static const uint8_t ANIM_WASH[] = {
+  ANIM_OP_LD, ANIM_REG_X, ANIM_OP_PUSH8, 7, ANIM_OP_EQ, ANIM_OP_JZ, 1, ANIM_OP_END,
+  ANIM_OP_LD, ANIM_REG_P0, ANIM_OP_PHASE,
+  ANIM_OP_LD, ANIM_REG_X, ANIM_OP_PUSH16, 0x00, 0x20, ANIM_OP_MUL, ANIM_OP_ADD,
+  ANIM_OP_SIN, ANIM_OP_PUSH8, 8, ANIM_OP_SHR, ANIM_OP_PUSH16, 0x80, 0x00, ANIM_OP_ADD,
+  ANIM_OP_LD, ANIM_REG_P0 + 1,
+  ANIM_OP_LD, ANIM_REG_Y, ANIM_OP_PUSH8, 50, ANIM_OP_MUL,
+  ANIM_OP_OUT,
+};
+
+static uint16_t buildAnimImage(uint8_t *out, const uint8_t *code, uint16_t len, uint16_t frame_ms) {
+  out[0] = ANIM_MAGIC;
+  out[1] = ANIM_VERSION;
+  out[2] = (uint8_t)frame_ms;
+  out[3] = (uint8_t)(frame_ms >> 8);
+  out[4] = (uint8_t)len;
+  out[5] = (uint8_t)(len >> 8);
+  memcpy(out + ANIM_HEADER, code, len);
+  uint16_t n = ANIM_HEADER + len;
+  uint16_t crc = crc16_ccitt(out, n);
+  out[n] = (uint8_t)crc;
+  out[n + 1] = (uint8_t)(crc >> 8);
+  return n + 2;
+}
+
+// anim.load chunk for image[offset .. offset + len).
+static uint8_t sendAnimChunk(const uint8_t *image, uint16_t total, uint16_t offset, uint16_t len) {
+  uint8_t chunk[ANIM_CHUNK_HEADER + ANIM_CHUNK_MAX];
+  chunk[0] = (uint8_t)offset;
+  chunk[1] = (uint8_t)(offset >> 8);
+  chunk[2] = (uint8_t)total;
+  chunk[3] = (uint8_t)(total >> 8);
+  memcpy(chunk + ANIM_CHUNK_HEADER, image + offset, len);
+  return animLoad(toBin(chunk, ANIM_CHUNK_HEADER + len));
+}
+
+// --- Golden scenario ---
+
+static void printHex(FILE *out, const uint8_t *p, uint16_t n) {
+  for (uint16_t i = 0; i < n; i++) fprintf(out, "%02x", p[i]);
+  fputc('\n', out);
+}
+
+// Render one frame at t and print whatever it pushed.
+static void step(FILE *out, uint32_t t) {
+  uint32_t shieldBefore = shieldPushes;
+  uint32_t matrixBefore = matrixPushes;
+  native_set_millis(t);
+  loop();
+  renderFrame(t);
+  if (shieldPushes != shieldBefore) {
+    fprintf(out, "t=%u mode=%u shield ", t, activeMode);
+    printHex(out, shieldFrame, shieldBytes);
+  }
+  if (matrixPushes != matrixBefore) {
+    fprintf(out, "t=%u mode=%u matrix ", t, activeMode);
+    printHex(out, matrixFrame, sizeof(matrixFrame));
+  }
+}
+
+// Stand-in for one pass of fetchLoop(), which never runs on the host.
+static void fetchOnce(const uint8_t *payload, uint16_t n) {
+  native_bridge_reply("heatmap/bin", payload, n);
+  fetchHeatmap();
+}
+
+static void runGolden(FILE *out) {
+  uint8_t hm[HM_FRAME_SIZE];
+  uint8_t orbital[ORBITAL_STATE_BYTES];
+  uint8_t heatmap[HEATMAP_BIN_SIZE];
+
+  native_set_millis(0);
+  setup();
+  step(out, 0);
+
+  // Abacus: value, P/L bar, heartbeat and recommendations, then blink edges.
+  buildHmFrame(hm, 12345678, 12, HM_FLAG_RECS | HM_FLAG_BROKER, 1);
+  hmBinary(toBin(hm, sizeof(hm)));
+  step(out, 50);
+  step(out, 150);
+  step(out, 250);
+  step(out, 850);
+  buildHmFrame(hm, 905, -15, 0, 2);
+  hm[5] ^= 0x01;  // corrupt: must be rejected
+  hmBinary(toBin(hm, sizeof(hm)));
+  buildHmFrame(hm, 905, -15, 0, 4);
+  hmBinary(toBin(hm, sizeof(hm)));
+  step(out, 1700);
+  MsgPack::arr_t<uint32_t> status = hmStatus();
+  fprintf(out, "hm.s applied=%u rejected=%u skipped=%u\n", status[0], status[1], status[2]);
+
+  // Orbital: bodies fly in, orbit, and one update drops half of them.
+  modeSet(LED_MODE_ORBITAL);
+  updateState(toBin(orbital, buildOrbitalState(orbital, 12)));
+  step(out, 2000);
+  step(out, 2016);
+  step(out, 2500);
+  step(out, 4000);
+  updateState(toBin(orbital, buildOrbitalState(orbital, 6)));
+  setBrightness(120);
+  step(out, 4100);
+
+  // Heatmap: default dataset, then a fetched one, then stale data.
+  modeSet(LED_MODE_HEATMAP);
+  step(out, 5000);
+  buildHeatmapBin(heatmap, 0);
+  fetchOnce(heatmap, sizeof(heatmap));
+  step(out, 5012);
+  step(out, 5500);
+  step(out, 6000);
+  buildHeatmapBin(heatmap, HEATMAP_BIN_FLAG_STALE);
+  fetchOnce(heatmap, sizeof(heatmap));
+  step(out, 6012);
+
+  // Back to the abacus: the cached payload is shown again.
+  modeSet(LED_MODE_ABACUS);
+  step(out, 7000);
+  fprintf(out, "mode.get=%u\n", modeGet());
+
+  // Text over the abacus: two queued messages scroll in turn, then the matrix
+  // is blanked. A full queue rejects the overflow.
+  setText("BUY");
+  queueText("7%");
+  step(out, 8000);
+  step(out, 8090);
+  step(out, 8300);
+  step(out, 8930);
+  step(out, 9000);
+  step(out, 9600);
+  for (int i = 0; i < TEXT_QUEUE_LEN; i++) queueText("x");
+  MsgPack::arr_t<uint32_t> text = textStatus();
+  fprintf(out, "text.s pending=%u shown=%u dropped=%u\n", text[0], text[1], text[2]);
+  // setText replaces a full queue before the renderer has seen the clear.
+  fprintf(out, "setText on full queue=%u\n", setText("OK"));
+  text = textStatus();
+  fprintf(out, "text.s pending=%u shown=%u dropped=%u\n", text[0], text[1], text[2]);
+  setText("");
+  step(out, 9700);
+  step(out, 10200);
+
+  // Oscillator bank: every waveform at every urgency period, sampled at
+  // eighths of the cycle. Saws ramp over 80%, pulses bump over 30%.
+  static const uint32_t duty[OSC_WAVE_COUNT] = {
+    OSC_DUTY_HALF, 52429, 52429, OSC_DUTY_HALF, 19661, OSC_DUTY_HALF,
+  };
+  for (uint8_t u = 0; u < OSC_URGENCY_COUNT; u++) {
+    OscBank bank = {};
+    for (uint8_t w = 0; w < OSC_WAVE_COUNT; w++) {
+      osc_bank_add(bank, (OscWave)w, OSC_URGENCY_PERIOD_MS[u], duty[w]);
+    }
+    for (uint8_t w = 0; w < OSC_WAVE_COUNT; w++) {
+      fprintf(out, "osc period=%u wave=%u", OSC_URGENCY_PERIOD_MS[u], w);
+      Osc o = bank.osc[w];
+      for (int k = 0; k < 8; k++) {
+        osc_sync(o, OSC_URGENCY_PERIOD_MS[u] * k / 8);
+        fprintf(out, " %u", osc_value(o));
+      }
+      fprintf(out, " edge=%u\n", osc_ms_to_edge(bank.osc[w]));
+    }
+  }
+
+  // Treemap: an out-of-bounds region is rejected, then the layout animates.
+  uint8_t treemap[TREEMAP_BIN_MAX_SIZE];
+  uint16_t treemapLen = buildTreemapBin(treemap);
+  treemap[TREEMAP_BIN_HEADER + 12] = 0xB2;  // x 11 + w 3 > 13
+  fprintf(out, "updateTreemap bad=%u\n", updateTreemap(toBin(treemap, treemapLen)));
+  treemapLen = buildTreemapBin(treemap);
+  fprintf(out, "updateTreemap ok=%u\n", updateTreemap(toBin(treemap, treemapLen)));
+  modeSet(LED_MODE_TREEMAP);
+  step(out, 11000);
+  step(out, 11016);
+  step(out, 11500);
+  step(out, 12300);
+  fprintf(out, "mode.get=%u\n", modeGet());
+
+  // Compositor: with a frame every 10 ms, an idle abacus only sends a
+  // frame on an indicator blink edge, and a cleared orbital view sends one
+  // blank frame and then nothing.
+  diagStats();
+  modeSet(LED_MODE_ABACUS);
+  uint32_t shieldBefore = shieldPushes;
+  for (uint32_t t = 13000; t < 15000; t += 10) step(out, t);
+  fprintf(out, "abacus 2s shield pushes=%u\n", shieldPushes - shieldBefore);
+  modeSet(LED_MODE_ORBITAL);
+  uint32_t matrixBefore = matrixPushes;
+  for (uint32_t t = 15000; t < 16000; t += 10) {
+    native_set_millis(t);
+    renderFrame(t);
+  }
+  fprintf(out, "orbital 1s matrix pushes=%u\n", matrixPushes - matrixBefore);
+  clearDisplay();
+  matrixBefore = matrixPushes;
+  for (uint32_t t = 16000; t < 17000; t += 10) step(out, t);
+  fprintf(out, "orbital cleared 1s matrix pushes=%u\n", matrixPushes - matrixBefore);
+  MsgPack::arr_t<uint32_t> diag = diagStats();
+  fprintf(out, "diag frames shown=%u elided=%u\n", diag[17], diag[18]);
+
+  // Reboot: the stored abacus payload is shown from the first frame, stale
+  // (no heartbeat), until loop()'s state/get pull brings the live one.
+  hmAppliedSeq = 0;
+  statePulls = 0;
+  nextStatePullMs = 0;
+  activeMode = LED_MODE_COUNT;
+  haveAbacusData = false;
+  frame_gate_reset(shieldGate);
+  modeSet(LED_MODE_ABACUS);
+  state_store_begin();
+  restoreAbacus();
+  native_set_millis(17000);
+  renderFrame(17000);
+  fprintf(out, "t=17000 boot shield ");
+  printHex(out, shieldFrame, shieldBytes);
+  fprintf(out, "restored value=%d pnl=%d stale=%u\n", abacusData.value, abacusData.pnl, abacusData.stale);
+  buildHmFrame(hm, 4321, 3, HM_FLAG_BROKER, 9);
+  native_bridge_reply("state/get", hm, sizeof(hm));
+  step(out, 17100);
+  status = hmStatus();
+  fprintf(out, "state/get applied=%u stale=%u\n", status[0], abacusData.stale);
+  uint8_t record[8] = {};
+  fprintf(out, "state_store wrong size=%u\n", state_store_load(STATE_KEY_ABACUS, record, sizeof(record)));
+
+  // sys.reset replies at once and resets once its delay has passed.
+  fprintf(out, "sys.reset=%u\n", sysReset());
+  step(out, 17200);
+  fprintf(out, "resets after 100 ms=%u\n", mcuResets);
+  step(out, 17300);
+  fprintf(out, "resets after 200 ms=%u\n", mcuResets);
+
+  // Anim: a chunk out of order and an image with a jump into an operand are
+  // rejected; the wash then loads in two chunks and only its parameters change.
+  uint8_t image[ANIM_IMAGE_MAX];
+  uint16_t imageLen = buildAnimImage(image, ANIM_WASH, sizeof(ANIM_WASH), 50);
+  MsgPack::arr_t<uint32_t> anim = animStatus();
+  fprintf(out, "anim.s id=%u\n", anim[0]);
+  fprintf(out, "anim.load out of order=%u\n", sendAnimChunk(image, imageLen, 20, 10));
+  uint8_t badCode[sizeof(ANIM_WASH)];
+  memcpy(badCode, ANIM_WASH, sizeof(badCode));
+  badCode[6] = 2;  // JZ into PUSH8's operand
+  uint8_t bad[ANIM_IMAGE_MAX];
+  uint16_t badLen = buildAnimImage(bad, badCode, sizeof(badCode), 50);
+  fprintf(out, "anim.load bad jump=%u\n", sendAnimChunk(bad, badLen, 0, badLen));
+  badLen = buildAnimImage(bad, ANIM_WASH, sizeof(ANIM_WASH), ANIM_MAX_FRAME_MS + 1);
+  fprintf(out, "anim.load slow frame=%u\n", sendAnimChunk(bad, badLen, 0, badLen));
+  fprintf(out, "anim.load chunk 1=%u\n", sendAnimChunk(image, imageLen, 0, 24));
+  fprintf(out, "anim.load chunk 2=%u\n", sendAnimChunk(image, imageLen, 24, imageLen - 24));
+  anim = animStatus();
+  fprintf(out, "anim.s id=%04x steps=%u frame_ms=%u\n", anim[0], anim[1], anim[2]);
+  const uint8_t params[] = {0, 0xE8, 0x03, 1, 40, 0};  // P0 1000 ms, P1 40
+  fprintf(out, "anim.set=%u bad index=%u\n", animSet(toBin(params, sizeof(params))),
+          animSet(toBin((const uint8_t *)"\x08\x00\x00", 3)));
+  modeSet(LED_MODE_ANIM);
+  step(out, 18000);
+  step(out, 18050);
+  step(out, 18250);
+  const uint8_t greener[] = {1, 200, 0};
+  animSet(toBin(greener, sizeof(greener)));
+  step(out, 18260);
+  fprintf(out, "mode.get=%u\n", modeGet());
+
+  // Watchdog: fed while frames and RPCs both keep coming. A bridge thread
+  // that has not run a handler for BRIDGE_STALL_MS stops the feed.
+  const uint32_t t = 20000;
+  atomic_inc(&renderPasses);
+  modeGet();
+  bool fresh = watchdogAlive(t);
+  atomic_inc(&renderPasses);
+  bool quiet = watchdogAlive(t + BRIDGE_STALL_MS - 1);
+  atomic_inc(&renderPasses);
+  bool stalled = watchdogAlive(t + BRIDGE_STALL_MS);
+  modeGet();
+  bool noFrame = watchdogAlive(t + BRIDGE_STALL_MS + 1);
+  fprintf(out, "watchdog fed=%u quiet=%u bridge stalled=%u no frame=%u\n", fresh, quiet, stalled, noFrame);
+
+  // Orbital at 1 fps simulates the same 2 s as at 50 fps.
+  static LedCanvas fast, slow;
+  uint16_t orbitalLen = buildOrbitalState(orbital, 12);
+  MODE_ORBITAL.enter(0);
+  orbital_set_fps(50);
+  orbital_update(orbital, orbitalLen);
+  for (uint32_t ms = 0; ms <= 2000; ms += 20) MODE_ORBITAL.render(ms, fast);
+  MODE_ORBITAL.enter(0);
+  orbital_set_fps(1);
+  orbital_update(orbital, orbitalLen);
+  for (uint32_t ms = 0; ms <= 2000; ms += 1000) MODE_ORBITAL.render(ms, slow);
+  fprintf(out, "orbital 1 fps matches 50 fps=%u\n", memcmp(fast.matrix, slow.matrix, MATRIX_PIXELS) == 0);
+}
+
+// --- Benchmarks ---
+
+template <typename F>
+static void bench(const char *name, uint32_t iters, F body) {
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < iters; i++) body(i);
+  auto end = std::chrono::steady_clock::now();
+  double ns = std::chrono::duration<double, std::nano>(end - start).count() / iters;
+  printf("%-32s %10.1f ns/op\n", name, ns);
+}
+
+static void runBench(uint32_t iters) {
+  static LedCanvas c;
+  uint8_t hm[HM_FRAME_SIZE];
+  uint8_t orbital[ORBITAL_STATE_BYTES];
+  uint8_t heatmap[HEATMAP_BIN_SIZE];
+  uint16_t orbitalLen = buildOrbitalState(orbital, ORBITAL_MAX_BODIES);
+  buildHeatmapBin(heatmap, 0);
+  buildHmFrame(hm, 12345678, 12, HM_FLAG_RECS | HM_FLAG_BROKER, 1);
+
+  // Keep results observable so the loops are not optimized away.
+  volatile uint32_t sink = 0;
+
+  MODE_ABACUS.enter(0);
+  bench("abacus apply+render", iters, [&](uint32_t i) {
+    AbacusData d = {(int32_t)(i % 100000000), (int)(i % 41) - 20, (i & 1) != 0, true, false};
+    abacus_apply(d, i);
+    sink += MODE_ABACUS.render(i, c);
+  });
+
+  MODE_ORBITAL.enter(0);
+  orbital_update(orbital, orbitalLen);
+  bench("orbital render (40 bodies)", iters, [&](uint32_t i) {
+    sink += MODE_ORBITAL.render(i * 16, c);
+  });
+
+  MODE_HEATMAP.enter(0);
+  bench("heatmap render", iters, [&](uint32_t i) {
+    sink += MODE_HEATMAP.render(i * 12, c);
+  });
+
+  HmFrame frame;
+  bench("decode hm.b", iters, [&](uint32_t) {
+    sink += decodeHmFrame(hm, sizeof(hm), frame);
+  });
+
+  MODE_ORBITAL.enter(0);
+  bench("decode updateState (40 bodies)", iters, [&](uint32_t i) {
+    orbital[1] = (uint8_t)i;  // vary one id so bodies come and go
+    orbital_update(orbital, orbitalLen);
+  });
+
+  WarpField warp = {512, 896, 19000, 26700, 0, 0};
+  int32_t warpU[SHIELD_PIXELS];
+  uint8_t warpBands[SHIELD_PIXELS];
+  bench("warp field (5x8)", iters, [&](uint32_t i) {
+    warp.phase1 = (uint16_t)(i * 97);
+    warp_field_eval(warp, 5, 8, HEATMAP_COUNT, warpU, warpBands);
+    sink += warpBands[i % SHIELD_PIXELS];
+  });
+
+  float before[HEATMAP_COUNT];
+  float after[HEATMAP_COUNT];
+  bool stale;
+  bench("decode heatmap/bin", iters, [&](uint32_t) {
+    sink += heatmap_decode_bin(heatmap, sizeof(heatmap), before, after, &stale);
+  });
+
+  MODE_HEATMAP.enter(0);
+  bench("heatmap_load", iters, [&](uint32_t) {
+    heatmap_load(before, after, stale);
+  });
+
+  uint8_t treemap[TREEMAP_BIN_MAX_SIZE];
+  uint16_t treemapLen = buildTreemapBin(treemap);
+  MODE_TREEMAP.enter(0);
+  treemap_load(treemap, treemapLen);
+  bench("treemap render (4 regions)", iters, [&](uint32_t i) {
+    sink += MODE_TREEMAP.render(i * 16, c);
+  });
+
+  uint8_t image[ANIM_IMAGE_MAX];
+  AnimProgram prog;
+  anim_parse(image, buildAnimImage(image, ANIM_WASH, sizeof(ANIM_WASH), 16), prog);
+  const int16_t params[ANIM_PARAMS] = {1000, 40};
+  MODE_ANIM.enter(0);
+  anim_load(prog);
+  anim_set_params(params);
+  bench("anim vm render (40 px)", iters, [&](uint32_t i) {
+    sink += MODE_ANIM.render(i * 16, c);
+  });
+
+  bench("anim_parse (34 B)", iters, [&](uint32_t) {
+    sink += anim_parse(image, ANIM_HEADER + sizeof(ANIM_WASH) + 2, prog);
+  });
+
+  static LedFrameGate gate;
+  static uint8_t shield[SHIELD_PIXELS * 3];
+  bench("frame gate (120 B, repeat)", iters, [&](uint32_t) {
+    sink += frame_gate_pass(gate, shield, sizeof(shield));
+  });
+  bench("frame gate (120 B, changed)", iters, [&](uint32_t i) {
+    shield[i % sizeof(shield)]++;
+    sink += frame_gate_pass(gate, shield, sizeof(shield));
+  });
+
+  static TripleBuffer<AbacusData> handoff;
+  bench("triple buffer publish+take", iters, [&](uint32_t i) {
+    triple_back(handoff).value = (int32_t)i;
+    triple_publish(handoff);
+    if (triple_take(handoff)) sink += triple_front(handoff).value;
+  });
+
+  OscBank bank = {};
+  for (uint8_t w = 0; w < OSC_WAVE_COUNT; w++) osc_bank_add(bank, (OscWave)w, 1500);
+  bench("osc bank tick (6 waves)", iters, [&](uint32_t) {
+    osc_bank_tick(bank, 16);
+    sink += bank.value[0];
+  });
+
+  static uint8_t text[MATRIX_PIXELS];
+  text_clear();
+  bench("text render (32 chars)", iters, [&](uint32_t i) {
+    if (!text_active()) text_queue("SELL EUR 1,874.62 (51%) BYD.285", 32);
+    sink += text_render(i * TEXT_COLUMN_MS, text);
+  });
+
+  (void)sink;
+}
+
+int main(int argc, char **argv) {
+  if (argc >= 2 && strcmp(argv[1], "golden") == 0) {
+    runGolden(stdout);
+    return 0;
+  }
+  if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+    uint32_t iters = argc >= 3 ? (uint32_t)strtoul(argv[2], NULL, 10) : 100000;
+    if (iters == 0) iters = 1;
+    runBench(iters);
+    return 0;
+  }
+  fprintf(stderr, "usage: %s golden | bench [iterations]\n", argv[0]);
+  return 2;
+}
@@ -0,0 +1,48 @@
+// Host stand-in for Adafruit_NeoPixel: a plain GRB byte buffer with the
+// library's brightness scaling. show() hands the bytes to native_shield_show().
+
+#pragma once
+
+#include <Arduino.h>
+
+#define NEO_GRB 0x52
+#define NEO_KHZ800 0x0000
+
+void native_shield_show(const uint8_t *pixels, uint16_t n);
+
+class Adafruit_NeoPixel {
+ public:
+  Adafruit_NeoPixel(uint16_t n, int16_t, uint16_t) : num(n), brightness(0) {
+    memset(buf, 0, sizeof(buf));
+  }
+
+  void begin() {}
+  void show() { native_shield_show(buf, num * 3); }
+  void clear() { memset(buf, 0, sizeof(buf)); }
+  void setBrightness(uint8_t b) { brightness = b + 1; }
+
+  void setPixelColor(uint16_t i, uint32_t c) {
+    if (i >= num) return;
+    uint8_t r = c >> 16, g = c >> 8, b = c;
+    if (brightness) {
+      r = (r * brightness) >> 8;
+      g = (g * brightness) >> 8;
+      b = (b * brightness) >> 8;
+    }
+    buf[i * 3] = g;
+    buf[i * 3 + 1] = r;
+    buf[i * 3 + 2] = b;
+  }
+
+  static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) {
+    return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+  }
+
+  uint8_t *getPixels() { return buf; }
+  uint16_t numPixels() const { return num; }
+
+ private:
+  uint16_t num;
+  uint8_t brightness;
+  uint8_t buf[64 * 3];
+};
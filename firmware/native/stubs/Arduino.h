@@ -0,0 +1,27 @@
+// Host stand-in for the Arduino core: just enough for the SentinelLED modules
+// and the sketches' render and decode paths. Time is virtual and moves only
+// when the harness calls native_set_millis().
+
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+
+// Harness clock control.
+void native_set_millis(uint32_t ms);
+
+struct NativeSerial {
+  void begin(unsigned long) {}
+};
+
+extern NativeSerial Serial;
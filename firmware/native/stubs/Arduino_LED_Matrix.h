@@ -0,0 +1,16 @@
+// Host stand-in for the UNO Q matrix driver. draw() hands the 8x13 grayscale
+// frame to native_matrix_draw().
+
+#pragma once
+
+#include <Arduino.h>
+
+void native_matrix_draw(const uint8_t *frame);
+
+class ArduinoLEDMatrix {
+ public:
+  void begin() {}
+  void setGrayscaleBits(uint8_t) {}
+  void clear() {}
+  void draw(uint8_t *frame) { native_matrix_draw(frame); }
+};
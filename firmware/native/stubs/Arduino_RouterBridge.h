@@ -0,0 +1,68 @@
+// Host stand-in for Arduino_RouterBridge. Handlers are registered but never
+// dispatched: the harness calls them directly. Bridge.call() answers from
+// replies queued with native_bridge_reply(); anything else fails.
+
+#pragma once
+
+#include <Arduino.h>
+
+#include <string>
+#include <vector>
+
+namespace MsgPack {
+template <typename T>
+using arr_t = std::vector<T>;
+template <typename T = uint8_t>
+using bin_t = std::vector<T>;
+using str_t = std::string;
+}  // namespace MsgPack
+
+// Queue the bin reply for the next call of method.
+void native_bridge_reply(const char *method, const uint8_t *data, uint16_t n);
+// Take the queued reply for method; false if there is none.
+bool native_bridge_take(const char *method, std::vector<uint8_t> &out);
+
+class NativeRpcResult {
+ public:
+  NativeRpcResult(bool ok, std::vector<uint8_t> data) : ok(ok), data(data) {}
+
+  bool result(MsgPack::bin_t<uint8_t> &out) {
+    if (!ok) return false;
+    out = data;
+    return true;
+  }
+
+  template <typename T>
+  bool result(T &) {
+    return false;
+  }
+
+ private:
+  bool ok;
+  std::vector<uint8_t> data;
+};
+
+class BridgeClass {
+ public:
+  bool begin(unsigned long = 0) { return true; }
+
+  template <typename F>
+  bool provide(const char *, F) { return true; }
+
+  template <typename F>
+  bool provide_safe(const char *, F) { return true; }
+
+  void update() {}
+
+  template <typename... Args>
+  NativeRpcResult call(const char *method, Args...) {
+    std::vector<uint8_t> data;
+    bool ok = native_bridge_take(method, data);
+    return NativeRpcResult(ok, data);
+  }
+
+  template <typename... Args>
+  void notify(const char *, Args...) {}
+};
+
+extern BridgeClass Bridge;
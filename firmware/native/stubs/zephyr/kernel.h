@@ -0,0 +1,105 @@
+// Host stand-in for the Zephyr kernel calls the sketches use. There is one
+// thread: k_thread_create() records nothing and never runs the entry point,
+// semaphores and timers never block, and the harness drives loop() itself.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct k_timeout_t {
+  int64_t ms;
+};
+
+#define K_MSEC(x) (k_timeout_t{(int64_t)(x)})
+#define K_USEC(x) (k_timeout_t{(int64_t)(x) / 1000})
+#define K_FOREVER (k_timeout_t{-1})
+#define K_NO_WAIT (k_timeout_t{0})
+
+struct k_sem {
+  unsigned count;
+  unsigned limit;
+};
+
+static inline int k_sem_init(struct k_sem *s, unsigned initial, unsigned limit) {
+  s->count = initial;
+  s->limit = limit;
+  return 0;
+}
+
+static inline void k_sem_give(struct k_sem *s) {
+  if (s->count < s->limit) s->count++;
+}
+
+static inline int k_sem_take(struct k_sem *s, k_timeout_t) {
+  if (s->count == 0) return -11;  // -EAGAIN: the timeout "expired" at once
+  s->count--;
+  return 0;
+}
+
+struct k_mutex {
+  int locked;
+};
+
+static inline int k_mutex_init(struct k_mutex *m) { m->locked = 0; return 0; }
+static inline int k_mutex_lock(struct k_mutex *m, k_timeout_t) { m->locked++; return 0; }
+static inline int k_mutex_unlock(struct k_mutex *m) { m->locked--; return 0; }
+
+struct k_spinlock {
+  int locked;
+};
+
+typedef int k_spinlock_key_t;
+
+static inline k_spinlock_key_t k_spin_lock(struct k_spinlock *) { return 0; }
+static inline void k_spin_unlock(struct k_spinlock *, k_spinlock_key_t) {}
+
+struct k_timer {
+  int running;
+};
+
+static inline void k_timer_init(struct k_timer *t, void (*)(struct k_timer *), void (*)(struct k_timer *)) {
+  t->running = 0;
+}
+static inline void k_timer_start(struct k_timer *t, k_timeout_t, k_timeout_t) { t->running = 1; }
+static inline void k_timer_stop(struct k_timer *t) { t->running = 0; }
+static inline uint32_t k_timer_status_sync(struct k_timer *) { return 1; }
+
+typedef long atomic_t;
+#define ATOMIC_INIT(x) (x)
+
+static inline long atomic_get(const atomic_t *a) { return *a; }
+static inline long atomic_set(atomic_t *a, long v) { long o = *a; *a = v; return o; }
+static inline long atomic_clear(atomic_t *a) { return atomic_set(a, 0); }
+static inline long atomic_inc(atomic_t *a) { return (*a)++; }
+static inline bool atomic_cas(atomic_t *a, long expected, long v) {
+  if (*a != expected) return false;
+  *a = v;
+  return true;
+}
+
+struct k_thread {
+  int unused;
+};
+
+typedef struct k_thread *k_tid_t;
+typedef void (*k_thread_entry_t)(void *, void *, void *);
+
+#define K_THREAD_STACK_DEFINE(sym, size) static char sym[size]
+#define K_THREAD_STACK_SIZEOF(sym) sizeof(sym)
+#define K_LOWEST_APPLICATION_THREAD_PRIO 14
+#define K_PRIO_PREEMPT(x) (x)
+#define CONFIG_NUM_COOP_PRIORITIES 16
+#define K_PRIO_COOP(x) (-(CONFIG_NUM_COOP_PRIORITIES - (x)))
+
+static inline k_tid_t k_thread_create(struct k_thread *t, char *, size_t, k_thread_entry_t, void *, void *,
+                                      void *, int, uint32_t, k_timeout_t) {
+  return t;
+}
+static inline int k_thread_name_set(k_tid_t, const char *) { return 0; }
+static inline k_tid_t k_current_get() { return nullptr; }
+
+static inline int32_t k_msleep(int32_t) { return 0; }
+static inline int32_t k_sleep(k_timeout_t) { return 0; }
+uint32_t millis();
+static inline uint32_t k_uptime_get_32() { return millis(); }
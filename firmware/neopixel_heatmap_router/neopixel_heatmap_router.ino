@@ -2,235 +2,276 @@
 //
 // Official transport:
 // - arduino-router runs on the MPU and bridges MsgPack-RPC over Serial1.
-// - Sketch polls the MPU by calling Bridge.call("heatmap/get") every 30s.
+// - Sketch polls the MPU every 30s (heatmap/bin or heatmap/get, see Data). The first
+//   poll goes out at boot and is retried every 2s until the MPU answers.
+// - Bridge.notify("heatmap/changed") from the MPU, sent when its snapshot changes,
+//   makes the next poll go out at once.
+// - HEATMAP_ASYNC_FETCH 1 issues that call from a low-priority worker thread into a
+//   back buffer; loop() swaps it in between frames, so a slow MPU never stalls the
+//   animation. 0 keeps the original inline call from loop().
 //
 // Data:
-// - The MPU returns [[before40],[after40]] where each list contains 40 floats (scores in [-0.5,+0.5]).
+// - HEATMAP_WIRE_BIN 1 calls "heatmap/bin": one MessagePack bin of
+//     ['H', version=1, count=40, flags, before int8 x40, after int8 x40]
+//   with scores quantized as round(score * 254), i.e. +-127 <=> +-0.5 (84 bytes).
+//   flags bit0 = stale: the MPU's cached snapshot is old or failed to refresh; the
+//   heatmap is then drawn at half brightness.
+// - HEATMAP_WIRE_BIN 0 calls "heatmap/get": [[before40],[after40]] as 40 floats
+//   each (scores in [-0.5,+0.5], ~730 bytes as float64).
 // - We render a constantly drifting heatmap driven by a moving center+end point.
+// - The last heatmap/bin reply is kept across resets (SentinelLED state_store.h:
+//   retained RAM, plus rate-limited flash where the build has NVS) and drawn, as
+//   stale, from the first frame after boot until a fresh poll lands.
 // - Recommendations appear as a 2s pulse between before/after, strength based on abs(diff), auto-scaled.
+// - Colours come from a constexpr score palette (256 steps, gamma applied), so there is no
+//   per-pixel HSV or powf work.
+// - Each poll is prepared once (strength-scaled blend table, pixel map); frames only
+//   evaluate the warp field and blend.
+// - The renderer is SentinelLED's heatmap mode (mode_heatmap.h), shared with the
+//   multi-mode arduino-app/sentinel sketch; this sketch is the heatmap-only build.
 //
 // Pin:
 // - NeoPixel data on D6 (per your wiring).
+//
+// Output:
+// - LED_BACKEND picks the SentinelLED WS2812 driver: WS2812_TIM_DMA (non-blocking,
+//   interrupts stay on) or WS2812_BITBANG (interrupts masked per frame).
+// - LED_STOCK_SHOW 1 bypasses SentinelLED and uses Adafruit_NeoPixel::show().
+// - Either way a frame identical to the last one sent is skipped (LedFrameGate).
+//
+// Diagnostics:
+// - "diag/stats" returns the SentinelLED perf_stats.h timing counters.
+
+#define HEATMAP_WIRE_BIN 1
 
+#if HEATMAP_WIRE_BIN
+#define MSGPACK_MAX_OBJECT_SIZE 16
+#else
 #define MSGPACK_MAX_ARRAY_SIZE 96
 #define MSGPACK_MAX_OBJECT_SIZE 256
+#endif
 
 #include <Arduino_RouterBridge.h>
 #include <Adafruit_NeoPixel.h>
-#include <math.h>
+#include <SentinelLED.h>
+#include <string.h>
+#include <zephyr/kernel.h>
 
 #define PIN 6
-#define W 5
-#define H 8
-#define NUMPIXELS (W * H)
+#define NUMPIXELS HEATMAP_COUNT
 
-static const uint8_t BRIGHTNESS_CAP = 8;
-static const uint32_t POLL_INTERVAL_MS = 30000;
-static const float PULSE_PERIOD_S = 2.0f;
+#define LED_BACKEND WS2812_TIM_DMA
+#define LED_STOCK_SHOW 0
+#define HEATMAP_ASYNC_FETCH 1
 
-static const float DRIFT_SPEED = 0.10f;
-static const float WARP_AMP = 0.55f;
-static const float WARP_FREQ = 0.65f;
+static const uint32_t POLL_INTERVAL_MS = 30000;
+// Until the first poll succeeds.
+static const uint32_t BOOT_RETRY_MS = 2000;
 
 Adafruit_NeoPixel pixels(NUMPIXELS, PIN, NEO_GRB + NEO_KHZ800);
 
-static float before40[40];
-static float after40[40];
+// Frames arrive here already scaled to the brightness cap.
+static LedCanvas canvas;
 
 static uint32_t lastPollMs = 0;
-static uint32_t lastFrameMs = 0;
-static float tSec = 0.0f;
-
-static float cx = 2.0f, cy = 3.5f;
-static float ex = 4.0f, ey = 7.0f;
-static float cdx = 0.31f, cdy = -0.17f;
-static float edx = -0.23f, edy = 0.19f;
-
-static int XY(int x, int y) {
-  const bool serpentine = true;
-  if (!serpentine) return y * W + x;
-  if (y & 1) return y * W + (W - 1 - x);
-  return y * W + x;
+static bool polledOnce = false;
+
+#if HEATMAP_ASYNC_FETCH
+#define FETCH_STACK_SIZE 4096
+
+// Written only by the fetch thread while backReady is clear, read only by
+// loop() while it is set.
+static float backBefore[HEATMAP_COUNT];
+static float backAfter[HEATMAP_COUNT];
+static bool backStale;
+static atomic_t backReady;
+
+// Given by heatmap/changed to cut the fetch thread's wait short.
+static struct k_sem fetchSem;
+
+K_THREAD_STACK_DEFINE(fetchStack, FETCH_STACK_SIZE);
+static struct k_thread fetchThread;
+#else
+// Set by heatmap/changed, taken by maybePoll().
+static atomic_t pollNow;
+#endif
+
+// Last frame on the strip. At the brightness cap only a few levels per channel
+// survive, so consecutive frames often match; those are not sent.
+static LedFrameGate shieldGate;
+
+static void showPixels() {
+  if (!frame_gate_pass(shieldGate, canvas.shield, sizeof(canvas.shield))) return;
+  uint32_t start = perf_cycles();
+#if LED_STOCK_SHOW
+  // setBrightness(255) in setup() leaves the bytes unscaled.
+  memcpy(pixels.getPixels(), canvas.shield, sizeof(canvas.shield));
+  pixels.show();
+#else
+  ws2812_show(canvas.shield, sizeof(canvas.shield));
+#endif
+  perf_record(PERF_SHOW, start);
 }
 
+// One heatmap RPC round trip. Blocks until the MPU answers; returns false and
+// leaves the arrays untouched if the reply is missing or malformed.
+#if HEATMAP_WIRE_BIN
+static bool fetchHeatmap(float *before, float *after, bool *stale) {
+  MsgPack::bin_t<uint8_t> out;
+  if (!Bridge.call("heatmap/bin").result(out)) {
+    return false;
+  }
+  uint8_t raw[HEATMAP_BIN_SIZE];
+  uint16_t n = (uint16_t)out.size();
+  if (n == HEATMAP_BIN_SIZE) {
+    for (uint16_t i = 0; i < n; i++) raw[i] = out[i];
+  }
+  bool ok = n == HEATMAP_BIN_SIZE && heatmap_decode_bin(raw, n, before, after, stale);
+  perf_rpc(ok);
+  if (ok) state_store_save(STATE_KEY_HEATMAP, raw, n);
+  return ok;
+}
+
+// Boot: draw the stored reply, as stale, until the first poll lands.
+static void restoreHeatmap() {
+  uint8_t raw[HEATMAP_BIN_SIZE];
+  float before[HEATMAP_COUNT];
+  float after[HEATMAP_COUNT];
+  bool stale;
+  if (!state_store_load(STATE_KEY_HEATMAP, raw, sizeof(raw))) return;
+  if (!heatmap_decode_bin(raw, sizeof(raw), before, after, &stale)) return;
+  heatmap_load(before, after, true);
+}
+#else
 static float clampf(float v, float lo, float hi) {
   if (v < lo) return lo;
   if (v > hi) return hi;
   return v;
 }
 
-static uint8_t gamma8(uint8_t x) {
-  float xf = (float)x / 255.0f;
-  float yf = powf(xf, 2.2f);
-  int yi = (int)(yf * 255.0f + 0.5f);
-  if (yi < 0) yi = 0;
-  if (yi > 255) yi = 255;
-  return (uint8_t)yi;
-}
-
-static void hsv2rgb(float h, float s, float v, uint8_t &r, uint8_t &g, uint8_t &b) {
-  h = h - floorf(h);
-  float c = v * s;
-  float hp = h * 6.0f;
-  float x = c * (1.0f - fabsf(fmodf(hp, 2.0f) - 1.0f));
-  float r1 = 0, g1 = 0, b1 = 0;
-  if (hp < 1) { r1 = c; g1 = x; b1 = 0; }
-  else if (hp < 2) { r1 = x; g1 = c; b1 = 0; }
-  else if (hp < 3) { r1 = 0; g1 = c; b1 = x; }
-  else if (hp < 4) { r1 = 0; g1 = x; b1 = c; }
-  else if (hp < 5) { r1 = x; g1 = 0; b1 = c; }
-  else { r1 = c; g1 = 0; b1 = x; }
-  float m = v - c;
-  r = (uint8_t)clampf((r1 + m) * 255.0f, 0.0f, 255.0f);
-  g = (uint8_t)clampf((g1 + m) * 255.0f, 0.0f, 255.0f);
-  b = (uint8_t)clampf((b1 + m) * 255.0f, 0.0f, 255.0f);
-}
-
-static void scoreToColor(float score, uint8_t &r, uint8_t &g, uint8_t &b) {
-  score = clampf(score, -0.5f, 0.5f);
-  float t = (score + 0.5f) / 1.0f;
-  float hue = (t * 120.0f) / 360.0f; // red->green
-  hsv2rgb(hue, 1.0f, 1.0f, r, g, b);
-}
-
-static void driftPoints(float dt) {
-  cx += cdx * dt * DRIFT_SPEED * 10.0f;
-  cy += cdy * dt * DRIFT_SPEED * 10.0f;
-  ex += edx * dt * DRIFT_SPEED * 10.0f;
-  ey += edy * dt * DRIFT_SPEED * 10.0f;
-
-  if (cx < 0.0f) { cx = 0.0f; cdx = fabsf(cdx); }
-  if (cx > (float)(W - 1)) { cx = (float)(W - 1); cdx = -fabsf(cdx); }
-  if (cy < 0.0f) { cy = 0.0f; cdy = fabsf(cdy); }
-  if (cy > (float)(H - 1)) { cy = (float)(H - 1); cdy = -fabsf(cdy); }
-
-  if (ex < 0.0f) { ex = 0.0f; edx = fabsf(edx); }
-  if (ex > (float)(W - 1)) { ex = (float)(W - 1); edx = -fabsf(edx); }
-  if (ey < 0.0f) { ey = 0.0f; edy = fabsf(edy); }
-  if (ey > (float)(H - 1)) { ey = (float)(H - 1); edy = -fabsf(edy); }
-
-  cdx += 0.002f * sinf(tSec * 0.7f);
-  cdy += 0.002f * cosf(tSec * 0.9f);
-  edx += 0.002f * cosf(tSec * 0.8f);
-  edy += 0.002f * sinf(tSec * 0.6f);
-}
-
-static void maybePoll() {
-  uint32_t now = millis();
-  if ((now - lastPollMs) < POLL_INTERVAL_MS) return;
-  lastPollMs = now;
-
+static bool fetchHeatmap(float *before, float *after, bool *stale) {
+  // heatmap/get carries no staleness.
+  *stale = false;
   // Result is expected to be an array of 2 arrays of floats.
   MsgPack::arr_t<MsgPack::arr_t<float>> out;
   if (!Bridge.call("heatmap/get").result(out)) {
-    return;
+    return false;
   }
-  if (out.size() < 2) return;
-  if (out[0].size() < 40 || out[1].size() < 40) return;
+  if (out.size() < 2 || out[0].size() < HEATMAP_COUNT || out[1].size() < HEATMAP_COUNT) {
+    perf_rpc(false);
+    return false;
+  }
+  perf_rpc(true);
 
-  for (int i = 0; i < 40; i++) {
-    before40[i] = clampf(out[0][i], -0.5f, 0.5f);
-    after40[i] = clampf(out[1][i], -0.5f, 0.5f);
+  for (int i = 0; i < HEATMAP_COUNT; i++) {
+    before[i] = clampf(out[0][i], -0.5f, 0.5f);
+    after[i] = clampf(out[1][i], -0.5f, 0.5f);
   }
+  return true;
 }
 
-static void renderFrame() {
-  float phase = fmodf(tSec, PULSE_PERIOD_S) / PULSE_PERIOD_S;
-  float pulse = 0.5f + 0.5f * sinf(phase * 2.0f * (float)M_PI);
-
-  float maxAbsDiff = 0.0f;
-  for (int i = 0; i < 40; i++) {
-    float d = fabsf(after40[i] - before40[i]);
-    if (d > maxAbsDiff) maxAbsDiff = d;
-  }
-  if (maxAbsDiff < 0.001f) maxAbsDiff = 0.001f;
-
-  float dx = ex - cx;
-  float dy = ey - cy;
-  float len = sqrtf(dx * dx + dy * dy);
-  if (len < 0.001f) { dx = 1.0f; dy = 0.0f; len = 1.0f; }
-  dx /= len;
-  dy /= len;
-  float px = -dy;
-  float py = dx;
-
-  float uMin = 1e9f, uMax = -1e9f;
-  float uField[NUMPIXELS];
-
-  for (int y = 0; y < H; y++) {
-    for (int x = 0; x < W; x++) {
-      float fx = (float)x;
-      float fy = (float)y;
-      float rx = fx - cx;
-      float ry = fy - cy;
-      float u = rx * dx + ry * dy;
-      float v = rx * px + ry * py;
-      u += WARP_AMP * sinf((v * WARP_FREQ) + tSec * 0.9f);
-      u += 0.25f * sinf((u * 1.3f) + tSec * 0.6f);
-
-      int p = XY(x, y);
-      uField[p] = u;
-      if (u < uMin) uMin = u;
-      if (u > uMax) uMax = u;
+// heatmap/get replies are not stored; boot shows the default dataset.
+static void restoreHeatmap() {}
+#endif
+
+#if HEATMAP_ASYNC_FETCH
+// Owns the state store in this build: fetchHeatmap() saves, and the flash
+// write happens here too.
+static void fetchLoop(void *, void *, void *) {
+  for (;;) {
+    // loop() has not taken the previous result yet; keep it rather than
+    // writing under it.
+    if (!atomic_get(&backReady) && fetchHeatmap(backBefore, backAfter, &backStale)) {
+      polledOnce = true;
+      atomic_set(&backReady, 1);
     }
+    state_store_poll(millis());
+    k_sem_take(&fetchSem, K_MSEC(polledOnce ? POLL_INTERVAL_MS : BOOT_RETRY_MS));
   }
+}
 
-  float denom = uMax - uMin;
-  if (denom < 0.001f) denom = 0.001f;
-
-  pixels.setBrightness(BRIGHTNESS_CAP);
-
-  for (int y = 0; y < H; y++) {
-    for (int x = 0; x < W; x++) {
-      int p = XY(x, y);
-      float uNorm = (uField[p] - uMin) / denom;
-      int idx = (int)floorf(uNorm * 39.999f);
-      if (idx < 0) idx = 0;
-      if (idx > 39) idx = 39;
-
-      float diff = fabsf(after40[idx] - before40[idx]);
-      float strength = clampf(diff / maxAbsDiff, 0.0f, 1.0f);
-      float mix = strength * pulse;
-      float s = after40[idx] * (1.0f - mix) + before40[idx] * mix;
-
-      uint8_t r, g, b;
-      scoreToColor(s, r, g, b);
-      r = gamma8(r);
-      g = gamma8(g);
-      b = gamma8(b);
-      pixels.setPixelColor(p, pixels.Color(r, g, b));
-    }
-  }
+// Swap a finished fetch into the renderer. Called between frames.
+static void maybePoll() {
+  if (!atomic_get(&backReady)) return;
+  heatmap_load(backBefore, backAfter, backStale);
+  atomic_clear(&backReady);
+  lastPollMs = millis();
+}
+#else
+static void maybePoll() {
+  uint32_t now = millis();
+  state_store_poll(now);
+  bool due = (now - lastPollMs) >= (polledOnce ? POLL_INTERVAL_MS : BOOT_RETRY_MS);
+  if (!atomic_clear(&pollNow) && !due) return;
+  lastPollMs = now;
 
-  pixels.show();
+  float before[HEATMAP_COUNT];
+  float after[HEATMAP_COUNT];
+  bool stale;
+  if (!fetchHeatmap(before, after, &stale)) return;
+  polledOnce = true;
+  heatmap_load(before, after, stale);
+}
+#endif
+
+// The MPU's snapshot changed: poll now rather than at the next interval.
+static void heatmapChanged() {
+#if HEATMAP_ASYNC_FETCH
+  k_sem_give(&fetchSem);
+#else
+  atomic_set(&pollNow, 1);
+#endif
+}
+
+// Timing counters since the previous call, see perf_snapshot().
+static MsgPack::arr_t<uint32_t> diagStats() {
+  uint32_t fields[PERF_STATS_FIELDS];
+  perf_snapshot(fields);
+  MsgPack::arr_t<uint32_t> out;
+  for (uint8_t i = 0; i < PERF_STATS_FIELDS; i++) out.push_back(fields[i]);
+  return out;
 }
 
 void setup() {
+  perf_begin();
   pixels.begin();
-  pixels.setBrightness(BRIGHTNESS_CAP);
-  pixels.clear();
-  pixels.show();
+#if LED_STOCK_SHOW
+  pixels.setBrightness(255);
+#else
+  ws2812_begin(LED_BACKEND, NUMPIXELS);
+#endif
+  showPixels();
 
-  for (int i = 0; i < 40; i++) { before40[i] = 0.0f; after40[i] = 0.0f; }
+  MODE_HEATMAP.enter(millis());
+  state_store_begin();
+  restoreHeatmap();
 
   // On UNO Q, Bridge is pre-defined on Serial1.
   Bridge.begin();
-
-  lastPollMs = millis();
-  lastFrameMs = millis();
+  Bridge.provide("diag/stats", diagStats);
+  Bridge.provide("heatmap/changed", heatmapChanged);
+
+  // So the first poll goes out straight away.
+  lastPollMs = millis() - BOOT_RETRY_MS;
+
+#if HEATMAP_ASYNC_FETCH
+  k_sem_init(&fetchSem, 0, 1);
+  k_thread_create(&fetchThread, fetchStack, K_THREAD_STACK_SIZEOF(fetchStack),
+                  fetchLoop, NULL, NULL, NULL,
+                  K_LOWEST_APPLICATION_THREAD_PRIO, 0, K_NO_WAIT);
+  k_thread_name_set(&fetchThread, "heatmap_fetch");
+#endif
 }
 
 void loop() {
-  uint32_t now = millis();
-  uint32_t dtMs = now - lastFrameMs;
-  if (dtMs > 100) dtMs = 100;
-  lastFrameMs = now;
-  float dt = (float)dtMs / 1000.0f;
-  tSec += dt;
-
+  perf_loop();
   maybePoll();
-  driftPoints(dt);
-  renderFrame();
-  delay(12);
+  uint32_t start = perf_cycles();
+  uint32_t frameMs = MODE_HEATMAP.render(millis(), canvas);
+  perf_record(PERF_RENDER, start);
+  showPixels();
+#if !LED_STOCK_SHOW
+  ws2812_poll();
+#endif
+  delay(frameMs);
 }
-
@@ -115,10 +115,12 @@ fi
 if git diff --name-only "$LOCAL" "$REMOTE" -- arduino-app/sentinel/ | grep -q .; then
     log "LED app changed, updating..."
     mkdir -p "$LED_APP_DEST"
-    rm -rf "$LED_APP_DEST/python" "$LED_APP_DEST/sketch"
+    rm -rf "$LED_APP_DEST/python" "$LED_APP_DEST/sketch" "$LED_APP_DEST/libraries"
     cp "$LED_APP_SRC/app.yaml" "$LED_APP_DEST/"
     cp -R "$LED_APP_SRC/python" "$LED_APP_DEST/"
     cp -R "$LED_APP_SRC/sketch" "$LED_APP_DEST/"
+    # Shared firmware library referenced from sketch/sketch.yaml as ../libraries/SentinelLED
+    cp -R "$LED_APP_SRC/libraries" "$LED_APP_DEST/"
     # On-device, the running app id shows up as "user:sentinel".
     # Stop by id first (most reliable), then fall back to the short name.
     arduino-app-cli app stop user:sentinel 2>/dev/null || arduino-app-cli app stop sentinel 2>/dev/null || true
@@ -2,114 +2,305 @@
 """UNO Q MPU-side server for the NeoPixel heatmap (official arduino-router bridge).
 
 Sketch side (MCU):
-  - calls Bridge.call("heatmap/get").result(out)
+  - calls Bridge.call("heatmap/bin") (or the legacy "heatmap/get")
 
 Linux side (MPU, this script):
   - connects to /var/run/arduino-router.sock
-  - registers method name "heatmap/get" via $/register
+  - registers "heatmap/get" and "heatmap/bin" via $/register
   - serves MsgPack-RPC requests and responds with:
-      [[before40...],[after40...]]
+      heatmap/get: [[before40...],[after40...]]
+      heatmap/bin: one bin, see sentinel.led.heatmap_parts.encode_heatmap_frame
+
+The arrays are computed off the request path. A refresher thread, with its
+own event loop, DB connection and Planner, keeps a snapshot in memory and
+recomputes it every HEATMAP_REFRESH_SEC, or sooner once a portfolio sync or
+planner job completes. Handlers answer from that snapshot.
+A snapshot that is older than HEATMAP_STALE_SEC, or whose last refresh failed,
+has HEATMAP_FLAG_STALE set in the heatmap/bin flags. The planner's CPU-bound work
+runs on that thread, so it never stalls the loop that answers the MCU.
+
+Job completions arrive through Sentinel's /api/led/events stream (at
+SENTINEL_API_URL); checking the job log every HEATMAP_CHECK_SEC is the
+fallback. When a refresh changes the snapshot, the MCU is sent
+"heatmap/changed" so it polls at once instead of at its next 30 s poll.
 """
 
 from __future__ import annotations
 
 import asyncio
+import json
 import logging
 import os
-from typing import Any
+import threading
+import time
+from dataclasses import dataclass
+from typing import Any, Awaitable, Callable
+
+import httpx
 
 from sentinel.database import Database
-from sentinel.led.arduino_router_rpc import UnixMsgpackRpc, serve_forever
-from sentinel.led.heatmap_parts import SecurityScore, build_sorted_parts, clamp_score
+from sentinel.led.arduino_router_rpc import AsyncMsgpackRpc
+from sentinel.led.events import SseParser
+from sentinel.led.heatmap_parts import encode_heatmap_frame, heatmap_before_after
 from sentinel.planner import Planner
 
 logging.basicConfig(level=logging.INFO, format="%(asctime)s %(levelname)s %(message)s")
 logger = logging.getLogger("uno_q_heatmap_router_server")
 
+HEATMAP_FLAG_STALE = 0x01
+
+# Jobs whose completion changes positions or recommendations.
+TRIGGER_JOBS = ("sync:portfolio", "planning:refresh", "trading:execute")
+# /api/led/events sources that change the heatmap.
+TRIGGER_SOURCES = {"portfolio", "prices", "planner"}
+
+
+def _env_float(name: str, default: float) -> float:
+    try:
+        return float(os.environ.get(name, default))
+    except ValueError:
+        return default
+
+
+@dataclass(frozen=True)
+class HeatmapSnapshot:
+    before40: list[float]
+    after40: list[float]
+    computed_at: float | None  # time.time() of the last successful refresh
+    refresh_failed: bool = False
+
+    def age_sec(self, now: float | None = None) -> float | None:
+        if self.computed_at is None:
+            return None
+        return max(0.0, (now if now is not None else time.time()) - self.computed_at)
+
+    def is_stale(self, stale_after_sec: float, now: float | None = None) -> bool:
+        age = self.age_sec(now)
+        return self.refresh_failed or age is None or age > stale_after_sec
+
+
+class HeatmapCache:
+    """Holder for the latest snapshot, shared by the refresher and RPC handlers.
+
+    Snapshots are immutable and swapped in with one assignment, so the refresher
+    thread and the RPC loop need no lock.
+    """
 
-async def compute_before_after() -> list[list[float]]:
+    def __init__(self) -> None:
+        self._snapshot = HeatmapSnapshot([0.0] * 40, [0.0] * 40, None)
+
+    def get(self) -> HeatmapSnapshot:
+        return self._snapshot
+
+    def store(self, before40: list[float], after40: list[float]) -> None:
+        self._snapshot = HeatmapSnapshot(list(before40), list(after40), time.time())
+
+    def mark_failed(self) -> None:
+        snap = self._snapshot
+        self._snapshot = HeatmapSnapshot(snap.before40, snap.after40, snap.computed_at, refresh_failed=True)
+
+
+async def compute_before_after(db: Database) -> list[list[float]]:
+    positions = await db.get_all_positions()
+    if not positions:
+        return [[0.0] * 40, [0.0] * 40]
+    try:
+        recs = await Planner().get_recommendations()
+    except Exception as e:
+        logger.warning(f"Failed to get recommendations; after==before: {e}")
+        recs = []
+    before40, after40 = heatmap_before_after(positions, recs)
+    return [before40, after40]
+
+
+async def latest_trigger_completion(db: Database) -> float | None:
+    latest: float | None = None
+    for job_type in TRIGGER_JOBS:
+        done = await db.get_last_job_completion(job_type)
+        if done is not None and (latest is None or done.timestamp() > latest):
+            latest = done.timestamp()
+    return latest
+
+
+async def follow_events(api_url: str, wake: asyncio.Event, *, retry_sec: float) -> None:
+    """Set `wake` for each /api/led/events event that changes the heatmap."""
+    async with httpx.AsyncClient(timeout=httpx.Timeout(10.0, read=150.0)) as client:
+        while True:
+            try:
+                async with client.stream("GET", f"{api_url}/api/led/events") as resp:
+                    if resp.status_code == 404:
+                        logger.info("No /api/led/events on this Sentinel; polling the job log only")
+                        return
+                    resp.raise_for_status()
+                    logger.info(f"Following display events at {api_url}")
+                    parser = SseParser()
+                    async for line in resp.aiter_lines():
+                        event = parser.feed(line)
+                        if event is None or event[0] != "display":
+                            continue
+                        sources = set(json.loads(event[1]).get("sources") or [])
+                        if sources & TRIGGER_SOURCES:
+                            wake.set()
+            except Exception as e:
+                logger.warning(f"Display event stream lost: {e}")
+            await asyncio.sleep(retry_sec)
+
+
+async def refresh_forever(
+    cache: HeatmapCache,
+    *,
+    refresh_sec: float,
+    check_sec: float,
+    wake: asyncio.Event | None = None,
+    on_change: Callable[[], Awaitable[None]] | None = None,
+) -> None:
+    """Keep `cache` current: on a schedule, when a trigger job completes, and when woken.
+
+    `on_change` runs after a refresh that changed the snapshot.
+    """
     db = Database()
     await db.connect()
-    planner = Planner()
+    seen_trigger: float | None = None
+    woken = False
     try:
-        positions = await db.get_all_positions()
-        if not positions:
-            return [[0.0] * 40, [0.0] * 40]
-
-        before_values: dict[str, float] = {}
-        scores: dict[str, float] = {}
-        for p in positions:
-            sym = str(p["symbol"])
-            qty = float(p.get("quantity") or 0.0)
-            current_price = float(p.get("current_price") or 0.0)
-            avg_cost = float(p.get("avg_cost") or 0.0)
-
-            before_values[sym] = max(0.0, qty * current_price)
-            if avg_cost > 0 and current_price > 0:
-                pl = (current_price - avg_cost) / avg_cost
-            else:
-                pl = 0.0
-            scores[sym] = clamp_score(pl, clamp_abs=0.5)
-
-        total_before = sum(before_values.values())
-        if total_before <= 0:
-            return [[0.0] * 40, [0.0] * 40]
-
-        after_values = dict(before_values)
-        try:
-            recs = await planner.get_recommendations()
-        except Exception as e:
-            logger.warning(f"Failed to get recommendations; after==before: {e}")
-            recs = []
-
-        for r in recs or []:
-            sym = getattr(r, "symbol", None)
-            if not sym:
+        while True:
+            try:
+                trigger = await latest_trigger_completion(db)
+                previous = cache.get()
+                age = previous.age_sec()
+                if woken or age is None or age >= refresh_sec or trigger != seen_trigger:
+                    started = time.monotonic()
+                    before40, after40 = await compute_before_after(db)
+                    cache.store(before40, after40)
+                    seen_trigger = trigger
+                    logger.info(f"Heatmap snapshot refreshed in {time.monotonic() - started:.2f}s")
+                    changed = (before40, after40) != (previous.before40, previous.after40)
+                    if changed and on_change is not None:
+                        await on_change()
+            except Exception as e:
+                cache.mark_failed()
+                logger.warning(f"Heatmap snapshot refresh failed: {e}")
+            woken = False
+            if wake is None:
+                await asyncio.sleep(check_sec)
                 continue
-            delta = float(getattr(r, "value_delta_eur", 0.0) or 0.0)
-            after_values[sym] = max(0.0, after_values.get(sym, 0.0) + delta)
-
-        total_after = sum(after_values.values()) or total_before
-
-        before_scores: list[SecurityScore] = []
-        after_scores: list[SecurityScore] = []
-        for sym, score in scores.items():
-            w_before = before_values.get(sym, 0.0) / total_before
-            w_after = after_values.get(sym, 0.0) / total_after
-            before_scores.append(SecurityScore(symbol=sym, weight=w_before, score=score))
-            after_scores.append(SecurityScore(symbol=sym, weight=w_after, score=score))
-
-        before40 = build_sorted_parts(before_scores, total_parts=40)
-        after40 = build_sorted_parts(after_scores, total_parts=40)
-        return [before40, after40]
+            try:
+                await asyncio.wait_for(wake.wait(), timeout=check_sec)
+                woken = True
+            except asyncio.TimeoutError:
+                pass
+            wake.clear()
     finally:
         await db.close()
 
 
-def main() -> int:
-    sock_path = os.environ.get("ARDUINO_ROUTER_SOCK", "/var/run/arduino-router.sock")
+def start_refresher(
+    cache: HeatmapCache,
+    *,
+    refresh_sec: float,
+    check_sec: float,
+    api_url: str,
+    events_retry_sec: float,
+    on_change: Callable[[], Awaitable[None]],
+) -> Callable[[], None]:
+    """Run refresh_forever and follow_events on their own thread and event loop.
+
+    on_change is a coroutine function of the calling loop and is run there. Returns
+    a function that stops the thread.
+    """
+    rpc_loop = asyncio.get_running_loop()
+    loop = asyncio.new_event_loop()
+
+    async def changed() -> None:
+        asyncio.run_coroutine_threadsafe(on_change(), rpc_loop)
+
+    async def refresh_main() -> None:
+        wake = asyncio.Event()
+        await asyncio.gather(
+            refresh_forever(cache, refresh_sec=refresh_sec, check_sec=check_sec, wake=wake, on_change=changed),
+            follow_events(api_url, wake, retry_sec=events_retry_sec),
+        )
+
+    def thread_main() -> None:
+        asyncio.set_event_loop(loop)
+        main_task = loop.create_task(refresh_main())
+        try:
+            loop.run_until_complete(main_task)
+        except asyncio.CancelledError:
+            pass
+        finally:
+            loop.close()
+
+    thread = threading.Thread(target=thread_main, name="heatmap-refresh", daemon=True)
+    thread.start()
+
+    def stop() -> None:
+        def cancel_all() -> None:
+            for task in asyncio.all_tasks(loop):
+                task.cancel()
+
+        try:
+            loop.call_soon_threadsafe(cancel_all)
+        except RuntimeError:
+            pass  # the loop already finished and closed
+        thread.join(timeout=5)
+
+    return stop
+
+
+async def run(sock_path: str) -> None:
     method = os.environ.get("HEATMAP_METHOD", "heatmap/get")
+    bin_method = os.environ.get("HEATMAP_BIN_METHOD", "heatmap/bin")
+    refresh_sec = _env_float("HEATMAP_REFRESH_SEC", 300.0)
+    check_sec = _env_float("HEATMAP_CHECK_SEC", 15.0)
+    stale_sec = _env_float("HEATMAP_STALE_SEC", 900.0)
+    api_url = os.environ.get("SENTINEL_API_URL", "http://127.0.0.1:8000")
+    events_retry_sec = _env_float("HEATMAP_EVENTS_RETRY_SEC", 10.0)
 
-    rpc = UnixMsgpackRpc(sock_path)
-    rpc.connect()
-    logger.info(f"Connected to arduino-router socket {sock_path}")
+    cache = HeatmapCache()
 
-    # Register the method name so the router can route calls to this connection.
-    rpc.call("$/register", method)
-    logger.info(f"Registered method {method!r}")
+    async def handle_get(_: list[Any]) -> Any:
+        snap = cache.get()
+        return [snap.before40, snap.after40]
 
-    loop = asyncio.new_event_loop()
-    asyncio.set_event_loop(loop)
+    async def handle_bin(_: list[Any]) -> Any:
+        snap = cache.get()
+        flags = HEATMAP_FLAG_STALE if snap.is_stale(stale_sec) else 0
+        return encode_heatmap_frame(snap.before40, snap.after40, flags=flags)
 
-    def handle_get(_: list[Any]) -> Any:
-        # Compute async data in the background event loop but block this handler
-        # (router calls are synchronous per request).
-        return loop.run_until_complete(compute_before_after())
+    rpc = AsyncMsgpackRpc(sock_path)
+    rpc.add_method(method, handle_get)
+    rpc.add_method(bin_method, handle_bin)
+    await rpc.connect()
+    logger.info(f"Connected to arduino-router socket {sock_path}")
 
+    async def notify_changed() -> None:
+        try:
+            await rpc.notify("heatmap/changed")
+        except Exception as e:
+            logger.warning(f"heatmap/changed notify failed: {e}")
+
+    stop_refresher = start_refresher(
+        cache,
+        refresh_sec=refresh_sec,
+        check_sec=check_sec,
+        api_url=api_url,
+        events_retry_sec=events_retry_sec,
+        on_change=notify_changed,
+    )
     try:
-        serve_forever(rpc, {method: handle_get})
+        # Register the method names so the router can route calls to this connection.
+        await rpc.register(method, bin_method)
+        logger.info(f"Registered methods {method!r}, {bin_method!r}")
+        await rpc.serve_forever()
     finally:
-        rpc.close()
+        await asyncio.to_thread(stop_refresher)
+        await rpc.close()
+
+
+def main() -> int:
+    sock_path = os.environ.get("ARDUINO_ROUTER_SOCK", "/var/run/arduino-router.sock")
+    asyncio.run(run(sock_path))
     return 0
 
 
@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+"""Bridge RPC load test for the UNO Q LED MCU: record real traffic, replay it, benchmark.
+
+Runs on the UNO Q MPU, next to arduino-router (see sentinel.led.rpc_bench):
+
+  record  pass-through proxy that writes a JSONL trace of hm.u/hm.b, updateState,
+          setBrightness and heatmap/* traffic. Point a client's ARDUINO_ROUTER_SOCK
+          at --listen.
+  replay  send a trace's calls to the board, up to 1000x faster than recorded
+  synth   send a synthetic mix (--mix hm.b=6,updateState=2,...) at --rate calls/s
+  bench   the fixed sweep (BENCH_RATES x BENCH_SECONDS, seeded) for comparing firmware
+          builds: save one run with --out, pass it back as --compare after a change
+
+Each run prints calls/sec, p50/p99/max round-trip times, timeouts, MCU decode
+failures and dropped hm.b frames with the MCU's diag/stats totals; --out keeps the
+full report, including one entry per diag/stats window. Stop the LED app (and, with
+--serve-heatmap, the heatmap router) first: both talk to the same MCU.
+"""
+
+from __future__ import annotations
+
+import argparse
+import asyncio
+import json
+import logging
+import os
+import sys
+
+from sentinel.led.arduino_router_rpc import AsyncMsgpackRpc
+from sentinel.led.heatmap_parts import encode_heatmap_frame
+from sentinel.led.rpc_bench import (
+    BENCH_RATES,
+    BENCH_SECONDS,
+    BENCH_SEED,
+    DEFAULT_MIX,
+    MAX_SPEED,
+    RECORD_METHODS,
+    RecordingProxy,
+    format_bench,
+    format_report,
+    heatmap_frame_from_trace,
+    load_trace,
+    parse_mix,
+    replay_schedule,
+    run_load,
+    serve_heatmap,
+    synthetic_schedule,
+)
+
+logging.basicConfig(level=logging.INFO, format="%(asctime)s %(levelname)s %(message)s")
+logger = logging.getLogger("uno_q_rpc_bench")
+
+DEFAULT_SOCK = os.environ.get("ARDUINO_ROUTER_SOCK", "/var/run/arduino-router.sock")
+
+
+async def record(args: argparse.Namespace) -> None:
+    if os.path.exists(args.listen):
+        os.unlink(args.listen)
+    with open(args.trace, "a", encoding="utf-8") as out:
+        proxy = RecordingProxy(args.listen, args.router, out, methods=None if args.all else RECORD_METHODS)
+        await proxy.start()
+        logger.info(f"Recording {args.router} traffic through {args.listen} into {args.trace}")
+        try:
+            await proxy.serve_forever()
+        finally:
+            await proxy.close()
+
+
+async def _drive(args: argparse.Namespace, runs: list[tuple[float | None, list]], heatmap: bytes | None) -> list[dict]:
+    rpc = AsyncMsgpackRpc(args.router, max_concurrency=max(8, args.concurrency))
+    await rpc.connect()
+    served: dict[str, int] = {}
+    try:
+        if args.serve_heatmap:
+            await serve_heatmap(rpc, heatmap or encode_heatmap_frame([0.0] * 40, [0.0] * 40), served)
+        reports = []
+        for rate, ops in runs:
+            report = await run_load(
+                rpc,
+                ops,
+                notify=args.notify,
+                timeout=args.timeout,
+                concurrency=args.concurrency,
+                stats_interval=args.stats_interval,
+            )
+            if rate is not None:
+                report["rate"] = rate
+            if args.serve_heatmap:
+                report["heatmap_served"] = dict(served)
+                served.clear()
+            reports.append(report)
+        return reports
+    finally:
+        await rpc.close()
+
+
+def _baseline(args: argparse.Namespace) -> dict | None:
+    if not args.compare:
+        return None
+    with open(args.compare, encoding="utf-8") as f:
+        return json.load(f)
+
+
+def _save(args: argparse.Namespace, result: dict) -> None:
+    if args.out:
+        with open(args.out, "w", encoding="utf-8") as f:
+            json.dump(result, f, indent=2)
+        logger.info(f"Report written to {args.out}")
+
+
+async def replay(args: argparse.Namespace) -> None:
+    events = load_trace(args.trace)
+    ops = replay_schedule(events, speed=args.speed)
+    if not ops:
+        raise SystemExit(f"{args.trace}: no client calls to replay")
+    logger.info(f"Replaying {len(ops)} op(s) over {ops[-1].at:.1f} s at {args.speed:g}x")
+    (report,) = await _drive(args, [(None, ops)], heatmap_frame_from_trace(events))
+    print(format_report(report, _baseline(args)))
+    _save(args, report)
+
+
+async def synth(args: argparse.Namespace) -> None:
+    ops = synthetic_schedule(parse_mix(args.mix), rate=args.rate, duration=args.duration, seed=args.seed)
+    (report,) = await _drive(args, [(args.rate, ops)], None)
+    print(format_report(report, _baseline(args)))
+    _save(args, report)
+
+
+async def bench(args: argparse.Namespace) -> None:
+    runs = [
+        (rate, synthetic_schedule(DEFAULT_MIX, rate=rate, duration=BENCH_SECONDS, seed=BENCH_SEED))
+        for rate in BENCH_RATES
+    ]
+    levels = await _drive(args, runs, None)
+    result = {"build_id": levels[0]["mcu"].get("build_id"), "mode": levels[0]["mode"], "levels": levels}
+    print(format_bench(result, _baseline(args)))
+    _save(args, result)
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="UNO Q bridge RPC record/replay load test")
+    parser.add_argument("--router", default=DEFAULT_SOCK, help="arduino-router socket")
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    rec = sub.add_parser("record", help="record client traffic through a pass-through socket")
+    rec.add_argument("trace", help="JSONL trace to append to")
+    rec.add_argument("--listen", default="/tmp/arduino-router-record.sock", help="socket clients connect to")
+    rec.add_argument("--all", action="store_true", help="record every method, not just the display traffic")
+
+    def driver(p: argparse.ArgumentParser) -> None:
+        p.add_argument("--notify", action="store_true", help="send every op as a notify (no round trips)")
+        p.add_argument("--timeout", type=float, default=2.0, help="per-call timeout, seconds")
+        p.add_argument("--concurrency", type=int, default=1, help="calls in flight at once")
+        p.add_argument("--stats-interval", type=float, default=5.0, help="seconds between diag/stats polls")
+        p.add_argument("--serve-heatmap", action="store_true", help="answer the MCU's heatmap/get and heatmap/bin")
+        p.add_argument("--out", help="write the JSON report here")
+        p.add_argument("--compare", help="JSON report of an earlier run to compare against")
+
+    rep = sub.add_parser("replay", help="replay a recorded trace")
+    rep.add_argument("trace")
+    rep.add_argument("--speed", type=float, default=1.0, help=f"time compression, 1 to {MAX_SPEED:g}")
+    driver(rep)
+
+    syn = sub.add_parser("synth", help="send a synthetic mix at a fixed rate")
+    syn.add_argument("--mix", default=",".join(f"{m}={w}" for m, w in DEFAULT_MIX.items()))
+    syn.add_argument("--rate", type=float, default=50.0, help="calls per second")
+    syn.add_argument("--duration", type=float, default=10.0, help="seconds")
+    syn.add_argument("--seed", type=int, default=BENCH_SEED)
+    driver(syn)
+
+    ben = sub.add_parser("bench", help=f"fixed sweep over {', '.join(map(str, BENCH_RATES))} calls/s")
+    driver(ben)
+
+    args = parser.parse_args()
+    command = {"record": record, "replay": replay, "synth": synth, "bench": bench}[args.command]
+    try:
+        asyncio.run(command(args))
+    except ValueError as e:
+        print(f"error: {e}", file=sys.stderr)
+        return 2
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
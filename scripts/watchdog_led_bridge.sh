@@ -6,18 +6,23 @@ APP_PATH="${LED_APP_PATH:-/home/arduino/sentinel/arduino-app/sentinel}"
 STALE_SECONDS="${LED_WATCHDOG_STALE_SECONDS:-600}"
 FAILURE_THRESHOLD="${LED_WATCHDOG_FAILURE_THRESHOLD:-5}"
 COOLDOWN_SECONDS="${LED_WATCHDOG_COOLDOWN_SECONDS:-180}"
+# The app's own recovery ladder (reconnect, then MCU reset) gets this long before a restart.
+RECOVERY_GRACE_SECONDS="${LED_WATCHDOG_RECOVERY_GRACE_SECONDS:-120}"
 STATE_FILE="${LED_WATCHDOG_STATE_FILE:-/tmp/sentinel-led-watchdog.last_restart}"
 
 health_json="$(curl -fsS --max-time 8 "${API_URL}/api/led/bridge/health")"
 
 read -r should_restart reason stale_seconds consecutive_failures bridge_ok <<EOF
-$(python3 - "$health_json" "$STALE_SECONDS" "$FAILURE_THRESHOLD" <<'PY'
+$(python3 - "$health_json" "$STALE_SECONDS" "$FAILURE_THRESHOLD" "$RECOVERY_GRACE_SECONDS" <<'PY'
 import json
 import sys
+import time
 
 health = json.loads(sys.argv[1])
 stale_threshold = int(sys.argv[2])
 failure_threshold = int(sys.argv[3])
+recovery_grace = int(sys.argv[4])
+recovery = health.get("recovery") or {}
 
 stale_seconds = health.get("stale_seconds")
 consecutive_failures = int(health.get("consecutive_failures") or 0)
@@ -26,8 +31,11 @@ is_stale = bool(health.get("is_stale"))
 
 restart = False
 reason = "healthy"
+recovering = bool(recovery.get("in_progress")) and time.time() - (recovery.get("started_ts") or 0) < recovery_grace
 
-if is_stale:
+if recovering:
+    reason = "in_process_recovery"
+elif is_stale:
     restart = True
     reason = "stale"
 elif consecutive_failures >= failure_threshold and not bridge_ok:
@@ -46,6 +54,11 @@ PY
 )
 EOF
 
+if [[ "$should_restart" != "1" && "$reason" == "in_process_recovery" ]]; then
+    echo "LED app is recovering the bridge in-process; not restarting (failures=${consecutive_failures})."
+    exit 0
+fi
+
 if [[ "$should_restart" != "1" ]]; then
     echo "LED bridge healthy (stale_seconds=${stale_seconds}, failures=${consecutive_failures}, bridge_ok=${bridge_ok})."
     exit 0
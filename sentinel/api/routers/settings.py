@@ -1,18 +1,41 @@
 """Settings and LED API routes."""
 
 import inspect
+import logging
 import time
+from dataclasses import asdict
 from datetime import datetime, timezone
 from typing import Any
 
-from fastapi import APIRouter, Depends, HTTPException
+from fastapi import APIRouter, Depends, HTTPException, Request, Response
+from fastapi.responses import JSONResponse, StreamingResponse
 from typing_extensions import Annotated
 
 from sentinel.api.dependencies import CommonDependencies, get_common_deps
 from sentinel.broker import Broker
 from sentinel.led import LEDController
+from sentinel.led.anim import (
+    ANIM_PARAMS,
+    DEFAULT_ANIM_FRAME_MS,
+    DEFAULT_ANIM_SOURCE,
+    SUMMARY_PARAMS,
+    AnimError,
+    anim_chunks,
+    anim_program_id,
+    assemble,
+    encode_anim_image,
+    encode_anim_params,
+    summary_params,
+)
+from sentinel.led.events import display_events, format_display_event
+from sentinel.led.hub import HUB_UNIT_ID, build_hub_payloads, display_hub
+from sentinel.led.summary import get_led_summary as build_led_summary
+from sentinel.led.summary import etag_matches, led_summary_etag
+from sentinel.led.treemap import MATRIX_HEIGHT, MATRIX_WIDTH, build_holdings, encode_treemap_frame, layout_treemap
 from sentinel.settings import REMOVED_SETTINGS
 
+logger = logging.getLogger(__name__)
+
 router = APIRouter(prefix="/settings", tags=["settings"])
 STRATEGY_KEYS = {
     "strategy_min_opp_score",
@@ -59,6 +82,35 @@ PLANNER_SETTING_KEYS = {
 _led_controller: LEDController | None = None
 LED_BRIDGE_HEALTH_KEY = "led_bridge_health"
 LED_BRIDGE_STALE_AFTER_SEC = 600
+# Idle /api/led/events streams send a comment this often, so dead clients are noticed.
+LED_EVENTS_KEEPALIVE_SECONDS = 60
+# Renderers in the multi-mode MCU firmware, in LedModeId order (the mode.set id).
+LED_MODES = ("abacus", "orbital", "heatmap", "treemap", "anim")
+LED_ANIM_KEY = "led_anim"
+# Counters the firmware reports through diag/stats, forwarded by the UNO Q app.
+LED_MCU_STATS_FIELDS = (
+    "version",
+    "build_id",
+    "window_ms",
+    "loops_per_sec",
+    "render_min_us",
+    "render_mean_us",
+    "render_max_us",
+    "render_p99_us",
+    "show_mean_us",
+    "show_max_us",
+    "bridge_mean_us",
+    "bridge_max_us",
+    "irq_masked_us",
+    "rpc_decoded",
+    "rpc_rejected",
+    "stack_free_bytes",
+    "heap_free_bytes",
+    "frames_shown",
+    "frames_elided",
+)
+# Steps of the UNO Q app's bridge recovery ladder, cheapest first.
+LED_RECOVERY_STAGES = ("reconnect", "mcu_reset", "process_exit")
 
 
 def set_led_controller(controller: LEDController | None) -> None:
@@ -92,6 +144,40 @@ def _to_int(value: Any, default: int | None = None, minimum: int | None = None)
     return parsed
 
 
+def _normalize_mcu_stats(raw: Any) -> dict[str, int | None] | None:
+    if not isinstance(raw, dict):
+        return None
+    return {key: _to_int(raw.get(key), minimum=0) for key in LED_MCU_STATS_FIELDS}
+
+
+def _normalize_led_recovery(raw: Any) -> dict[str, Any] | None:
+    if not isinstance(raw, dict):
+        return None
+    started_ts = _to_int(raw.get("started_ts"))
+    recovered_stage = raw.get("recovered_stage")
+    stages = []
+    for stage in raw.get("stages") or []:
+        if not isinstance(stage, dict) or stage.get("stage") not in LED_RECOVERY_STAGES:
+            continue
+        stages.append(
+            {
+                "stage": stage["stage"],
+                "ok": bool(stage.get("ok", False)),
+                "duration_ms": _to_int(stage.get("duration_ms"), minimum=0),
+            }
+        )
+    trigger = raw.get("trigger")
+    return {
+        "trigger": str(trigger) if trigger else None,
+        "started_ts": started_ts,
+        "started_at": _to_iso_utc(started_ts),
+        "in_progress": bool(raw.get("in_progress", False)),
+        "recovered_stage": recovered_stage if recovered_stage in LED_RECOVERY_STAGES else None,
+        "time_to_recover_ms": _to_int(raw.get("time_to_recover_ms"), minimum=0),
+        "stages": stages,
+    }
+
+
 def _normalize_led_bridge_health(raw: Any) -> dict[str, Any]:
     now_ts = int(time.time())
     data = raw if isinstance(raw, dict) else {}
@@ -105,6 +191,10 @@ def _normalize_led_bridge_health(raw: Any) -> dict[str, Any]:
     last_error = data.get("last_error")
     watchdog_action = data.get("watchdog_action")
     app_instance = data.get("app_instance")
+    last_sent_seq = _to_int(data.get("last_sent_seq"), minimum=0)
+    last_acked_seq = _to_int(data.get("last_acked_seq"), minimum=0)
+    mcu_stats = _normalize_mcu_stats(data.get("mcu_stats"))
+    recovery = _normalize_led_recovery(data.get("recovery"))
 
     stale_seconds: int | None = None
     if last_success_ts is not None:
@@ -124,6 +214,10 @@ def _normalize_led_bridge_health(raw: Any) -> dict[str, Any]:
         "last_error": str(last_error) if last_error else None,
         "watchdog_action": str(watchdog_action) if watchdog_action else None,
         "app_instance": str(app_instance) if app_instance else None,
+        "last_sent_seq": last_sent_seq,
+        "last_acked_seq": last_acked_seq,
+        "mcu_stats": mcu_stats,
+        "recovery": recovery,
         "updated_at_ts": updated_at_ts,
         "updated_at": _to_iso_utc(updated_at_ts),
         "stale_seconds": stale_seconds,
@@ -271,6 +365,246 @@ async def set_led_enabled(data: dict) -> dict[str, bool]:
     return {"enabled": enabled}
 
 
+@led_router.get("/mode")
+async def get_led_mode() -> dict[str, Any]:
+    """Get the renderer the LED firmware should show."""
+    from sentinel.settings import Settings
+
+    settings = Settings()
+    mode = await settings.get("led_mode", LED_MODES[0])
+    if mode not in LED_MODES:
+        mode = LED_MODES[0]
+    return {"mode": mode, "mode_id": LED_MODES.index(mode), "modes": list(LED_MODES)}
+
+
+@led_router.put("/mode")
+async def set_led_mode(data: dict) -> dict[str, Any]:
+    """Select the LED renderer; the UNO Q app applies it with mode.set."""
+    from sentinel.settings import Settings
+
+    mode = data.get("mode")
+    if mode not in LED_MODES:
+        raise HTTPException(status_code=400, detail=f"'mode' must be one of: {', '.join(LED_MODES)}")
+    settings = Settings()
+    await settings.set("led_mode", mode)
+    # Hub units take the mode from the hub stream, so they all switch together.
+    display_events.publish("mode")
+    return {"mode": mode, "mode_id": LED_MODES.index(mode), "modes": list(LED_MODES)}
+
+
+@led_router.get("/treemap")
+async def get_led_treemap(deps: Annotated[CommonDependencies, Depends(get_common_deps)]) -> dict[str, Any]:
+    """Treemap layout for the LED matrix and its updateTreemap payload (hex)."""
+    from sentinel.planner import Planner
+
+    positions = await deps.db.get_all_positions()
+    try:
+        recommendations = await Planner().get_recommendations()
+    except Exception as e:
+        logger.warning(f"Treemap without recommendations: {e}")
+        recommendations = []
+
+    regions = layout_treemap(build_holdings(positions, recommendations))
+    return {
+        "width": MATRIX_WIDTH,
+        "height": MATRIX_HEIGHT,
+        "regions": [asdict(r) for r in regions],
+        "frame": encode_treemap_frame(regions).hex(),
+    }
+
+
+async def _get_led_anim_program() -> dict[str, Any]:
+    from sentinel.settings import Settings
+
+    stored = await Settings().get(LED_ANIM_KEY, None)
+    if not isinstance(stored, dict):
+        stored = {}
+    return {
+        "source": stored.get("source") or DEFAULT_ANIM_SOURCE,
+        "frame_ms": int(stored.get("frame_ms", DEFAULT_ANIM_FRAME_MS)),
+        "params": [int(v) for v in stored.get("params") or []],
+    }
+
+
+def _led_anim_body(program: dict[str, Any], summary: dict[str, Any]) -> dict[str, Any]:
+    image = encode_anim_image(assemble(program["source"]), program["frame_ms"])
+    first_free = len(SUMMARY_PARAMS)
+    params = {**summary_params(summary), **{first_free + i: v for i, v in enumerate(program["params"])}}
+    return {
+        **program,
+        "id": anim_program_id(image),
+        "image": image.hex(),
+        "chunks": [chunk.hex() for chunk in anim_chunks(image)],
+        "set": encode_anim_params(params).hex(),
+    }
+
+
+@led_router.get("/anim")
+async def get_led_anim(deps: Annotated[CommonDependencies, Depends(get_common_deps)]) -> dict[str, Any]:
+    """The anim-mode program with its anim.load chunks and anim.set payload (hex).
+
+    P0..P2 follow the display summary (see SUMMARY_PARAMS), P3.. are the stored params.
+    """
+    program = await _get_led_anim_program()
+    summary = await build_led_summary(deps.db, deps.broker, deps.settings, deps.currency)
+    try:
+        return _led_anim_body(program, summary)
+    except AnimError as e:
+        # Only reachable if the stored program predates a firmware change; fall back.
+        logger.warning(f"Stored LED anim program invalid, using the default: {e}")
+        default = {"source": DEFAULT_ANIM_SOURCE, "frame_ms": DEFAULT_ANIM_FRAME_MS, "params": []}
+        return _led_anim_body(default, summary)
+
+
+@led_router.put("/anim")
+async def set_led_anim(data: dict[str, Any]) -> dict[str, Any]:
+    """Store the anim-mode program: {source, frame_ms, params}. Omitted fields keep their value."""
+    from sentinel.settings import Settings
+
+    program = await _get_led_anim_program()
+    if "source" in data:
+        program["source"] = data["source"] or DEFAULT_ANIM_SOURCE
+    if "frame_ms" in data:
+        program["frame_ms"] = data["frame_ms"]
+    if "params" in data:
+        program["params"] = data["params"] or []
+    if not isinstance(program["source"], str) or not isinstance(program["frame_ms"], int):
+        raise HTTPException(status_code=400, detail="'source' must be a string and 'frame_ms' an integer")
+    free = ANIM_PARAMS - len(SUMMARY_PARAMS)
+    params = program["params"]
+    if not isinstance(params, list) or len(params) > free or not all(isinstance(v, int) for v in params):
+        raise HTTPException(status_code=400, detail=f"'params' must be a list of at most {free} integers")
+    try:
+        code = assemble(program["source"])
+        image = encode_anim_image(code, program["frame_ms"])
+    except AnimError as e:
+        raise HTTPException(status_code=400, detail=str(e)) from None
+    await Settings().set(LED_ANIM_KEY, program)
+    display_events.publish("anim")
+    return {**program, "id": anim_program_id(image), "code_bytes": len(code)}
+
+
+@led_router.get("/summary")
+async def get_led_summary(
+    request: Request,
+    deps: Annotated[CommonDependencies, Depends(get_common_deps)],
+) -> Response:
+    """Everything the UNO Q LED app shows, cached, with ETag / If-None-Match support."""
+    summary = await build_led_summary(deps.db, deps.broker, deps.settings, deps.currency)
+    etag = led_summary_etag(summary)
+    headers = {"ETag": etag, "Cache-Control": "no-cache"}
+    if etag_matches(request.headers.get("if-none-match", ""), etag):
+        return Response(status_code=304, headers=headers)
+    return JSONResponse(summary, headers=headers)
+
+
+@led_router.get("/events")
+async def stream_led_events(
+    request: Request,
+    deps: Annotated[CommonDependencies, Depends(get_common_deps)],
+) -> StreamingResponse:
+    """Display changes via Server-Sent Events (SSE).
+
+    Sends one "display" event on connect and another after each job that changes the
+    displays: {sources, etag, summary}, where summary is the /api/led/summary body.
+    """
+
+    async def event_generator():
+        with display_events.subscribe() as sub:
+            sources = ["connect"]
+            while not await request.is_disconnected():
+                if sources:
+                    summary = await build_led_summary(deps.db, deps.broker, deps.settings, deps.currency)
+                    yield format_display_event(sources, summary, led_summary_etag(summary))
+                else:
+                    yield ": keepalive\n\n"
+                sources = await sub.wait(timeout=LED_EVENTS_KEEPALIVE_SECONDS)
+
+    return StreamingResponse(
+        event_generator(),
+        media_type="text/event-stream",
+        headers={
+            "Cache-Control": "no-cache",
+            "Connection": "keep-alive",
+            "X-Accel-Buffering": "no",
+        },
+    )
+
+
+@led_router.get("/hub")
+async def get_led_hub() -> dict[str, Any]:
+    """Display hub status: the current generation and, per unit, delivery, ack and health."""
+    return display_hub.status()
+
+
+@led_router.get("/hub/stream")
+async def stream_led_hub(
+    request: Request,
+    unit: str,
+    deps: Annotated[CommonDependencies, Depends(get_common_deps)],
+) -> StreamingResponse:
+    """Display hub stream for one unit, via Server-Sent Events (SSE).
+
+    Registers `unit` and sends it the current bundle on connect, then each new
+    generation: the /api/led/events display event plus `generation` and `payloads`.
+    The bundle is built once per change however many units are connected.
+    """
+    if not HUB_UNIT_ID.match(unit):
+        raise HTTPException(status_code=400, detail="'unit' must be 1-64 letters, digits, '.', '_' or '-'")
+
+    async def build():
+        mode = await deps.settings.get("led_mode", LED_MODES[0])
+        mode_id = LED_MODES.index(mode) if mode in LED_MODES else 0
+        summary, payloads = await build_hub_payloads(deps.db, deps.broker, deps.settings, deps.currency, mode_id)
+        program = await _get_led_anim_program()
+        try:
+            payloads["anim"] = _led_anim_body(program, summary)
+        except AnimError:
+            default = {"source": DEFAULT_ANIM_SOURCE, "frame_ms": DEFAULT_ANIM_FRAME_MS, "params": []}
+            payloads["anim"] = _led_anim_body(default, summary)
+        return summary, payloads
+
+    async def event_generator():
+        with display_hub.connect(unit) as hub_unit, display_events.subscribe() as sub:
+            sources = ["connect"]
+            while not await request.is_disconnected():
+                bundle = await display_hub.current(build, sources)
+                # Always on connect: the unit may have restarted since its last delivery.
+                if sources == ["connect"] or bundle.generation != hub_unit.delivered_generation:
+                    yield bundle.event
+                    display_hub.delivered(hub_unit, bundle)
+                else:
+                    yield ": keepalive\n\n"
+                sources = await sub.wait(timeout=LED_EVENTS_KEEPALIVE_SECONDS)
+
+    return StreamingResponse(
+        event_generator(),
+        media_type="text/event-stream",
+        headers={
+            "Cache-Control": "no-cache",
+            "Connection": "keep-alive",
+            "X-Accel-Buffering": "no",
+        },
+    )
+
+
+@led_router.post("/hub/units/{unit_id}/ack")
+async def ack_led_hub(unit_id: str, data: dict[str, Any]) -> dict[str, Any]:
+    """Record what a unit applied: {generation, applied_seq, bridge_ok, mode_id, error}."""
+    hub_unit = display_hub.ack(unit_id, data)
+    if hub_unit is None:
+        raise HTTPException(status_code=404, detail=f"Unknown display unit '{unit_id}'")
+    return hub_unit.as_dict(time.time())
+
+
+@led_router.delete("/hub/units/{unit_id}")
+async def forget_led_hub_unit(unit_id: str) -> dict[str, Any]:
+    """Forget an offline unit."""
+    if not display_hub.forget(unit_id):
+        raise HTTPException(status_code=404, detail=f"No offline display unit '{unit_id}'")
+    return {"unit_id": unit_id, "removed": True}
+
+
 @led_router.post("/refresh")
 async def refresh_led_display() -> dict[str, Any]:
     """Force an immediate LED display refresh."""
@@ -303,6 +637,10 @@ async def set_led_bridge_health(data: dict[str, Any]) -> dict[str, Any]:
         "last_error": normalized["last_error"],
         "watchdog_action": normalized["watchdog_action"],
         "app_instance": normalized["app_instance"],
+        "last_sent_seq": normalized["last_sent_seq"],
+        "last_acked_seq": normalized["last_acked_seq"],
+        "mcu_stats": normalized["mcu_stats"],
+        "recovery": normalized["recovery"],
         "updated_at_ts": int(time.time()),
     }
 
@@ -13,6 +13,7 @@ from apscheduler.schedulers.asyncio import AsyncIOScheduler
 from apscheduler.triggers.interval import IntervalTrigger
 
 from sentinel.jobs import tasks
+from sentinel.led.events import job_completed
 
 logger = logging.getLogger(__name__)
 
@@ -409,6 +410,7 @@ async def _run_task(job_type: str, schedule: dict, skip_timing_check: bool = Fal
             await db.log_job_execution(job_type, job_type, "completed", None, duration_ms, 0)
 
         logger.info(f"Job {job_type} completed in {duration_ms}ms")
+        job_completed(job_type)
         return {"status": "completed", "duration_ms": duration_ms}
 
     except asyncio.TimeoutError:
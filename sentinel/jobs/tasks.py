@@ -14,6 +14,7 @@ from datetime import datetime, timedelta, timezone
 from pathlib import Path
 from typing import Any
 
+from sentinel.led.summary import invalidate_led_summary
 from sentinel.markets import get_open_market_symbols
 from sentinel.planner.models import TradeRecommendation
 from sentinel.planner.rebalance_rules import buy_rank_key
@@ -88,6 +89,7 @@ async def _fetch_historical_prices_in_chunks(
 async def sync_portfolio(portfolio) -> None:
     """Sync portfolio positions from broker."""
     await portfolio.sync()
+    invalidate_led_summary()
     logger.info("Portfolio sync complete")
 
 
@@ -112,6 +114,8 @@ async def sync_prices(db, broker, cache) -> None:
     if symbols and synced == 0:
         raise RuntimeError(f"Price sync returned no usable prices for {len(symbols)} securities")
 
+    # New price history changes what the planner recommends.
+    invalidate_led_summary()
     logger.info(f"Price sync complete: {synced}/{len(symbols)} securities updated")
 
 
@@ -127,6 +131,7 @@ async def sync_quotes(db, broker) -> None:
     quotes = await broker.get_quotes(symbols)
     if quotes:
         await db.update_quotes_bulk(quotes)
+        invalidate_led_summary()
         logger.info(f"Quote sync complete: {len(quotes)} securities")
     else:
         logger.warning("No quotes returned from broker")
@@ -764,6 +769,7 @@ async def forecast_run(db) -> None:
         await db.store_forecast_scores(scores)
         await db.finish_forecast_run(run_id, status="completed", model_version=payload.get("model_version"))
         await db.invalidate_planner_cache()
+        invalidate_led_summary()
         logger.info(
             "Forecast run complete: run=%s, symbols=%s, batches=%s, unusable=%s",
             run_id,
@@ -932,6 +938,7 @@ async def trading_execute(broker, db, planner, portfolio) -> None:
         },
     )
     await db.invalidate_planner_cache()
+    invalidate_led_summary()
 
 
 async def trading_rebalance(planner) -> None:
@@ -1064,6 +1071,7 @@ async def planning_refresh(db, planner, broker) -> None:
 
     # Clear planner-related caches
     cleared = await db.cache_clear("planner:")
+    invalidate_led_summary()
     logger.info(f"Cleared {cleared} planner cache entries")
 
     # Regenerate ideal portfolio (this will cache the result)
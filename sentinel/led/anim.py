@@ -0,0 +1,358 @@
+"""Assemble programs for the LED firmware's animation VM (anim mode).
+
+A program is a per-pixel colour function that the MCU runs for each of the 40
+NeoPixel shield pixels every frame. It is uploaded once, in anim.load chunks,
+and afterwards steered only through its eight parameters (anim.set), so a new
+effect costs one upload instead of a reflash or a stream of frames.
+
+Source is one instruction per line, `;` starts a comment and `name:` defines a
+label for JMP / JZ, which only jump forward:
+
+    LD X          ; column
+    PUSH 7
+    EQ
+    JZ lit
+    END           ; column 7 stays dark
+    lit:
+    LD P0
+    PUSH 0
+    PUSH 0
+    OUT           ; red = P0
+
+assemble() checks everything the firmware's anim_parse() checks (opcodes,
+operands, jump targets, stack depth, instruction budget), so a program that
+assembles here is never rejected on the MCU.
+
+See anim_vm.h in the SentinelLED firmware library for the instruction set and
+the image format.
+"""
+
+from __future__ import annotations
+
+import re
+from dataclasses import dataclass
+from typing import Any
+
+ANIM_MAGIC = 0x41  # "A"
+ANIM_VERSION = 1
+ANIM_HEADER_SIZE = 6
+ANIM_CODE_MAX = 192
+ANIM_MIN_FRAME_MS = 16
+ANIM_MAX_FRAME_MS = 1000  # the MCU render thread's longest sleep, well inside its watchdog
+ANIM_CHUNK_HEADER_SIZE = 4
+ANIM_CHUNK_MAX = 64
+ANIM_PARAMS = 8
+ANIM_VARS = 4
+ANIM_STACK_DEPTH = 8
+SHIELD_PIXELS = 40
+ANIM_FRAME_BUDGET = 4096
+ANIM_PIXEL_BUDGET = ANIM_FRAME_BUDGET // SHIELD_PIXELS
+
+# anim.load replies (AnimChunkResult).
+ANIM_CHUNK_REJECTED = 0
+ANIM_CHUNK_MORE = 1
+ANIM_CHUNK_COMPLETE = 2
+
+# AnimReg ids.
+REGISTERS = {
+    "X": 0,
+    "Y": 1,
+    "I": 2,
+    "T": 3,
+    **{f"V{i}": 4 + i for i in range(ANIM_VARS)},
+    **{f"P{i}": 8 + i for i in range(ANIM_PARAMS)},
+}
+_FIRST_VAR = REGISTERS["V0"]
+
+# OscWave ids (oscillator.h), the WAVE operand.
+WAVES = {"SINE": 0, "SAW_UP": 1, "SAW_DOWN": 2, "TRIANGLE": 3, "PULSE": 4, "BLINK": 5}
+
+
+@dataclass(frozen=True)
+class AnimOp:
+    code: int
+    pops: int
+    pushes: int
+    operand: str | None = None  # "i8", "i16", "reg", "var", "wave" or "label"
+
+    @property
+    def size(self) -> int:
+        return 1 + {None: 0, "i16": 2}.get(self.operand, 1)
+
+
+# AnimOp, mirroring anim_vm.h. PUSH is an assembler shorthand for PUSH8 / PUSH16.
+OPS = {
+    "END": AnimOp(0x00, 0, 0),
+    "PUSH8": AnimOp(0x01, 0, 1, "i8"),
+    "PUSH16": AnimOp(0x02, 0, 1, "i16"),
+    "LD": AnimOp(0x03, 0, 1, "reg"),
+    "ST": AnimOp(0x04, 1, 0, "var"),
+    "DUP": AnimOp(0x05, 1, 2),
+    "DROP": AnimOp(0x06, 1, 0),
+    "SWAP": AnimOp(0x07, 2, 2),
+    **{
+        name: AnimOp(0x10 + i, 2, 1)
+        for i, name in enumerate(
+            ("ADD", "SUB", "MUL", "DIV", "MOD", "MIN", "MAX", "AND", "OR", "XOR", "SHL", "SHR", "LT", "EQ", "MULQ")
+        )
+    },
+    "NEG": AnimOp(0x20, 1, 1),
+    "ABS": AnimOp(0x21, 1, 1),
+    "SIN": AnimOp(0x22, 1, 1),
+    "WAVE": AnimOp(0x23, 1, 1, "wave"),
+    "CLAMP8": AnimOp(0x24, 1, 1),
+    "PHASE": AnimOp(0x25, 1, 1),
+    "JMP": AnimOp(0x30, 0, 0, "label"),
+    "JZ": AnimOp(0x31, 1, 0, "label"),
+    "OUT": AnimOp(0x3F, 3, 0),
+}
+_BY_CODE = {op.code: op for op in OPS.values()}
+_EXITS = {OPS["END"].code, OPS["OUT"].code, OPS["JMP"].code}
+
+_LABEL = re.compile(r"^([A-Za-z_]\w*):$")
+
+# Parameters fed from the /api/led/summary body; P3..P7 are free for the program.
+SUMMARY_PARAMS = ("return_pct", "has_recs", "broker_connected")
+
+# Portfolio glow: green above water and red below, brighter the further from
+# zero, with a slow ripple; a blue column sweeps while trades are pending, and
+# everything runs at half brightness while the broker is offline.
+DEFAULT_ANIM_SOURCE = """\
+; P0 return_pct, P1 has_recs, P2 broker_connected
+    LD P0
+    ABS
+    PUSH 8
+    MUL
+    PUSH 60
+    ADD             ; base level: 60 + 8 per % of return
+    PUSH 3000
+    PHASE
+    LD X
+    PUSH 4096
+    MUL
+    ADD
+    LD Y
+    PUSH 6553
+    MUL
+    ADD
+    SIN
+    PUSH 10
+    SHR             ; ripple, -32 .. 31
+    ADD
+    CLAMP8
+    PUSH 1
+    LD P2
+    SUB
+    SHR             ; halved while the broker is offline
+    ST V0
+    LD P1
+    JZ colour
+    PUSH 2000
+    PHASE
+    PUSH 13
+    SHR             ; sweep column, 0 .. 7
+    LD X
+    EQ
+    PUSH 160
+    MUL
+    ST V1
+colour:
+    LD P0
+    PUSH 0
+    LT
+    ST V2           ; 1 below water
+    LD V0
+    LD V2
+    MUL             ; red
+    LD V0
+    PUSH 1
+    LD V2
+    SUB
+    MUL             ; green
+    LD V1           ; blue
+    OUT
+"""
+DEFAULT_ANIM_FRAME_MS = 40
+
+
+class AnimError(ValueError):
+    """A program the firmware would reject."""
+
+
+def _parse_int(text: str, line_no: int) -> int:
+    try:
+        return int(text, 0)
+    except ValueError:
+        raise AnimError(f"line {line_no}: expected a number, got {text!r}") from None
+
+
+def assemble(source: str) -> bytes:
+    """Assemble source into VM code, verified as anim_parse() would."""
+    # Pass 1: resolve instruction sizes and label offsets.
+    lines: list[tuple[int, str, str | None]] = []
+    labels: dict[str, int] = {}
+    offset = 0
+    for line_no, raw in enumerate(source.splitlines(), start=1):
+        text = raw.split(";", 1)[0].strip()
+        if not text:
+            continue
+        label = _LABEL.match(text)
+        if label:
+            if label.group(1) in labels:
+                raise AnimError(f"line {line_no}: duplicate label {label.group(1)!r}")
+            labels[label.group(1)] = offset
+            continue
+        parts = text.split()
+        name = parts[0].upper()
+        if len(parts) > 2:
+            raise AnimError(f"line {line_no}: too many operands")
+        arg = parts[1] if len(parts) == 2 else None
+        if name == "PUSH":
+            value = _parse_int(arg or "", line_no)
+            name = "PUSH8" if -128 <= value <= 127 else "PUSH16"
+        op = OPS.get(name)
+        if op is None:
+            raise AnimError(f"line {line_no}: unknown instruction {parts[0]!r}")
+        if (arg is None) != (op.operand is None):
+            raise AnimError(f"line {line_no}: {name} takes {'an' if op.operand else 'no'} operand")
+        lines.append((line_no, name, arg))
+        offset += op.size
+
+    # Pass 2: encode.
+    code = bytearray()
+    for line_no, name, arg in lines:
+        op = OPS[name]
+        code.append(op.code)
+        end = len(code) + op.size - 1
+        if op.operand in ("i8", "i16"):
+            value = _parse_int(arg, line_no)
+            bits = 8 if op.operand == "i8" else 16
+            if not -(1 << (bits - 1)) <= value < (1 << (bits - 1)):
+                raise AnimError(f"line {line_no}: {value} does not fit {name}")
+            code += value.to_bytes(bits // 8, "little", signed=True)
+        elif op.operand in ("reg", "var"):
+            reg = REGISTERS.get(arg.upper())
+            if reg is None:
+                raise AnimError(f"line {line_no}: unknown register {arg!r}")
+            code.append(reg)
+        elif op.operand == "wave":
+            wave = WAVES.get(arg.upper())
+            if wave is None:
+                raise AnimError(f"line {line_no}: unknown wave {arg!r}")
+            code.append(wave)
+        elif op.operand == "label":
+            if arg not in labels:
+                raise AnimError(f"line {line_no}: unknown label {arg!r}")
+            skip = labels[arg] - end
+            if skip < 0:
+                raise AnimError(f"line {line_no}: {name} {arg} jumps backwards")
+            if skip > 255:
+                raise AnimError(f"line {line_no}: {name} {arg} jumps too far")
+            code.append(skip)
+    verify(bytes(code))
+    return bytes(code)
+
+
+def _fail(offset: int, message: str) -> AnimError:
+    return AnimError(f"at byte {offset}: {message}")
+
+
+def verify(code: bytes) -> int:
+    """Check code the way anim_parse() does; returns its instruction count."""
+    if len(code) > ANIM_CODE_MAX:
+        raise AnimError(f"{len(code)} bytes of code, at most {ANIM_CODE_MAX}")
+    join: dict[int, int] = {}  # jump target -> stack depth on arrival
+    depth: int | None = 0  # None while unreachable
+    steps = 0
+    pc = 0
+    while pc < len(code):
+        if pc in join:
+            if depth is not None and depth != join[pc]:
+                raise _fail(pc, f"stack depth {depth} here, {join[pc]} from a jump")
+            depth = join[pc]
+        op = _BY_CODE.get(code[pc])
+        if op is None:
+            raise _fail(pc, f"unknown opcode 0x{code[pc]:02x}")
+        end = pc + op.size
+        if end > len(code):
+            raise _fail(pc, "operand past the end of the code")
+        arg = code[pc + 1] if op.operand else 0
+        if op.operand == "reg" and arg >= len(REGISTERS):
+            raise _fail(pc, f"no register {arg}")
+        if op.operand == "var" and not _FIRST_VAR <= arg < _FIRST_VAR + ANIM_VARS:
+            raise _fail(pc, f"register {arg} is not writable")
+        if op.operand == "wave" and arg >= len(WAVES):
+            raise _fail(pc, f"no wave {arg}")
+        steps += 1
+        if steps > ANIM_PIXEL_BUDGET:
+            raise _fail(pc, f"more than {ANIM_PIXEL_BUDGET} instructions per pixel")
+        if depth is not None:
+            if depth < op.pops:
+                raise _fail(pc, "stack underflow")
+            depth += op.pushes - op.pops
+            if depth > ANIM_STACK_DEPTH:
+                raise _fail(pc, f"stack deeper than {ANIM_STACK_DEPTH}")
+            if op.operand == "label":
+                target = end + arg
+                if target > len(code):
+                    raise _fail(pc, "jump past the end of the code")
+                if join.get(target, depth) != depth:
+                    raise _fail(pc, "jump target reached with another stack depth")
+                join[target] = depth
+            if op.code in _EXITS:
+                depth = None
+        for b in range(pc + 1, end):
+            if b in join:
+                raise _fail(b, "jump into an operand")
+        pc = end
+    return steps
+
+
+def crc16_ccitt(data: bytes) -> int:
+    """CRC-16/CCITT-FALSE, matching crc16_ccitt() in the SentinelLED library."""
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def encode_anim_image(code: bytes, frame_ms: int) -> bytes:
+    """The anim.load image for code; frame_ms 0 draws only on changes."""
+    verify(code)
+    if frame_ms != 0 and not ANIM_MIN_FRAME_MS <= frame_ms <= ANIM_MAX_FRAME_MS:
+        raise AnimError(f"frame_ms must be 0 or {ANIM_MIN_FRAME_MS}..{ANIM_MAX_FRAME_MS}")
+    body = bytes([ANIM_MAGIC, ANIM_VERSION]) + frame_ms.to_bytes(2, "little") + len(code).to_bytes(2, "little") + code
+    return body + crc16_ccitt(body).to_bytes(2, "little")
+
+
+def anim_program_id(image: bytes) -> int:
+    """The id anim.s reports once image is loaded."""
+    return crc16_ccitt(image)
+
+
+def anim_chunks(image: bytes, size: int = ANIM_CHUNK_MAX) -> list[bytes]:
+    """Split image into anim.load chunks: [offset u16, total u16, bytes]."""
+    total = len(image)
+    return [
+        offset.to_bytes(2, "little") + total.to_bytes(2, "little") + image[offset : offset + size]
+        for offset in range(0, total, size)
+    ]
+
+
+def encode_anim_params(params: dict[int, int]) -> bytes:
+    """anim.set payload: [index, int16 LE] per parameter, values clamped to int16."""
+    out = bytearray()
+    for index, value in sorted(params.items()):
+        if not 0 <= index < ANIM_PARAMS:
+            raise AnimError(f"no parameter P{index}")
+        out.append(index)
+        out += max(-32768, min(32767, int(value))).to_bytes(2, "little", signed=True)
+    return bytes(out)
+
+
+def summary_params(summary: dict[str, Any]) -> dict[int, int]:
+    """P0..P2 from a /api/led/summary body, see SUMMARY_PARAMS."""
+    return {i: int(summary.get(name) or 0) for i, name in enumerate(SUMMARY_PARAMS)}
@@ -4,16 +4,26 @@ The UNO Q runs arduino-router as a MsgPack-RPC router over a UNIX socket
 (`/var/run/arduino-router.sock` by default). MCU sketches use Arduino_RouterBridge
 to call methods through the router; Linux-side processes can register and serve
 methods by calling `$/register`.
+
+`UnixMsgpackRpc`/`serve_forever` are the blocking, one-message-at-a-time helpers.
+`AsyncMsgpackRpc` multiplexes one router connection: outgoing calls are matched
+to responses through a pending table keyed by msgid, and incoming requests are
+dispatched concurrently, so a slow handler never holds up other traffic.
 """
 
 from __future__ import annotations
 
+import asyncio
+import inspect
+import logging
 import socket
 from dataclasses import dataclass
-from typing import Any, Callable, Final
+from typing import Any, Awaitable, Callable, Final, Union
 
 from sentinel.led import msgpack_lite as msgpack
 
+logger = logging.getLogger(__name__)
+
 REQUEST: Final[int] = 0
 RESPONSE: Final[int] = 1
 NOTIFY: Final[int] = 2
@@ -28,13 +38,20 @@ class RpcError(Exception):
         return f"RpcError(code={self.code}, message={self.message})"
 
 
+def _rpc_error(err: Any) -> RpcError:
+    # Convention: [code, message]
+    if isinstance(err, list) and len(err) >= 2:
+        return RpcError(int(err[0]), str(err[1]))
+    return RpcError(0xFF, str(err))
+
+
 class UnixMsgpackRpc:
     """A small, blocking MsgPack-RPC connection over a UNIX stream socket."""
 
     def __init__(self, sock_path: str):
         self._sock_path = sock_path
         self._sock: socket.socket | None = None
-        self._unpacker: msgpack.Unpacker | None = None
+        self._unpacker: msgpack.StreamUnpacker | None = None
         self._next_id = 1
 
     def connect(self) -> None:
@@ -42,7 +59,7 @@ class UnixMsgpackRpc:
         s.connect(self._sock_path)
         s.settimeout(1.0)
         self._sock = s
-        self._unpacker = msgpack.Unpacker()
+        self._unpacker = msgpack.StreamUnpacker(zero_copy=False)
 
     def close(self) -> None:
         if self._sock is not None:
@@ -83,10 +100,7 @@ class UnixMsgpackRpc:
                 continue
             err = msg[2]
             if err is not None:
-                # Convention: [code, message]
-                if isinstance(err, list) and len(err) >= 2:
-                    raise RpcError(int(err[0]), str(err[1]))
-                raise RpcError(0xFF, str(err))
+                raise _rpc_error(err)
             return msg[3]
 
 
@@ -132,3 +146,190 @@ def serve_forever(
         else:
             # Ignore responses (we're acting as a server).
             continue
+
+
+Handler = Callable[[list[Any]], Union[Any, Awaitable[Any]]]
+
+
+class AsyncMsgpackRpc:
+    """Multiplexed MsgPack-RPC connection over a UNIX stream socket.
+
+    Any number of `call()`s may be outstanding at once. Incoming requests and
+    notifications for methods added with `add_method()` run as separate tasks,
+    at most `max_concurrency` at a time. Plain functions run in the default
+    executor so they cannot stall the read loop; coroutine functions are
+    awaited directly. At most `max_backlog` of them may be waiting or running;
+    past that, requests get a "busy" error reply and notifications are dropped.
+
+    A stream that fails to decode ends the connection like a disconnect does.
+    """
+
+    def __init__(self, sock_path: str, *, max_concurrency: int = 8, max_backlog: int = 64):
+        self._sock_path = sock_path
+        self._reader: asyncio.StreamReader | None = None
+        self._writer: asyncio.StreamWriter | None = None
+        self._write_lock = asyncio.Lock()
+        self._pending: dict[int, asyncio.Future[Any]] = {}
+        self._methods: dict[str, Handler] = {}
+        self._handlers = asyncio.Semaphore(max_concurrency)
+        self._tasks: set[asyncio.Task[None]] = set()
+        self._max_backlog = max_backlog
+        self._read_task: asyncio.Task[None] | None = None
+        self._next_id = 1
+
+    @property
+    def connected(self) -> bool:
+        return self._read_task is not None and not self._read_task.done()
+
+    async def connect(self) -> None:
+        self._reader, self._writer = await asyncio.open_unix_connection(self._sock_path)
+        self._read_task = asyncio.create_task(self._read_loop())
+
+    async def close(self) -> None:
+        if self._read_task is not None:
+            self._read_task.cancel()
+            try:
+                await self._read_task
+            except (asyncio.CancelledError, ConnectionError, OSError):
+                pass
+            self._read_task = None
+        for task in list(self._tasks):
+            task.cancel()
+        if self._writer is not None:
+            self._writer.close()
+            try:
+                await self._writer.wait_closed()
+            except (ConnectionError, OSError):
+                pass
+            self._writer = None
+            self._reader = None
+        self._fail_pending(ConnectionError("RPC socket closed"))
+
+    def add_method(self, method: str, handler: Handler) -> None:
+        """Serve `method` locally. Use `register()` to announce it to the router."""
+        self._methods[method] = handler
+
+    async def register(self, *methods: str) -> None:
+        for method in methods:
+            await self.call("$/register", method)
+
+    async def call(self, method: str, *params: Any, timeout: float | None = None) -> Any:
+        msgid = self._next_id
+        self._next_id = (self._next_id + 1) & 0xFFFFFFFF or 1
+        fut: asyncio.Future[Any] = asyncio.get_running_loop().create_future()
+        self._pending[msgid] = fut
+        try:
+            await self._send([REQUEST, msgid, method, list(params)])
+            return await asyncio.wait_for(fut, timeout)
+        finally:
+            self._pending.pop(msgid, None)
+
+    async def notify(self, method: str, *params: Any) -> None:
+        await self._send([NOTIFY, method, list(params)])
+
+    async def serve_forever(self) -> None:
+        """Block until the connection drops; re-raises the read loop's error."""
+        if self._read_task is None:
+            raise RuntimeError("RPC socket not connected")
+        await self._read_task
+
+    async def _send(self, msg: list[Any]) -> None:
+        if self._writer is None:
+            raise RuntimeError("RPC socket not connected")
+        if not self.connected and self._read_task is not None:
+            raise ConnectionError("RPC socket closed")
+        data = msgpack.packb(msg)
+        async with self._write_lock:
+            self._writer.write(data)
+            await self._writer.drain()
+
+    def _fail_pending(self, exc: BaseException) -> None:
+        for fut in self._pending.values():
+            if not fut.done():
+                fut.set_exception(exc)
+        self._pending.clear()
+
+    async def _read_loop(self) -> None:
+        assert self._reader is not None
+        unpacker = msgpack.StreamUnpacker(zero_copy=False)
+        try:
+            while True:
+                data = await self._reader.read(4096)
+                if not data:
+                    raise ConnectionError("RPC socket closed")
+                unpacker.feed(data)
+                for msg in unpacker:
+                    self._dispatch(msg)
+        except (ConnectionError, OSError) as e:
+            self._fail_pending(e if isinstance(e, ConnectionError) else ConnectionError(str(e)))
+            raise
+        except Exception as e:
+            # Past a corrupt frame the stream cannot be resynchronised: drop the connection.
+            logger.warning(f"RPC stream decode failed, closing: {e}")
+            error = ConnectionError(f"RPC stream corrupt: {e}")
+            self._fail_pending(error)
+            if self._writer is not None:
+                self._writer.close()
+            raise error from e
+
+    def _dispatch(self, msg: Any) -> None:
+        if not isinstance(msg, list) or not msg:
+            return
+        msgtype = msg[0]
+        if msgtype == RESPONSE and len(msg) == 4:
+            fut = self._pending.get(msg[1])
+            if fut is None or fut.done():
+                return
+            if msg[2] is not None:
+                fut.set_exception(_rpc_error(msg[2]))
+            else:
+                fut.set_result(msg[3])
+        elif msgtype == REQUEST and len(msg) in (3, 4):
+            params = msg[3] if len(msg) == 4 else []
+            if isinstance(msg[2], str) and isinstance(params, list):
+                if self._backlog_full():
+                    self._reply_now([RESPONSE, msg[1], [0xFF, f"busy: {self._max_backlog} requests pending"], None])
+                else:
+                    self._spawn(self._handle(msg[1], msg[2], params))
+        elif msgtype == NOTIFY and len(msg) in (2, 3):
+            params = msg[2] if len(msg) == 3 else []
+            if isinstance(msg[1], str) and isinstance(params, list) and msg[1] in self._methods:
+                if self._backlog_full():
+                    logger.warning(f"RPC backlog full, dropping notification {msg[1]!r}")
+                else:
+                    self._spawn(self._handle(None, msg[1], params))
+
+    def _backlog_full(self) -> bool:
+        return len(self._tasks) >= self._max_backlog
+
+    def _reply_now(self, resp: list[Any]) -> None:
+        # One synchronous write cannot interleave with _send()'s, so the lock is not needed.
+        if self._writer is not None:
+            self._writer.write(msgpack.packb(resp))
+
+    def _spawn(self, coro: Awaitable[None]) -> None:
+        task = asyncio.ensure_future(coro)
+        self._tasks.add(task)
+        task.add_done_callback(self._tasks.discard)
+
+    async def _handle(self, msgid: int | None, method: str, params: list[Any]) -> None:
+        handler = self._methods.get(method)
+        async with self._handlers:
+            if handler is None:
+                resp = [RESPONSE, msgid, [0xFF, f"unknown method: {method}"], None]
+            else:
+                try:
+                    if inspect.iscoroutinefunction(handler):
+                        result = await handler(params)
+                    else:
+                        result = await asyncio.get_running_loop().run_in_executor(None, handler, params)
+                    resp = [RESPONSE, msgid, None, result]
+                except Exception as e:
+                    logger.warning(f"RPC handler {method!r} failed: {e}")
+                    resp = [RESPONSE, msgid, [0xFF, str(e)], None]
+        if msgid is None:
+            return
+        try:
+            await self._send(resp)
+        except (ConnectionError, OSError, RuntimeError):
+            pass
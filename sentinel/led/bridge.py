@@ -2,9 +2,11 @@
 MCU communication bridge for LED trade display.
 
 Wraps the Arduino UNO Q Bridge API to send trade text to the MCU.
-The MCU displays scrolling text one trade at a time.
+The MCU keeps its own message queue and scrolls one trade at a time, so
+sending returns as soon as the text is queued.
 """
 
+import asyncio
 import logging
 
 logger = logging.getLogger(__name__)
@@ -14,9 +16,14 @@ class LEDBridge:
     """Communication bridge to Arduino UNO Q MCU.
 
     Sends trade text via Bridge RPC. The MCU scrolls each
-    trade message one at a time.
+    trade message one at a time from its queue.
     """
 
+    # Bridge calls only copy the text into the MCU queue.
+    CALL_TIMEOUT = 2
+    # Messages the MCU queue holds (TEXT_QUEUE_LEN in text_scroller.h).
+    QUEUE_LENGTH = 8
+
     def __init__(self):
         self._connected = False
         self._bridge = None
@@ -47,31 +54,60 @@ class LEDBridge:
         """Check if bridge is connected."""
         return self._connected
 
+    async def _call(self, method: str, *args):
+        # Bridge.call is synchronous; keep it off the event loop.
+        return await asyncio.to_thread(self._bridge.call, method, *args, timeout=self.CALL_TIMEOUT)
+
     async def set_text(self, text: str) -> bool:
-        """Send text to display on LED matrix.
+        """Replace the MCU's text queue with one message.
 
-        The MCU will scroll this text from right to left.
-        This call blocks until the scroll completes.
+        Returns once the text is queued; the MCU scrolls it right to left.
 
         Args:
             text: Text to display (e.g., "SELL $1,874.62 (51%) BYD.285.AS")
 
         Returns:
-            True if text sent successfully, False otherwise.
+            True if the MCU queued the text, False otherwise.
+        """
+        return await self._send_text("setText", text)
+
+    async def queue_text(self, text: str) -> bool:
+        """Append a message to the MCU's text queue.
+
+        Returns:
+            True if the MCU queued the text, False if the queue was full
+            or the call failed.
         """
+        return await self._send_text("queueText", text)
+
+    async def _send_text(self, method: str, text: str) -> bool:
         if not self._connected or self._bridge is None:
             return False
 
         try:
-            # Timeout needs to be long enough for scroll to complete
-            # Scroll takes ~5-7 seconds per message
-            self._bridge.call("setText", text, timeout=15)
-            logger.debug(f"Sent text to MCU: {text}")
-            return True
+            queued = await self._call(method, text)
+            logger.debug(f"Queued text on MCU: {text}")
+            return queued is not False
         except Exception as e:
             logger.error(f"Failed to send text to MCU: {e}")
             return False
 
+    async def text_status(self) -> dict | None:
+        """Get the MCU text queue counters.
+
+        Returns:
+            Dict with pending, shown and dropped counts, or None if unavailable.
+        """
+        if not self._connected or self._bridge is None:
+            return None
+
+        try:
+            pending, shown, dropped = await self._call("text.s")
+            return {"pending": int(pending), "shown": int(shown), "dropped": int(dropped)}
+        except Exception as e:
+            logger.error(f"Failed to read MCU text status: {e}")
+            return None
+
     async def clear(self) -> bool:
         """Clear the LED display.
 
@@ -82,7 +118,7 @@ class LEDBridge:
             return False
 
         try:
-            self._bridge.call("clear", timeout=2)
+            await self._call("clear")
             logger.debug("Cleared LED display")
             return True
         except Exception as e:
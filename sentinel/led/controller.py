@@ -1,8 +1,8 @@
 """
 LED Controller - Displays trade recommendations as scrolling text.
 
-Fetches trade recommendations from the Planner and displays them
-one at a time on the LED matrix as scrolling text.
+Fetches trade recommendations from the Planner and queues them on the
+MCU, which scrolls them one at a time on the LED matrix.
 """
 
 import asyncio
@@ -25,12 +25,15 @@ class LEDController:
     """
 
     SYNC_INTERVAL = 300  # Refetch recommendations every 5 minutes
+    TEXT_POLL_INTERVAL = 15  # Check text.s this often while trades wait for queue space
 
     def __init__(self):
         self._planner = Planner()
         self._settings = Settings()
         self._bridge = LEDBridge()
         self._trades: list[Trade] = []
+        # Messages that did not fit the MCU queue, sent as it frees slots
+        self._pending: list[str] = []
         self._running = False
         self._task: Optional[asyncio.Task] = None
 
@@ -52,9 +55,15 @@ class LEDController:
         logger.info("LED controller starting")
         self._running = True
 
-        # Main loop: fetch recommendations and display them
+        # Main loop: fetch recommendations and queue them
         while self._running:
-            await self._fetch_and_display()
+            try:
+                await self._fetch_and_display()
+            except Exception as e:
+                logger.error(f"Error in LED display loop: {e}")
+                await asyncio.sleep(60)  # Retry after 1 minute on error
+                continue
+            await self._wait_and_top_up(self.SYNC_INTERVAL)
 
     def stop(self) -> None:
         """Stop the LED controller."""
@@ -62,62 +71,87 @@ class LEDController:
         logger.info("LED controller stopped")
 
     async def _fetch_and_display(self) -> None:
-        """Fetch trade recommendations and display them."""
-        try:
-            recommendations = await self._planner.get_recommendations()
-
-            if not recommendations:
-                logger.debug("No trade recommendations to display")
-                await asyncio.sleep(self.SYNC_INTERVAL)
-                return
-
-            # Convert recommendations to Trade objects
-            self._trades = []
-            for rec in recommendations:
-                if rec.action == "sell":
-                    # Calculate sell percentage
-                    if rec.current_value_eur > 0:
-                        sell_pct = (abs(rec.value_delta_eur) / rec.current_value_eur) * 100
-                    else:
-                        sell_pct = 100
-                    trade = Trade(
-                        action="SELL",
-                        amount=abs(rec.value_delta_eur),
-                        symbol=rec.symbol,
-                        sell_pct=sell_pct,
-                    )
-                else:
-                    trade = Trade(
-                        action="BUY",
-                        amount=rec.value_delta_eur,
-                        symbol=rec.symbol,
-                    )
-                self._trades.append(trade)
-
-            logger.info(f"Displaying {len(self._trades)} trade recommendations")
-
-            # Display each trade one at a time
-            for trade in self._trades:
-                if not self._running:
-                    break
-
-                text = trade.to_display_string()
-                await self._bridge.set_text(text)
+        """Fetch trade recommendations and queue them on the MCU.
 
-                # Small delay between trades
-                await asyncio.sleep(1)
+        Returns as soon as the messages are queued; the MCU scrolls them.
+        """
+        recommendations = await self._planner.get_recommendations()
+        self._pending = []
 
-            # Wait before fetching new recommendations
-            if self._running:
-                await asyncio.sleep(self.SYNC_INTERVAL)
+        if not recommendations:
+            logger.debug("No trade recommendations to display")
+            return
 
-        except Exception as e:
-            logger.error(f"Error in LED display loop: {e}")
-            await asyncio.sleep(60)  # Retry after 1 minute on error
+        # Convert recommendations to Trade objects
+        self._trades = []
+        for rec in recommendations:
+            if rec.action == "sell":
+                # Calculate sell percentage
+                if rec.current_value_eur > 0:
+                    sell_pct = (abs(rec.value_delta_eur) / rec.current_value_eur) * 100
+                else:
+                    sell_pct = 100
+                trade = Trade(
+                    action="SELL",
+                    amount=abs(rec.value_delta_eur),
+                    symbol=rec.symbol,
+                    sell_pct=sell_pct,
+                )
+            else:
+                trade = Trade(
+                    action="BUY",
+                    amount=rec.value_delta_eur,
+                    symbol=rec.symbol,
+                )
+            self._trades.append(trade)
+
+        logger.info(f"Displaying {len(self._trades)} trade recommendations")
+
+        # The first message replaces whatever is still queued from the last
+        # refresh; the rest are appended until the MCU queue is full, and what
+        # does not fit waits for _top_up().
+        texts = [trade.to_display_string() for trade in self._trades]
+        self._pending = texts[self._bridge.QUEUE_LENGTH :]
+        for i, text in enumerate(texts[: self._bridge.QUEUE_LENGTH]):
+            send = self._bridge.set_text if i == 0 else self._bridge.queue_text
+            if not await send(text):
+                self._pending = texts[i:]
+                break
+        if self._pending:
+            logger.info(f"MCU text queue full; {len(self._pending)} trade(s) wait for free slots")
+
+    async def _top_up(self) -> None:
+        """Queue waiting messages into the slots text.s reports free."""
+        status = await self._bridge.text_status()
+        if status is None:
+            return
+        free = self._bridge.QUEUE_LENGTH - status["pending"]
+        while free > 0 and self._pending:
+            if not await self._bridge.queue_text(self._pending[0]):
+                break
+            self._pending.pop(0)
+            free -= 1
+
+    async def _wait_and_top_up(self, seconds: float) -> None:
+        """Sleep until the next refresh, topping up the MCU queue while messages wait."""
+        loop = asyncio.get_running_loop()
+        deadline = loop.time() + seconds
+        while self._pending and self._running:
+            remaining = deadline - loop.time()
+            if remaining <= 0:
+                return
+            await asyncio.sleep(min(self.TEXT_POLL_INTERVAL, remaining))
+            await self._top_up()
+        remaining = deadline - loop.time()
+        if remaining > 0:
+            await asyncio.sleep(remaining)
 
     async def force_refresh(self) -> None:
         """Force an immediate refresh of trade recommendations."""
-        await self._fetch_and_display()
+        try:
+            await self._fetch_and_display()
+        except Exception as e:
+            logger.error(f"Error refreshing LED display: {e}")
 
     @property
     def is_running(self) -> bool:
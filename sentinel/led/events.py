@@ -0,0 +1,123 @@
+"""
+Display change events for the LED clients, streamed as GET /api/led/events.
+
+The job runner calls job_completed() after a job that changes what the
+displays show. Every open stream is then woken and sends one "display" event,
+so the abacus app and the heatmap router update within a second instead of
+at their next poll. Nothing is sent while nothing changes, apart from an
+occasional keepalive comment.
+
+Changes are coalesced per subscriber: a slow client that misses several
+jobs gets one event naming all their sources, never a backlog.
+
+Usage:
+    from sentinel.led.events import display_events
+
+    with display_events.subscribe() as sub:
+        sources = await sub.wait(timeout=60)
+"""
+
+import asyncio
+import json
+from contextlib import contextmanager
+from typing import Any, Iterator
+
+# Job type -> the display input it changes.
+DISPLAY_JOB_SOURCES = {
+    "sync:portfolio": "portfolio",
+    "sync:quotes": "prices",
+    "sync:prices": "prices",
+    "planning:refresh": "planner",
+    "trading:execute": "planner",
+    "forecast:run": "planner",
+}
+
+
+class DisplaySubscriber:
+    """One open stream: the sources changed since it last sent an event."""
+
+    def __init__(self) -> None:
+        self._pending: set[str] = set()
+        self._wake = asyncio.Event()
+
+    def notify(self, source: str) -> None:
+        self._pending.add(source)
+        self._wake.set()
+
+    async def wait(self, timeout: float) -> list[str]:
+        """Changed sources, sorted; empty if nothing changed within timeout."""
+        try:
+            await asyncio.wait_for(self._wake.wait(), timeout=timeout)
+        except asyncio.TimeoutError:
+            return []
+        self._wake.clear()
+        sources = sorted(self._pending)
+        self._pending.clear()
+        return sources
+
+
+class DisplayEvents:
+    """Fan-out of display changes to the open streams. Event-loop thread only."""
+
+    def __init__(self) -> None:
+        self._subscribers: set[DisplaySubscriber] = set()
+        # Publishes so far; lets a cache of display payloads tell it is out of date.
+        self.version = 0
+
+    @property
+    def subscriber_count(self) -> int:
+        return len(self._subscribers)
+
+    def publish(self, source: str) -> None:
+        self.version += 1
+        for sub in self._subscribers:
+            sub.notify(source)
+
+    @contextmanager
+    def subscribe(self) -> Iterator[DisplaySubscriber]:
+        sub = DisplaySubscriber()
+        self._subscribers.add(sub)
+        try:
+            yield sub
+        finally:
+            self._subscribers.discard(sub)
+
+
+display_events = DisplayEvents()
+
+
+def job_completed(job_type: str) -> None:
+    """Publish a display change if job_type feeds a display."""
+    source = DISPLAY_JOB_SOURCES.get(job_type)
+    if source is not None:
+        display_events.publish(source)
+
+
+def format_display_event(sources: list[str], summary: dict[str, Any], etag: str) -> str:
+    """One SSE "display" event: what changed, plus the /api/led/summary body and ETag."""
+    data = {"sources": sources, "etag": etag, "summary": summary}
+    return f"event: display\ndata: {json.dumps(data, separators=(',', ':'))}\n\n"
+
+
+class SseParser:
+    """Incremental text/event-stream parser: feed() lines, get (event, data) pairs back."""
+
+    def __init__(self) -> None:
+        self._event = "message"
+        self._data: list[str] = []
+
+    def feed(self, line: str) -> tuple[str, str] | None:
+        """The completed event when `line` is the blank line ending one, else None."""
+        if not line:
+            event, data = self._event, self._data
+            self._event, self._data = "message", []
+            return (event, "\n".join(data)) if data else None
+        if line.startswith(":"):
+            return None
+        field, _, value = line.partition(":")
+        value = value[1:] if value.startswith(" ") else value
+        if field == "event":
+            self._event = value
+        elif field == "data":
+            self._data.append(value)
+        return None
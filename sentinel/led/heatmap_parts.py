@@ -64,6 +64,55 @@ def build_sorted_parts(scores: list[SecurityScore], *, total_parts: int = 40) ->
     return parts
 
 
+def heatmap_before_after(positions: list[dict], recommendations: list) -> tuple[list[float], list[float]]:
+    """The 40-part before/after arrays for DB positions and planner recommendations.
+
+    Each position's score is its P/L, clamped to +-50%. Before weights are market
+    values; after weights add each recommendation's value_delta_eur.
+    """
+    if not positions:
+        return [0.0] * 40, [0.0] * 40
+
+    before_values: dict[str, float] = {}
+    scores: dict[str, float] = {}
+    for p in positions:
+        sym = str(p["symbol"])
+        qty = float(p.get("quantity") or 0.0)
+        current_price = float(p.get("current_price") or 0.0)
+        avg_cost = float(p.get("avg_cost") or 0.0)
+
+        before_values[sym] = max(0.0, qty * current_price)
+        if avg_cost > 0 and current_price > 0:
+            pl = (current_price - avg_cost) / avg_cost
+        else:
+            pl = 0.0
+        scores[sym] = clamp_score(pl, clamp_abs=0.5)
+
+    total_before = sum(before_values.values())
+    if total_before <= 0:
+        return [0.0] * 40, [0.0] * 40
+
+    after_values = dict(before_values)
+    for r in recommendations or []:
+        sym = getattr(r, "symbol", None)
+        if not sym:
+            continue
+        delta = float(getattr(r, "value_delta_eur", 0.0) or 0.0)
+        after_values[sym] = max(0.0, after_values.get(sym, 0.0) + delta)
+
+    total_after = sum(after_values.values()) or total_before
+
+    before_scores: list[SecurityScore] = []
+    after_scores: list[SecurityScore] = []
+    for sym, score in scores.items():
+        w_before = before_values.get(sym, 0.0) / total_before
+        w_after = after_values.get(sym, 0.0) / total_after
+        before_scores.append(SecurityScore(symbol=sym, weight=w_before, score=score))
+        after_scores.append(SecurityScore(symbol=sym, weight=w_after, score=score))
+
+    return build_sorted_parts(before_scores, total_parts=40), build_sorted_parts(after_scores, total_parts=40)
+
+
 def clamp_score(score: float, *, clamp_abs: float = 0.5) -> float:
     """Clamp score to [-clamp_abs, +clamp_abs]."""
     lo = -abs(clamp_abs)
@@ -73,3 +122,48 @@ def clamp_score(score: float, *, clamp_abs: float = 0.5) -> float:
     if score > hi:
         return hi
     return score
+
+
+# Compact heatmap/bin payload: a 4-byte header followed by `count` int8 before
+# scores and `count` int8 after scores, each quantized over [-0.5, +0.5].
+HEATMAP_FRAME_MAGIC = 0x48  # "H"
+HEATMAP_FRAME_VERSION = 1
+HEATMAP_FRAME_HEADER_SIZE = 4
+HEATMAP_SCORE_SCALE = 127 / 0.5
+
+
+def quantize_score(score: float) -> int:
+    """Map a score in [-0.5, +0.5] to an int8 in [-127, +127]."""
+    q = round(clamp_score(float(score)) * HEATMAP_SCORE_SCALE)
+    return max(-127, min(127, q))
+
+
+def encode_heatmap_frame(before: list[float], after: list[float], *, flags: int = 0) -> bytes:
+    """Pack before/after score arrays into the heatmap/bin payload."""
+    if len(before) != len(after):
+        raise ValueError("before and after must have the same length")
+    count = len(before)
+    if count > 255:
+        raise ValueError("at most 255 parts per frame")
+
+    out = bytearray((HEATMAP_FRAME_MAGIC, HEATMAP_FRAME_VERSION, count, flags & 0xFF))
+    out.extend(quantize_score(s) & 0xFF for s in before)
+    out.extend(quantize_score(s) & 0xFF for s in after)
+    return bytes(out)
+
+
+def decode_heatmap_frame(data: bytes) -> tuple[list[float], list[float], int]:
+    """Inverse of encode_heatmap_frame; returns (before, after, flags)."""
+    if len(data) < HEATMAP_FRAME_HEADER_SIZE:
+        raise ValueError("heatmap frame too short")
+    magic, version, count, flags = data[:HEATMAP_FRAME_HEADER_SIZE]
+    if magic != HEATMAP_FRAME_MAGIC or version != HEATMAP_FRAME_VERSION:
+        raise ValueError("not a heatmap frame")
+    if len(data) != HEATMAP_FRAME_HEADER_SIZE + 2 * count:
+        raise ValueError("heatmap frame length does not match count")
+
+    def scores(start: int) -> list[float]:
+        raw = data[start : start + count]
+        return [((b - 256) if b > 127 else b) / HEATMAP_SCORE_SCALE for b in raw]
+
+    return scores(HEATMAP_FRAME_HEADER_SIZE), scores(HEATMAP_FRAME_HEADER_SIZE + count), flags
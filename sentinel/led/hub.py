@@ -0,0 +1,254 @@
+"""
+Display hub: one set of display payloads for every UNO Q unit, built once per
+change and streamed to each registered unit as GET /api/led/hub/stream.
+
+Without the hub, each unit's app polls the API and its heatmap router runs the
+planner and build_sorted_parts for itself, so API load grows with every display
+added. With it, the first stream woken by a display change builds the bundle
+(summary, heatmap, orbital, treemap and anim payloads, active mode) and every other
+stream sends the same pre-formatted event. A unit confirms what it applied
+through POST /api/led/hub/units/{unit_id}/ack, and GET /api/led/hub reports per
+unit what was delivered, what was applied and whether the unit is healthy.
+
+Usage:
+    from sentinel.led.hub import display_hub
+
+    with display_hub.connect("desk") as unit:
+        bundle = await display_hub.current(build, sources=["connect"])
+"""
+
+import asyncio
+import json
+import logging
+import re
+import time
+from contextlib import contextmanager
+from dataclasses import dataclass, field
+from typing import Any, Awaitable, Callable, Iterator
+
+from sentinel.led.events import DisplayEvents, display_events
+from sentinel.led.summary import led_summary_etag
+
+logger = logging.getLogger(__name__)
+
+# A bundle is rebuilt at least this often, picking up price moves no job announced.
+HUB_REBUILD_SECONDS = 300
+# A unit that has not acked a delivered generation within this long is lagging.
+HUB_ACK_GRACE_SECONDS = 30
+HUB_UNIT_ID = re.compile(r"^[A-Za-z0-9_.-]{1,64}$")
+
+HubBuild = Callable[[], Awaitable[tuple[dict[str, Any], dict[str, Any]]]]
+
+
+@dataclass(frozen=True)
+class HubBundle:
+    generation: int
+    built_at: float
+    summary: dict[str, Any]
+    etag: str
+    payloads: dict[str, Any]
+    event: str  # the SSE event every unit is sent, formatted once
+
+
+@dataclass
+class HubUnit:
+    unit_id: str
+    registered_at: float
+    connections: int = 0
+    last_seen_at: float | None = None
+    delivered_generation: int = 0
+    delivered_at: float | None = None
+    acked_generation: int = 0
+    acked_at: float | None = None
+    applied_seq: int | None = None
+    bridge_ok: bool | None = None
+    mode_id: int | None = None
+    last_error: str | None = None
+
+    def status(self, now: float) -> str:
+        """offline, failing (its MCU bridge), lagging (ack overdue) or ok."""
+        if not self.connections:
+            return "offline"
+        if self.bridge_ok is False:
+            return "failing"
+        if self.acked_generation < self.delivered_generation:
+            if self.delivered_at is not None and now - self.delivered_at > HUB_ACK_GRACE_SECONDS:
+                return "lagging"
+        return "ok"
+
+    def as_dict(self, now: float) -> dict[str, Any]:
+        return {
+            "unit_id": self.unit_id,
+            "status": self.status(now),
+            "connected": self.connections > 0,
+            "registered_at": self.registered_at,
+            "last_seen_at": self.last_seen_at,
+            "delivered_generation": self.delivered_generation,
+            "delivered_at": self.delivered_at,
+            "acked_generation": self.acked_generation,
+            "acked_at": self.acked_at,
+            "applied_seq": self.applied_seq,
+            "bridge_ok": self.bridge_ok,
+            "mode_id": self.mode_id,
+            "last_error": self.last_error,
+        }
+
+
+@dataclass
+class _Build:
+    version: int = -1
+    at: float = 0.0
+    sources: set[str] = field(default_factory=set)
+
+
+def format_hub_event(bundle_fields: dict[str, Any]) -> str:
+    """One SSE "display" event; a superset of /api/led/events' display event."""
+    return f"event: display\ndata: {json.dumps(bundle_fields, separators=(',', ':'))}\n\n"
+
+
+class DisplayHub:
+    """The current bundle and the registered units. Event-loop thread only."""
+
+    def __init__(self, events: DisplayEvents = display_events) -> None:
+        self._events = events
+        self._units: dict[str, HubUnit] = {}
+        self._bundle: HubBundle | None = None
+        self._build = _Build()
+        self._lock = asyncio.Lock()
+
+    @property
+    def bundle(self) -> HubBundle | None:
+        return self._bundle
+
+    def unit(self, unit_id: str) -> HubUnit | None:
+        return self._units.get(unit_id)
+
+    async def current(self, build: HubBuild, sources: list[str]) -> HubBundle:
+        """The bundle for the latest display change, building it if no stream has yet.
+
+        The generation only moves when the content changes, so a rebuild after an
+        event that changed nothing is not re-sent.
+        """
+        self._build.sources.update(sources)
+        async with self._lock:
+            now = time.time()
+            fresh = now - self._build.at < HUB_REBUILD_SECONDS
+            if self._bundle is not None and self._build.version == self._events.version and fresh:
+                return self._bundle
+            version = self._events.version
+            previous = self._bundle
+            try:
+                summary, payloads = await build()
+            except Exception as e:
+                if previous is None:
+                    raise
+                # Units keep the last good bundle; the next change or rebuild retries.
+                logger.warning(f"Display hub rebuild failed, keeping generation {previous.generation}: {e}")
+                self._build.version, self._build.at = version, now
+                return previous
+            self._build.version, self._build.at = version, now
+            if previous is not None and (previous.summary, previous.payloads) == (summary, payloads):
+                self._build.sources = set()
+                return previous
+            generation = previous.generation + 1 if previous is not None else 1
+            etag = led_summary_etag(summary)
+            event = format_hub_event(
+                {
+                    "sources": sorted(self._build.sources),
+                    "etag": etag,
+                    "summary": summary,
+                    "generation": generation,
+                    "payloads": payloads,
+                }
+            )
+            self._build.sources = set()
+            self._bundle = HubBundle(generation, now, summary, etag, payloads, event)
+            logger.info(f"Display hub generation {generation} for {len(self._units)} unit(s)")
+            return self._bundle
+
+    @contextmanager
+    def connect(self, unit_id: str) -> Iterator[HubUnit]:
+        """Register unit_id (if new) for the lifetime of one stream."""
+        unit = self._units.get(unit_id)
+        if unit is None:
+            unit = self._units[unit_id] = HubUnit(unit_id=unit_id, registered_at=time.time())
+        unit.connections += 1
+        unit.last_seen_at = time.time()
+        try:
+            yield unit
+        finally:
+            unit.connections -= 1
+            unit.last_seen_at = time.time()
+
+    def delivered(self, unit: HubUnit, bundle: HubBundle) -> None:
+        unit.delivered_generation = bundle.generation
+        unit.delivered_at = time.time()
+        unit.last_seen_at = unit.delivered_at
+
+    def ack(self, unit_id: str, data: dict[str, Any]) -> HubUnit | None:
+        """Record what a unit applied; None for a unit that never connected."""
+        unit = self._units.get(unit_id)
+        if unit is None:
+            return None
+        now = time.time()
+        unit.last_seen_at = now
+        generation = data.get("generation")
+        if isinstance(generation, int) and generation > unit.acked_generation:
+            unit.acked_generation = min(generation, unit.delivered_generation)
+            unit.acked_at = now
+        if isinstance(data.get("applied_seq"), int):
+            unit.applied_seq = data["applied_seq"]
+        if isinstance(data.get("bridge_ok"), bool):
+            unit.bridge_ok = data["bridge_ok"]
+        if isinstance(data.get("mode_id"), int):
+            unit.mode_id = data["mode_id"]
+        error = data.get("error")
+        unit.last_error = str(error)[:200] if error else None
+        return unit
+
+    def forget(self, unit_id: str) -> bool:
+        """Drop a unit that is not connected; False if unknown or still streaming."""
+        unit = self._units.get(unit_id)
+        if unit is None or unit.connections:
+            return False
+        del self._units[unit_id]
+        return True
+
+    def status(self) -> dict[str, Any]:
+        now = time.time()
+        bundle = self._bundle
+        return {
+            "generation": bundle.generation if bundle else 0,
+            "built_at": bundle.built_at if bundle else None,
+            "units": [u.as_dict(now) for u in sorted(self._units.values(), key=lambda u: u.unit_id)],
+        }
+
+
+display_hub = DisplayHub()
+
+
+async def build_hub_payloads(db, broker, settings, currency, mode_id: int) -> tuple[dict[str, Any], dict[str, Any]]:
+    """The display summary and every unit's payloads (hex): heatmap, orbital, treemap."""
+    from sentinel.led.heatmap_parts import encode_heatmap_frame, heatmap_before_after
+    from sentinel.led.orbital import build_orbital_bodies, encode_orbital_state
+    from sentinel.led.summary import get_led_summary, led_recommendations
+    from sentinel.led.treemap import build_holdings, encode_treemap_frame, layout_treemap
+
+    # One planner run, filtered like the summary's has_recs, feeds every view in the bundle.
+    try:
+        recommendations = await led_recommendations(db, broker, settings, currency)
+    except Exception as e:
+        logger.warning(f"Display hub without recommendations: {e}")
+        recommendations = None
+    summary = await get_led_summary(db, broker, settings, currency, recommendations)
+    positions = await db.get_all_positions()
+
+    before, after = heatmap_before_after(positions, recommendations or [])
+    holdings = build_holdings(positions, recommendations or [])
+    payloads = {
+        "mode_id": mode_id,
+        "heatmap": encode_heatmap_frame(before, after).hex(),
+        "orbital": encode_orbital_state(build_orbital_bodies(holdings)).hex(),
+        "treemap": encode_treemap_frame(layout_treemap(holdings)).hex(),
+    }
+    return summary, payloads
@@ -11,6 +11,15 @@ environments. This implements only what we need for MsgPack-RPC:
   - map (dict)
 
 It is not a full MessagePack implementation.
+
+Two decoding front ends share one parser:
+  - `Unpacker` buffers into a bytearray and returns `bytes` for bin values.
+  - `StreamUnpacker` parses each fed chunk in place through a memoryview and,
+    with `zero_copy=True`, returns bin values as read-only `memoryview`s into
+    that chunk. Only a trailing partial message is ever copied.
+
+For encoding, `pack_into()` writes into a caller-owned buffer and `Packer`
+reuses one scratch buffer across calls.
 """
 
 from __future__ import annotations
@@ -25,6 +34,60 @@ def packb(obj: Any) -> bytes:
     return bytes(out)
 
 
+class _BufferWriter:
+    """append/extend sink over a fixed writable buffer, for `_pack_into`."""
+
+    __slots__ = ("buf", "pos")
+
+    def __init__(self, buf: bytearray | memoryview, pos: int):
+        self.buf = buf
+        self.pos = pos
+
+    def append(self, b: int) -> None:
+        if self.pos >= len(self.buf):
+            raise ValueError("msgpack_lite: buffer too small")
+        self.buf[self.pos] = b
+        self.pos += 1
+
+    def extend(self, data: Any) -> None:
+        if not isinstance(data, (bytes, bytearray, memoryview)):
+            data = bytes(data)
+        end = self.pos + len(data)
+        if end > len(self.buf):
+            raise ValueError("msgpack_lite: buffer too small")
+        self.buf[self.pos : end] = data
+        self.pos = end
+
+
+def pack_into(buf: bytearray | memoryview, obj: Any, offset: int = 0) -> int:
+    """Encode `obj` into `buf` starting at `offset`; return the end offset.
+
+    The buffer is never resized. Raises ValueError if `obj` does not fit, in
+    which case the contents of `buf` past `offset` are unspecified.
+    """
+    w = _BufferWriter(buf, offset)
+    _pack_into(w, obj)  # type: ignore[arg-type]
+    return w.pos
+
+
+class Packer:
+    """Encoder that reuses one scratch bytearray across calls."""
+
+    def __init__(self) -> None:
+        self._buf = bytearray()
+
+    def pack(self, obj: Any) -> memoryview:
+        """Encode `obj`; the returned view is valid until the next `pack()`."""
+        buf = self._buf
+        try:
+            buf.clear()
+        except BufferError:
+            # A caller still holds the previous view; leave it to them.
+            buf = self._buf = bytearray()
+        _pack_into(buf, obj)
+        return memoryview(buf)
+
+
 def _pack_into(out: bytearray, obj: Any) -> None:
     if obj is None:
         out.append(0xC0)
@@ -162,11 +225,47 @@ class Unpacker:
             yield obj
 
 
-def _need(buf: bytearray, off: int, n: int) -> bool:
+class StreamUnpacker:
+    """Streaming decoder that parses fed chunks in place.
+
+    Each chunk passed to `feed()` is kept as an immutable `bytes` object and
+    walked through a memoryview, so nothing is shifted when it is consumed.
+    With `zero_copy=True`, bin values come back as read-only memoryviews into
+    that chunk; they stay valid for as long as they are referenced.
+    """
+
+    def __init__(self, *, zero_copy: bool = True):
+        self._zero_copy = zero_copy
+        self._chunk = b""
+        self._view = memoryview(self._chunk)
+        self._off = 0
+
+    def feed(self, data: bytes | bytearray | memoryview) -> None:
+        if not data:
+            return
+        if self._off >= len(self._chunk):
+            # Common case: the previous chunk ended on a message boundary.
+            self._chunk = data if isinstance(data, bytes) else bytes(data)
+        else:
+            # Carry the partial message over; views into the old chunk keep it alive.
+            self._chunk = bytes(self._view[self._off :]) + bytes(data)
+        self._view = memoryview(self._chunk)
+        self._off = 0
+
+    def __iter__(self) -> Iterator[Any]:
+        while True:
+            res = _unpack_one(self._view, self._off, self._zero_copy)
+            if res is None:
+                return
+            obj, self._off = res
+            yield obj
+
+
+def _need(buf: bytearray | memoryview, off: int, n: int) -> bool:
     return len(buf) - off < n
 
 
-def _unpack_one(buf: bytearray, off: int) -> tuple[Any, int] | None:
+def _unpack_one(buf: bytearray | memoryview, off: int, views: bool = False) -> tuple[Any, int] | None:
     if _need(buf, off, 1):
         return None
     b0 = buf[off]
@@ -180,11 +279,11 @@ def _unpack_one(buf: bytearray, off: int) -> tuple[Any, int] | None:
         n = b0 & 0x0F
         m: dict[Any, Any] = {}
         for _ in range(n):
-            k_res = _unpack_one(buf, off)
+            k_res = _unpack_one(buf, off, views)
             if k_res is None:
                 return None
             k, off = k_res
-            v_res = _unpack_one(buf, off)
+            v_res = _unpack_one(buf, off, views)
             if v_res is None:
                 return None
             v, off = v_res
@@ -195,7 +294,7 @@ def _unpack_one(buf: bytearray, off: int) -> tuple[Any, int] | None:
         n = b0 & 0x0F
         arr: list[Any] = []
         for _ in range(n):
-            it_res = _unpack_one(buf, off)
+            it_res = _unpack_one(buf, off, views)
             if it_res is None:
                 return None
             it, off = it_res
@@ -206,7 +305,7 @@ def _unpack_one(buf: bytearray, off: int) -> tuple[Any, int] | None:
         n = b0 & 0x1F
         if _need(buf, off, n):
             return None
-        s = bytes(buf[off : off + n]).decode("utf-8", errors="replace")
+        s = str(buf[off : off + n], "utf-8", "replace")
         return s, off + n
     # Negative fixint
     if b0 >= 0xE0:
@@ -228,34 +327,34 @@ def _unpack_one(buf: bytearray, off: int) -> tuple[Any, int] | None:
         off += 1
         if _need(buf, off, n):
             return None
-        return bytes(buf[off : off + n]), off + n
+        return (buf[off : off + n] if views else bytes(buf[off : off + n])), off + n
     if b0 == 0xC5:
         if _need(buf, off, 2):
             return None
-        (n,) = struct.unpack(">H", bytes(buf[off : off + 2]))
+        (n,) = struct.unpack_from(">H", buf, off)
         off += 2
         if _need(buf, off, n):
             return None
-        return bytes(buf[off : off + n]), off + n
+        return (buf[off : off + n] if views else bytes(buf[off : off + n])), off + n
     if b0 == 0xC6:
         if _need(buf, off, 4):
             return None
-        (n,) = struct.unpack(">I", bytes(buf[off : off + 4]))
+        (n,) = struct.unpack_from(">I", buf, off)
         off += 4
         if _need(buf, off, n):
             return None
-        return bytes(buf[off : off + n]), off + n
+        return (buf[off : off + n] if views else bytes(buf[off : off + n])), off + n
 
     # Float64
     if b0 == 0xCA:
         if _need(buf, off, 4):
             return None
-        (v,) = struct.unpack(">f", bytes(buf[off : off + 4]))
+        (v,) = struct.unpack_from(">f", buf, off)
         return float(v), off + 4
     if b0 == 0xCB:
         if _need(buf, off, 8):
             return None
-        (v,) = struct.unpack(">d", bytes(buf[off : off + 8]))
+        (v,) = struct.unpack_from(">d", buf, off)
         return float(v), off + 8
 
     # Uint
@@ -266,39 +365,39 @@ def _unpack_one(buf: bytearray, off: int) -> tuple[Any, int] | None:
     if b0 == 0xCD:
         if _need(buf, off, 2):
             return None
-        (v,) = struct.unpack(">H", bytes(buf[off : off + 2]))
+        (v,) = struct.unpack_from(">H", buf, off)
         return v, off + 2
     if b0 == 0xCE:
         if _need(buf, off, 4):
             return None
-        (v,) = struct.unpack(">I", bytes(buf[off : off + 4]))
+        (v,) = struct.unpack_from(">I", buf, off)
         return v, off + 4
     if b0 == 0xCF:
         if _need(buf, off, 8):
             return None
-        (v,) = struct.unpack(">Q", bytes(buf[off : off + 8]))
+        (v,) = struct.unpack_from(">Q", buf, off)
         return v, off + 8
 
     # Int
     if b0 == 0xD0:
         if _need(buf, off, 1):
             return None
-        (v,) = struct.unpack(">b", bytes(buf[off : off + 1]))
+        (v,) = struct.unpack_from(">b", buf, off)
         return v, off + 1
     if b0 == 0xD1:
         if _need(buf, off, 2):
             return None
-        (v,) = struct.unpack(">h", bytes(buf[off : off + 2]))
+        (v,) = struct.unpack_from(">h", buf, off)
         return v, off + 2
     if b0 == 0xD2:
         if _need(buf, off, 4):
             return None
-        (v,) = struct.unpack(">i", bytes(buf[off : off + 4]))
+        (v,) = struct.unpack_from(">i", buf, off)
         return v, off + 4
     if b0 == 0xD3:
         if _need(buf, off, 8):
             return None
-        (v,) = struct.unpack(">q", bytes(buf[off : off + 8]))
+        (v,) = struct.unpack_from(">q", buf, off)
         return v, off + 8
 
     # Str
@@ -309,36 +408,36 @@ def _unpack_one(buf: bytearray, off: int) -> tuple[Any, int] | None:
         off += 1
         if _need(buf, off, n):
             return None
-        s = bytes(buf[off : off + n]).decode("utf-8", errors="replace")
+        s = str(buf[off : off + n], "utf-8", "replace")
         return s, off + n
     if b0 == 0xDA:
         if _need(buf, off, 2):
             return None
-        (n,) = struct.unpack(">H", bytes(buf[off : off + 2]))
+        (n,) = struct.unpack_from(">H", buf, off)
         off += 2
         if _need(buf, off, n):
             return None
-        s = bytes(buf[off : off + n]).decode("utf-8", errors="replace")
+        s = str(buf[off : off + n], "utf-8", "replace")
         return s, off + n
     if b0 == 0xDB:
         if _need(buf, off, 4):
             return None
-        (n,) = struct.unpack(">I", bytes(buf[off : off + 4]))
+        (n,) = struct.unpack_from(">I", buf, off)
         off += 4
         if _need(buf, off, n):
             return None
-        s = bytes(buf[off : off + n]).decode("utf-8", errors="replace")
+        s = str(buf[off : off + n], "utf-8", "replace")
         return s, off + n
 
     # Array / map
     if b0 == 0xDC:
         if _need(buf, off, 2):
             return None
-        (n,) = struct.unpack(">H", bytes(buf[off : off + 2]))
+        (n,) = struct.unpack_from(">H", buf, off)
         off += 2
         arr: list[Any] = []
         for _ in range(n):
-            it_res = _unpack_one(buf, off)
+            it_res = _unpack_one(buf, off, views)
             if it_res is None:
                 return None
             it, off = it_res
@@ -347,11 +446,11 @@ def _unpack_one(buf: bytearray, off: int) -> tuple[Any, int] | None:
     if b0 == 0xDD:
         if _need(buf, off, 4):
             return None
-        (n,) = struct.unpack(">I", bytes(buf[off : off + 4]))
+        (n,) = struct.unpack_from(">I", buf, off)
         off += 4
         arr: list[Any] = []
         for _ in range(n):
-            it_res = _unpack_one(buf, off)
+            it_res = _unpack_one(buf, off, views)
             if it_res is None:
                 return None
             it, off = it_res
@@ -361,15 +460,15 @@ def _unpack_one(buf: bytearray, off: int) -> tuple[Any, int] | None:
     if b0 == 0xDE:
         if _need(buf, off, 2):
             return None
-        (n,) = struct.unpack(">H", bytes(buf[off : off + 2]))
+        (n,) = struct.unpack_from(">H", buf, off)
         off += 2
         m: dict[Any, Any] = {}
         for _ in range(n):
-            k_res = _unpack_one(buf, off)
+            k_res = _unpack_one(buf, off, views)
             if k_res is None:
                 return None
             k, off = k_res
-            v_res = _unpack_one(buf, off)
+            v_res = _unpack_one(buf, off, views)
             if v_res is None:
                 return None
             v, off = v_res
@@ -378,15 +477,15 @@ def _unpack_one(buf: bytearray, off: int) -> tuple[Any, int] | None:
     if b0 == 0xDF:
         if _need(buf, off, 4):
             return None
-        (n,) = struct.unpack(">I", bytes(buf[off : off + 4]))
+        (n,) = struct.unpack_from(">I", buf, off)
         off += 4
         m: dict[Any, Any] = {}
         for _ in range(n):
-            k_res = _unpack_one(buf, off)
+            k_res = _unpack_one(buf, off, views)
             if k_res is None:
                 return None
             k, off = k_res
-            v_res = _unpack_one(buf, off)
+            v_res = _unpack_one(buf, off, views)
             if v_res is None:
                 return None
             v, off = v_res
@@ -0,0 +1,96 @@
+"""Build the orbital view's updateState payload for the 8x13 LED matrix.
+
+The largest four holdings sit in the sun, the rest orbit it, alternating
+between the inner and outer ring by size. Each body's animation pattern comes
+from the same holdings the treemap uses (sentinel/led/treemap.py):
+  - a pending buy fades in and a pending sell fades out
+  - a forced sell blinks
+  - a loss of 10% or more pulses
+  - everything else breathes
+
+Body ids are derived from the symbol, so a holding keeps its id, and with it its
+place in orbit, from one update to the next.
+
+See mode_orbital.h in the SentinelLED firmware library for the wire format.
+"""
+
+from __future__ import annotations
+
+import zlib
+from dataclasses import dataclass
+
+from sentinel.led.treemap import WAVE_PULSE, WAVE_SAW_DOWN, WAVE_SAW_UP, TreemapHolding
+
+ORBITAL_MAX_BODIES = 40
+ORBITAL_SUN_BODIES = 4
+
+# Pattern ids (mode_orbital.cpp).
+PATTERN_BREATHE = 0
+PATTERN_FADE_IN = 1
+PATTERN_FADE_OUT = 2
+PATTERN_PULSE = 3
+PATTERN_BLINK = 4
+
+ORBIT_SUN = 0
+ORBIT_INNER = 1
+ORBIT_OUTER = 2
+
+PULSE_BELOW_PNL_PCT = -10.0
+
+
+@dataclass(frozen=True)
+class OrbitalBody:
+    symbol: str
+    id: int
+    pattern: int
+    orbit: int
+
+
+def _pattern(h: TreemapHolding) -> int:
+    if h.wave == WAVE_PULSE:
+        return PATTERN_BLINK
+    if h.wave == WAVE_SAW_UP:
+        return PATTERN_FADE_IN
+    if h.wave == WAVE_SAW_DOWN:
+        return PATTERN_FADE_OUT
+    if h.pnl_pct <= PULSE_BELOW_PNL_PCT:
+        return PATTERN_PULSE
+    return PATTERN_BREATHE
+
+
+def _assign_ids(symbols: list[str]) -> dict[str, int]:
+    """A stable id in 0..254 per symbol; collisions probe onward in symbol order."""
+    ids: dict[str, int] = {}
+    taken: set[int] = set()
+    for sym in sorted(symbols):
+        body_id = zlib.crc32(sym.encode()) % 255
+        while body_id in taken:
+            body_id = (body_id + 1) % 255
+        ids[sym] = body_id
+        taken.add(body_id)
+    return ids
+
+
+def build_orbital_bodies(holdings: list[TreemapHolding]) -> list[OrbitalBody]:
+    """Bodies for the largest ORBITAL_MAX_BODIES holdings, largest first."""
+    ranked = sorted((h for h in holdings if h.weight > 0), key=lambda h: h.weight, reverse=True)
+    ranked = ranked[:ORBITAL_MAX_BODIES]
+    ids = _assign_ids([h.symbol for h in ranked])
+    bodies = []
+    for i, h in enumerate(ranked):
+        if i < ORBITAL_SUN_BODIES:
+            orbit = ORBIT_SUN
+        else:
+            orbit = ORBIT_INNER if (i - ORBITAL_SUN_BODIES) % 2 == 0 else ORBIT_OUTER
+        bodies.append(OrbitalBody(symbol=h.symbol, id=ids[h.symbol], pattern=_pattern(h), orbit=orbit))
+    return bodies
+
+
+def encode_orbital_state(bodies: list[OrbitalBody]) -> bytes:
+    """updateState payload: [count, id, pattern, orbit, ...]."""
+    if len(bodies) > ORBITAL_MAX_BODIES:
+        raise ValueError(f"at most {ORBITAL_MAX_BODIES} bodies")
+    out = bytearray([len(bodies)])
+    for b in bodies:
+        out += bytes((b.id, b.pattern, b.orbit))
+    return bytes(out)
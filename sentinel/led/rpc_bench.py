@@ -0,0 +1,661 @@
+"""Record arduino-router bridge traffic and replay it against an UNO Q to load-test the MCU.
+
+RecordingProxy listens on a UNIX socket in front of arduino-router and passes bytes
+through both ways unchanged. Along the way it logs each MsgPack-RPC message for the
+methods it records (RECORD_METHODS by default) into a JSONL trace, one TraceEvent per
+line. To record a client, point its router socket (ARDUINO_ROUTER_SOCK for the scripts)
+at the proxy.
+
+run_load() drives a board through the real router with a schedule of Ops. The schedule
+is either a trace replayed at 1x to MAX_SPEED, or a synthetic mix at a fixed call rate.
+The report covers:
+  - calls/sec
+  - p50/p99/max round-trip time, overall and per method
+  - RPC errors and MCU decode rejections
+  - hm.b frames the MCU never applied (seqs it skipped, or still unapplied at the end)
+Each diag/stats window the run polls is paired with the host-side calls and RTTs that
+completed in it, so the report shows how latency degrades as MCU render and bridge
+times grow.
+
+A full run reads every diag/stats window, so stop the LED app first. Otherwise its
+health reports steal windows from the run.
+"""
+
+from __future__ import annotations
+
+import asyncio
+import json
+import logging
+import math
+import random
+import struct
+import time
+from dataclasses import dataclass, field
+from typing import Any, Iterable
+
+from sentinel.led import msgpack_lite as msgpack
+from sentinel.led.anim import crc16_ccitt
+from sentinel.led.arduino_router_rpc import NOTIFY, REQUEST, RESPONSE, AsyncMsgpackRpc, RpcError
+
+logger = logging.getLogger(__name__)
+
+RECORD_METHODS = ("hm.u", "hm.b", "updateState", "setBrightness", "heatmap/get", "heatmap/bin", "heatmap/changed")
+MAX_SPEED = 1000.0
+
+# diag/stats field order (perf_stats.h in the SentinelLED library).
+MCU_STATS_FIELDS = (
+    "version",
+    "build_id",
+    "window_ms",
+    "loops_per_sec",
+    "render_min_us",
+    "render_mean_us",
+    "render_max_us",
+    "render_p99_us",
+    "show_mean_us",
+    "show_max_us",
+    "bridge_mean_us",
+    "bridge_max_us",
+    "irq_masked_us",
+    "rpc_decoded",
+    "rpc_rejected",
+    "stack_free_bytes",
+    "heap_free_bytes",
+    "frames_shown",
+    "frames_elided",
+)
+MCU_STATS_UNAVAILABLE = 0xFFFFFFFF
+# How windows combine into a run total; fields not listed are taken from the last window.
+_MCU_SUM = ("window_ms", "irq_masked_us", "rpc_decoded", "rpc_rejected", "frames_shown", "frames_elided")
+_MCU_MAX = ("render_max_us", "render_p99_us", "show_max_us", "bridge_max_us")
+_MCU_MIN = ("render_min_us", "stack_free_bytes", "heap_free_bytes")
+_MCU_MEAN = ("loops_per_sec", "render_mean_us", "show_mean_us", "bridge_mean_us")
+
+# hm.b v1 frame (sketch.ino): version, flags, pnl, reserved, value u32, seq u32, CRC-16.
+HM_FRAME = struct.Struct("<BBbBII")
+HM_FRAME_VERSION = 1
+
+# Synthetic mix: a little faster than the app in hm.b-heavy notify mode, with orbital
+# updates, brightness changes and heatmap pokes mixed in.
+DEFAULT_MIX = {"hm.b": 6, "updateState": 2, "setBrightness": 1, "heatmap/changed": 1}
+# `bench`: the fixed sweep firmware changes are compared on.
+BENCH_RATES = (25, 50, 100, 200, 400)
+BENCH_SECONDS = 10.0
+BENCH_SEED = 1
+
+
+# --- Trace ---
+
+
+@dataclass(frozen=True)
+class TraceEvent:
+    t: float  # seconds since the recording started
+    dir: str  # "out": client to router (towards the MCU), "in": router to client
+    kind: str  # "call", "notify" or "result"
+    method: str
+    params: list[Any] = field(default_factory=list)
+    result: Any = None
+    rtt_ms: float | None = None  # results only: since the matching call
+
+
+def _to_json(obj: Any) -> Any:
+    if isinstance(obj, (bytes, bytearray, memoryview)):
+        return {"$bin": bytes(obj).hex()}
+    if isinstance(obj, (list, tuple)):
+        return [_to_json(v) for v in obj]
+    if isinstance(obj, dict):
+        return {str(k): _to_json(v) for k, v in obj.items()}
+    return obj
+
+
+def _from_json(obj: Any) -> Any:
+    if isinstance(obj, dict):
+        if set(obj) == {"$bin"}:
+            return bytes.fromhex(obj["$bin"])
+        return {k: _from_json(v) for k, v in obj.items()}
+    if isinstance(obj, list):
+        return [_from_json(v) for v in obj]
+    return obj
+
+
+def dump_event(ev: TraceEvent) -> str:
+    line: dict[str, Any] = {"t": round(ev.t, 6), "dir": ev.dir, "kind": ev.kind, "method": ev.method}
+    if ev.kind == "result":
+        line["result"] = _to_json(ev.result)
+        line["rtt_ms"] = ev.rtt_ms
+    else:
+        line["params"] = _to_json(ev.params)
+    return json.dumps(line, separators=(",", ":"))
+
+
+def load_event(line: str) -> TraceEvent:
+    d = json.loads(line)
+    return TraceEvent(
+        t=float(d["t"]),
+        dir=d["dir"],
+        kind=d["kind"],
+        method=d["method"],
+        params=_from_json(d.get("params") or []),
+        result=_from_json(d.get("result")),
+        rtt_ms=d.get("rtt_ms"),
+    )
+
+
+def load_trace(path: str) -> list[TraceEvent]:
+    with open(path, encoding="utf-8") as f:
+        return [load_event(line) for line in f if line.strip()]
+
+
+# --- Recorder ---
+
+
+class _Recorder:
+    """Turns the messages of one proxied connection into TraceEvents."""
+
+    def __init__(self, out: Any, methods: Iterable[str] | None, started: float):
+        self._out = out
+        self._methods = set(methods) if methods is not None else None
+        self._started = started
+        # (direction of the call, msgid) -> (method, sent at)
+        self._pending: dict[tuple[str, Any], tuple[str, float]] = {}
+
+    def _wanted(self, method: Any) -> bool:
+        return isinstance(method, str) and (self._methods is None or method in self._methods)
+
+    def _write(self, ev: TraceEvent) -> None:
+        self._out.write(dump_event(ev) + "\n")
+        self._out.flush()
+
+    def message(self, direction: str, msg: Any, now: float) -> None:
+        if not isinstance(msg, list) or not msg:
+            return
+        t = now - self._started
+        if msg[0] == REQUEST and len(msg) == 4 and self._wanted(msg[2]):
+            self._pending[(direction, msg[1])] = (msg[2], now)
+            self._write(TraceEvent(t, direction, "call", msg[2], list(msg[3] or [])))
+        elif msg[0] == NOTIFY and len(msg) == 3 and self._wanted(msg[1]):
+            self._write(TraceEvent(t, direction, "notify", msg[1], list(msg[2] or [])))
+        elif msg[0] == RESPONSE and len(msg) == 4:
+            # A response travels the other way from its call.
+            call_dir = "in" if direction == "out" else "out"
+            pending = self._pending.pop((call_dir, msg[1]), None)
+            if pending is not None:
+                method, sent = pending
+                result = msg[3] if msg[2] is None else {"error": _to_json(msg[2])}
+                self._write(TraceEvent(t, call_dir, "result", method, result=result, rtt_ms=(now - sent) * 1000))
+
+
+class RecordingProxy:
+    """A pass-through UNIX socket in front of arduino-router that records a trace."""
+
+    def __init__(self, listen_path: str, router_path: str, out: Any, *, methods: Iterable[str] | None = RECORD_METHODS):
+        self._listen_path = listen_path
+        self._router_path = router_path
+        self._out = out
+        self._methods = methods
+        self._started = time.monotonic()
+        self._server: asyncio.AbstractServer | None = None
+        self._pumps: set[asyncio.Task[None]] = set()
+
+    async def start(self) -> None:
+        self._started = time.monotonic()
+        self._server = await asyncio.start_unix_server(self._client, path=self._listen_path)
+
+    async def close(self) -> None:
+        if self._server is not None:
+            self._server.close()
+            await self._server.wait_closed()
+            self._server = None
+        for task in list(self._pumps):
+            task.cancel()
+        await asyncio.gather(*self._pumps, return_exceptions=True)
+
+    async def serve_forever(self) -> None:
+        if self._server is None:
+            raise RuntimeError("proxy not started")
+        await self._server.serve_forever()
+
+    async def _client(self, reader: asyncio.StreamReader, writer: asyncio.StreamWriter) -> None:
+        try:
+            r_reader, r_writer = await asyncio.open_unix_connection(self._router_path)
+        except OSError as e:
+            logger.warning(f"Cannot reach arduino-router at {self._router_path}: {e}")
+            writer.close()
+            return
+        recorder = _Recorder(self._out, self._methods, self._started)
+        pumps = [
+            asyncio.create_task(self._pump(reader, r_writer, recorder, "out")),
+            asyncio.create_task(self._pump(r_reader, writer, recorder, "in")),
+        ]
+        self._pumps.update(pumps)
+        try:
+            # Either side closing ends the connection.
+            await asyncio.wait(pumps, return_when=asyncio.FIRST_COMPLETED)
+        finally:
+            for task in pumps:
+                task.cancel()
+                self._pumps.discard(task)
+            for w in (writer, r_writer):
+                w.close()
+
+    @staticmethod
+    async def _pump(reader: asyncio.StreamReader, writer: asyncio.StreamWriter, recorder: _Recorder, direction: str):
+        unpacker = msgpack.StreamUnpacker(zero_copy=False)
+        while True:
+            data = await reader.read(4096)
+            if not data:
+                return
+            # Forward first: recording must not add latency to the traffic.
+            writer.write(data)
+            await writer.drain()
+            unpacker.feed(data)
+            now = time.monotonic()
+            for msg in unpacker:
+                recorder.message(direction, msg, now)
+
+
+# --- Schedules ---
+
+
+@dataclass(frozen=True)
+class Op:
+    at: float  # seconds after the run starts
+    method: str
+    params: list[Any]
+    notify: bool = False
+
+
+def replay_schedule(events: Iterable[TraceEvent], *, speed: float = 1.0) -> list[Op]:
+    """The client-to-router calls and notifies of a trace, time-compressed by speed.
+
+    Calls the board made to the client (heatmap/get, heatmap/bin) are the MCU's own
+    traffic: they recur by themselves, and run_load(serve_heatmap=...) answers them.
+    """
+    if not 1.0 <= speed <= MAX_SPEED:
+        raise ValueError(f"speed must be between 1 and {MAX_SPEED:g}")
+    ops = [ev for ev in events if ev.dir == "out" and ev.kind in ("call", "notify") and not ev.method.startswith("$/")]
+    if not ops:
+        return []
+    t0 = ops[0].t
+    return [Op((ev.t - t0) / speed, ev.method, list(ev.params), ev.kind == "notify") for ev in ops]
+
+
+def encode_hm_frame(value: int, return_pct: int, flags: int, seq: int) -> bytes:
+    body = HM_FRAME.pack(HM_FRAME_VERSION, flags, return_pct, 0, value, seq & 0xFFFFFFFF)
+    return body + struct.pack("<H", crc16_ccitt(body))
+
+
+def reseq_hm_frame(frame: bytes, seq: int) -> bytes:
+    """An hm.b frame with its seq (and CRC) replaced, so a replay runs in sequence."""
+    if len(frame) != HM_FRAME.size + 2:
+        return frame
+    version, flags, pnl, reserved, value, _ = HM_FRAME.unpack(frame[: HM_FRAME.size])
+    body = HM_FRAME.pack(version, flags, pnl, reserved, value, seq & 0xFFFFFFFF)
+    return body + struct.pack("<H", crc16_ccitt(body))
+
+
+def _synthetic_params(method: str, rng: random.Random) -> list[Any]:
+    if method == "hm.b":
+        return [encode_hm_frame(rng.randrange(100_000_000), rng.randint(-99, 99), rng.randrange(4), 0)]
+    if method == "hm.u":
+        return [[rng.randrange(100_000_000), rng.randint(-99, 99), rng.randrange(2), rng.randrange(2)]]
+    if method == "updateState":
+        count = rng.randint(1, 40)
+        ids = rng.sample(range(255), count)
+        return [bytes([count]) + b"".join(bytes((i, rng.randrange(5), rng.randrange(3))) for i in ids)]
+    if method == "setBrightness":
+        return [rng.randint(16, 255)]
+    if method == "heatmap/changed":
+        return []
+    raise ValueError(f"no synthetic payload for {method!r}")
+
+
+def parse_mix(spec: str) -> dict[str, float]:
+    """Parse "hm.b=6,updateState=2" into {"hm.b": 6.0, "updateState": 2.0}."""
+    mix: dict[str, float] = {}
+    for part in spec.split(","):
+        method, _, weight = part.strip().partition("=")
+        if not method:
+            continue
+        mix[method] = float(weight) if weight else 1.0
+        _synthetic_params(method, random.Random(0))  # rejects unknown methods up front
+    if not mix or sum(mix.values()) <= 0:
+        raise ValueError("empty mix")
+    return mix
+
+
+def synthetic_schedule(mix: dict[str, float], *, rate: float, duration: float, seed: int = BENCH_SEED) -> list[Op]:
+    """Evenly spaced ops at `rate` per second for `duration` s, methods drawn from `mix`."""
+    if rate <= 0 or duration <= 0:
+        raise ValueError("rate and duration must be positive")
+    rng = random.Random(seed)
+    methods, weights = list(mix), list(mix.values())
+    ops = []
+    for i in range(int(rate * duration)):
+        method = rng.choices(methods, weights)[0]
+        ops.append(Op(i / rate, method, _synthetic_params(method, rng), method == "heatmap/changed"))
+    return ops
+
+
+# --- Driver ---
+
+
+def percentile(values: list[float], pct: float) -> float | None:
+    """Nearest-rank percentile; None for no values."""
+    if not values:
+        return None
+    ordered = sorted(values)
+    return ordered[max(0, math.ceil(pct / 100 * len(ordered)) - 1)]
+
+
+def _rtt_summary(rtts: list[float]) -> dict[str, float | None]:
+    def ms(v: float | None) -> float | None:
+        return None if v is None else round(v, 3)
+
+    return {
+        "p50": ms(percentile(rtts, 50)),
+        "p99": ms(percentile(rtts, 99)),
+        "max": ms(max(rtts) if rtts else None),
+        "mean": ms(sum(rtts) / len(rtts) if rtts else None),
+    }
+
+
+def mcu_stats(raw: list[Any]) -> dict[str, int | None]:
+    return {
+        name: None if int(value) == MCU_STATS_UNAVAILABLE else int(value) for name, value in zip(MCU_STATS_FIELDS, raw)
+    }
+
+
+def combine_mcu_stats(windows: list[dict[str, int | None]]) -> dict[str, int | float | None]:
+    """One total over consecutive diag/stats windows: counters summed, extremes kept, means weighted."""
+    if not windows:
+        return {}
+    total: dict[str, int | float | None] = dict(windows[-1])
+    weights = [w.get("window_ms") or 0 for w in windows]
+    for name in MCU_STATS_FIELDS:
+        values = [w[name] for w in windows if w.get(name) is not None]
+        if not values:
+            total[name] = None
+        elif name in _MCU_SUM:
+            total[name] = sum(values)
+        elif name in _MCU_MAX:
+            total[name] = max(values)
+        elif name in _MCU_MIN:
+            total[name] = min(values)
+        elif name in _MCU_MEAN:
+            pairs = [(w[name], wt) for w, wt in zip(windows, weights) if w.get(name) is not None]
+            span = sum(wt for _, wt in pairs)
+            total[name] = round(sum(v * wt for v, wt in pairs) / span, 1) if span else values[-1]
+    return total
+
+
+@dataclass
+class _Sample:
+    done: float  # seconds after the run started
+    method: str
+    rtt_ms: float | None  # None for notifies and failed calls
+    outcome: str  # "ok", "rejected" (returned false), "error" or "timeout"
+
+
+async def _hm_status(rpc: AsyncMsgpackRpc, timeout: float) -> list[int] | None:
+    try:
+        return [int(x) for x in (await rpc.call("hm.s", timeout=timeout))[:3]]
+    except (RpcError, asyncio.TimeoutError, ValueError, TypeError) as e:
+        logger.warning(f"hm.s unavailable, frame drops not tracked: {e}")
+        return None
+
+
+async def _diag(rpc: AsyncMsgpackRpc, timeout: float) -> dict[str, int | None] | None:
+    try:
+        return mcu_stats(await rpc.call("diag/stats", timeout=timeout))
+    except (RpcError, asyncio.TimeoutError, ValueError, TypeError) as e:
+        logger.warning(f"diag/stats unavailable: {e}")
+        return None
+
+
+async def run_load(
+    rpc: AsyncMsgpackRpc,
+    ops: list[Op],
+    *,
+    notify: bool = False,
+    timeout: float = 2.0,
+    concurrency: int = 1,
+    stats_interval: float = 5.0,
+    settle: float = 1.0,
+) -> dict[str, Any]:
+    """Send ops on schedule through a connected router and report what the board made of them.
+
+    With notify=True every op goes out as a notify, like the app's default push mode, so
+    there are no round trips and hm.b delivery is judged from hm.s alone. At most
+    `concurrency` calls are in flight; an op that finds them all busy goes out late, and
+    the worst lag is reported.
+    """
+    loop = asyncio.get_running_loop()
+    hm_start = await _hm_status(rpc, timeout)
+    seq = hm_start[0] if hm_start else 0
+    frames = 0
+    await _diag(rpc, timeout)  # starts a fresh window at the start of the run
+
+    samples: list[_Sample] = []
+    windows: list[tuple[float, dict[str, int | None]]] = []
+    slots = asyncio.Semaphore(max(1, concurrency))
+    tasks: set[asyncio.Task[None]] = set()
+    max_lag = 0.0
+    start = loop.time()
+
+    async def send(op: Op, params: list[Any]) -> None:
+        sent = loop.time()
+        try:
+            if notify or op.notify:
+                await rpc.notify(op.method, *params)
+                samples.append(_Sample(loop.time() - start, op.method, None, "ok"))
+                return
+            result = await rpc.call(op.method, *params, timeout=timeout)
+            rtt = (loop.time() - sent) * 1000
+            samples.append(_Sample(loop.time() - start, op.method, rtt, "rejected" if result is False else "ok"))
+        except asyncio.TimeoutError:
+            samples.append(_Sample(loop.time() - start, op.method, None, "timeout"))
+        except (RpcError, ConnectionError, RuntimeError) as e:
+            logger.debug(f"{op.method} failed: {e}")
+            samples.append(_Sample(loop.time() - start, op.method, None, "error"))
+        finally:
+            slots.release()
+
+    async def poll_stats() -> None:
+        while True:
+            await asyncio.sleep(stats_interval)
+            stats = await _diag(rpc, timeout)
+            if stats is not None:
+                windows.append((loop.time() - start, stats))
+
+    poller = asyncio.create_task(poll_stats())
+    try:
+        for op in ops:
+            delay = start + op.at - loop.time()
+            if delay > 0:
+                await asyncio.sleep(delay)
+            await slots.acquire()
+            max_lag = max(max_lag, loop.time() - (start + op.at))
+            params = op.params
+            if op.method == "hm.b" and params and isinstance(params[0], bytes):
+                seq += 1
+                frames += 1
+                params = [reseq_hm_frame(params[0], seq), *params[1:]]
+            task = asyncio.create_task(send(op, params))
+            tasks.add(task)
+            task.add_done_callback(tasks.discard)
+        if tasks:
+            await asyncio.wait(list(tasks))
+        elapsed = loop.time() - start
+        # Notifies may still sit in the MCU's queue.
+        await asyncio.sleep(settle)
+    finally:
+        poller.cancel()
+    stats = await _diag(rpc, timeout)
+    if stats is not None:
+        windows.append((loop.time() - start, stats))
+    hm_end = await _hm_status(rpc, timeout)
+    return build_report(
+        samples,
+        windows,
+        elapsed=elapsed,
+        mode="notify" if notify else "call",
+        ops=len(ops),
+        max_lag_ms=max_lag * 1000,
+        hm=_hm_report(hm_start, hm_end, frames, seq),
+    )
+
+
+def _hm_report(start: list[int] | None, end: list[int] | None, frames: int, last_seq: int) -> dict[str, Any] | None:
+    if start is None or end is None:
+        return None
+    applied, rejected, skipped = end
+    skipped -= start[2]
+    # The MCU counts every seq it jumped over; frames after its applied seq never arrived.
+    unapplied = min(frames, (last_seq - applied) & 0xFFFFFFFF)
+    return {
+        "frames_sent": frames,
+        "applied_seq": applied,
+        "rejected": rejected - start[1],
+        "skipped": skipped,
+        "dropped": skipped + unapplied,
+    }
+
+
+def build_report(
+    samples: list[_Sample],
+    windows: list[tuple[float, dict[str, int | None]]],
+    *,
+    elapsed: float,
+    mode: str,
+    ops: int,
+    max_lag_ms: float,
+    hm: dict[str, Any] | None,
+) -> dict[str, Any]:
+    rtts = [s.rtt_ms for s in samples if s.rtt_ms is not None]
+    by_method: dict[str, dict[str, Any]] = {}
+    for method in sorted({s.method for s in samples}):
+        mine = [s for s in samples if s.method == method]
+        by_method[method] = {
+            "calls": len(mine),
+            "errors": sum(s.outcome in ("error", "rejected") for s in mine),
+            "timeouts": sum(s.outcome == "timeout" for s in mine),
+            "rtt_ms": _rtt_summary([s.rtt_ms for s in mine if s.rtt_ms is not None]),
+        }
+
+    # Host samples paired with the diag/stats window they completed in.
+    paired = []
+    window_start = 0.0
+    for at, stats in windows:
+        mine = [s for s in samples if window_start <= s.done < at]
+        span = at - window_start
+        paired.append(
+            {
+                "t": round(at, 3),
+                "calls": len(mine),
+                "calls_per_sec": round(len(mine) / span, 1) if span > 0 else None,
+                "rtt_ms": _rtt_summary([s.rtt_ms for s in mine if s.rtt_ms is not None]),
+                "mcu": stats,
+            }
+        )
+        window_start = at
+
+    mcu = combine_mcu_stats([stats for _, stats in windows])
+    ok = sum(s.outcome == "ok" for s in samples)
+    return {
+        "mode": mode,
+        "ops": ops,
+        "duration_s": round(elapsed, 3),
+        "calls_per_sec": round(ok / elapsed, 1) if elapsed > 0 else None,
+        "max_lag_ms": round(max_lag_ms, 3),
+        "rtt_ms": _rtt_summary(rtts),
+        "errors": sum(s.outcome == "error" for s in samples),
+        "rejected": sum(s.outcome == "rejected" for s in samples),
+        "timeouts": sum(s.outcome == "timeout" for s in samples),
+        "decode_failures": mcu.get("rpc_rejected"),
+        "dropped_frames": hm["dropped"] if hm else None,
+        "hm": hm,
+        "by_method": by_method,
+        "mcu": mcu,
+        "windows": paired,
+    }
+
+
+async def serve_heatmap(rpc: AsyncMsgpackRpc, frame: bytes, served: dict[str, int]) -> None:
+    """Answer the board's heatmap/get and heatmap/bin polls with a fixed frame, counting them.
+
+    Only for a run without scripts/uno_q_heatmap_router_server.py, which owns these methods.
+    """
+    from sentinel.led.heatmap_parts import decode_heatmap_frame
+
+    before, after, _ = decode_heatmap_frame(frame)
+
+    async def handle_get(_: list[Any]) -> Any:
+        served["heatmap/get"] = served.get("heatmap/get", 0) + 1
+        return [before, after]
+
+    async def handle_bin(_: list[Any]) -> Any:
+        served["heatmap/bin"] = served.get("heatmap/bin", 0) + 1
+        return frame
+
+    rpc.add_method("heatmap/get", handle_get)
+    rpc.add_method("heatmap/bin", handle_bin)
+    await rpc.register("heatmap/get", "heatmap/bin")
+
+
+def heatmap_frame_from_trace(events: Iterable[TraceEvent]) -> bytes | None:
+    """The last heatmap/bin frame a trace recorded the client answering with."""
+    frame = None
+    for ev in events:
+        if ev.kind == "result" and ev.method == "heatmap/bin" and isinstance(ev.result, bytes):
+            frame = ev.result
+    return frame
+
+
+# --- Comparing runs ---
+
+COMPARE_METRICS = (
+    ("calls_per_sec", ("calls_per_sec",)),
+    ("rtt p50 ms", ("rtt_ms", "p50")),
+    ("rtt p99 ms", ("rtt_ms", "p99")),
+    ("rtt max ms", ("rtt_ms", "max")),
+    ("timeouts", ("timeouts",)),
+    ("decode failures", ("decode_failures",)),
+    ("dropped frames", ("dropped_frames",)),
+    ("MCU loops/s", ("mcu", "loops_per_sec")),
+    ("MCU render mean us", ("mcu", "render_mean_us")),
+    ("MCU render p99 us", ("mcu", "render_p99_us")),
+    ("MCU bridge mean us", ("mcu", "bridge_mean_us")),
+    ("MCU bridge max us", ("mcu", "bridge_max_us")),
+)
+
+
+def _metric(report: dict[str, Any], path: tuple[str, ...]) -> Any:
+    value: Any = report
+    for key in path:
+        value = value.get(key) if isinstance(value, dict) else None
+    return value
+
+
+def format_report(report: dict[str, Any], baseline: dict[str, Any] | None = None) -> str:
+    """Text summary of one run, with the change from a baseline run if given."""
+    lines = [f"{report['mode']}: {report['ops']} ops in {report['duration_s']} s"]
+    for label, path in COMPARE_METRICS:
+        value = _metric(report, path)
+        line = f"  {label:<20} {'-' if value is None else value}"
+        base = _metric(baseline, path) if baseline else None
+        if isinstance(value, (int, float)) and isinstance(base, (int, float)):
+            delta = value - base
+            pct = f" ({delta / base * 100:+.1f}%)" if base else ""
+            line += f"   was {base}, {round(delta, 3):+}{pct}"
+        lines.append(line)
+    return "\n".join(lines)
+
+
+def format_bench(bench: dict[str, Any], baseline: dict[str, Any] | None = None) -> str:
+    base_levels = {lvl["rate"]: lvl for lvl in (baseline or {}).get("levels", [])}
+    out = [f"MCU build {bench.get('build_id')}"]
+    for level in bench["levels"]:
+        out.append(f"--- {level['rate']} calls/s offered")
+        out.append(format_report(level, base_levels.get(level["rate"])))
+    return "\n".join(out)
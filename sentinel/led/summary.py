@@ -0,0 +1,122 @@
+"""
+Display summary for the UNO Q LED app, served as GET /api/led/summary.
+
+One cached object replaces the app's three per-refresh requests
+(/api/portfolio, /api/planner/recommendations, /api/health). The portfolio
+value and "recommendations pending" flag are cached, because producing them
+can run the planner. Jobs that change either call invalidate_led_summary().
+The broker flag is read live on each request. Concurrent misses share one
+rebuild, so the SSE streams a job wakes all at once run the planner once.
+
+Usage:
+    from sentinel.led.summary import get_led_summary, led_summary_etag
+
+    summary = await get_led_summary(db, broker, settings, currency)
+    etag = led_summary_etag(summary)
+"""
+
+import asyncio
+import hashlib
+import json
+import logging
+from typing import Any
+
+from sentinel.cache import Cache
+
+logger = logging.getLogger(__name__)
+
+LED_SUMMARY_TTL_SECONDS = 300
+_CACHE_KEY = "summary"
+
+_cache: Cache[dict[str, Any]] = Cache("led_summary", ttl_seconds=LED_SUMMARY_TTL_SECONDS)
+# The rebuild every concurrent miss waits on, and the invalidations so far.
+_inflight: asyncio.Task | None = None
+_generation = 0
+
+
+def invalidate_led_summary() -> None:
+    """Drop the cached summary so the next request rebuilds it."""
+    global _inflight, _generation
+    _cache.invalidate(_CACHE_KEY)
+    _generation += 1
+    # A rebuild already running may have read the data before the change.
+    _inflight = None
+
+
+async def led_recommendations(db, broker, settings, currency) -> list:
+    """The trades /api/planner/recommendations lists: above min_trade_value, open markets only."""
+    from sentinel.markets import get_open_market_symbols
+    from sentinel.planner import Planner
+    from sentinel.portfolio import Portfolio
+
+    portfolio = Portfolio(db=db, broker=broker, settings=settings, currency=currency)
+    planner = Planner(db=db, broker=broker, portfolio=portfolio)
+    min_value = await settings.get("min_trade_value", default=100.0)
+    open_symbols = await get_open_market_symbols(broker, db)
+    return await planner.get_recommendations(
+        min_trade_value=min_value,
+        eligible_symbols=open_symbols,
+    )
+
+
+async def _build(db, broker, settings, currency, recommendations: list | None = None) -> dict[str, Any]:
+    from sentinel.services.valuation import PortfolioValuationService
+
+    valuation = await PortfolioValuationService(db=db, currency=currency).current()
+    try:
+        if recommendations is None:
+            recommendations = await led_recommendations(db, broker, settings, currency)
+        has_recs = bool(recommendations)
+    except Exception as e:
+        # Recommendations are optional; the value display must not depend on them.
+        logger.warning(f"LED summary without recommendations: {e}")
+        has_recs = False
+    return {
+        "value": round(valuation.get("total_value_eur") or 0),
+        "return_pct": round(valuation.get("portfolio_return_pct") or 0),
+        "has_recs": has_recs,
+    }
+
+
+async def _rebuild(db, broker, settings, currency, recommendations: list | None) -> dict[str, Any]:
+    generation = _generation
+    summary = await _build(db, broker, settings, currency, recommendations)
+    if generation == _generation:
+        _cache.set(_CACHE_KEY, summary)
+    return summary
+
+
+def _clear_inflight(task: asyncio.Task) -> None:
+    global _inflight
+    if _inflight is task:
+        _inflight = None
+
+
+async def get_led_summary(db, broker, settings, currency, recommendations: list | None = None) -> dict[str, Any]:
+    """Current display summary: value (EUR), return_pct, has_recs, broker_connected.
+
+    A caller that already has led_recommendations() passes them, so a cache miss does not
+    run the planner again.
+    """
+    global _inflight
+    cached = _cache.get(_CACHE_KEY)
+    if cached is None:
+        task = _inflight
+        if task is None or task.get_loop() is not asyncio.get_running_loop():
+            task = _inflight = asyncio.ensure_future(_rebuild(db, broker, settings, currency, recommendations))
+            task.add_done_callback(_clear_inflight)
+        # Shielded: one waiter going away (a closed SSE stream) must not cancel the others' rebuild.
+        cached = await asyncio.shield(task)
+    return {**cached, "broker_connected": bool(broker.connected)}
+
+
+def led_summary_etag(summary: dict[str, Any]) -> str:
+    """Strong ETag over the summary's content, so equal summaries share a tag."""
+    body = json.dumps(summary, sort_keys=True, separators=(",", ":")).encode()
+    return f'"{hashlib.blake2b(body, digest_size=8).hexdigest()}"'
+
+
+def etag_matches(if_none_match: str, etag: str) -> bool:
+    """Whether an If-None-Match header names etag (RFC 9110 weak comparison, "*" matches any)."""
+    tags = [tag.strip() for tag in if_none_match.split(",")]
+    return "*" in tags or etag.removeprefix("W/") in {tag.removeprefix("W/") for tag in tags}
@@ -0,0 +1,266 @@
+"""Lay the portfolio out as a treemap for the 8x13 LED matrix.
+
+The MCU only animates rectangles; everything that depends on the number of
+holdings happens here, once per refresh:
+  - a squarified treemap over position weights, snapped to the pixel grid
+  - each region's waveform (planner action), urgency (period) and P/L band
+  - the updateTreemap payload, four bytes per region
+
+See mode_treemap.h in the SentinelLED firmware library for the wire format.
+"""
+
+from __future__ import annotations
+
+from dataclasses import dataclass
+from typing import Any
+
+MATRIX_WIDTH = 13
+MATRIX_HEIGHT = 8
+
+TREEMAP_FRAME_MAGIC = 0x54  # "T"
+TREEMAP_FRAME_VERSION = 1
+TREEMAP_FRAME_HEADER_SIZE = 3
+TREEMAP_REGION_SIZE = 4
+# Keeps the payload inside the sketch's 128-byte MsgPack packet.
+TREEMAP_MAX_REGIONS = 24
+
+# OscWave ids (oscillator.h).
+WAVE_SINE = 0
+WAVE_SAW_UP = 1
+WAVE_SAW_DOWN = 2
+WAVE_TRIANGLE = 3
+WAVE_PULSE = 4
+
+# OscUrgency ids, slowest first: 4000, 2500, 1500, 800, 300 ms.
+URGENCY_LOW = 0
+URGENCY_NORMAL = 1
+URGENCY_ELEVATED = 2
+URGENCY_HIGH = 3
+URGENCY_URGENT = 4
+
+# Lower edges (P/L %) of bands 1..7; band 0 is everything below -20%.
+PNL_BAND_EDGES = (-20.0, -10.0, -5.0, 0.0, 5.0, 10.0, 20.0)
+
+# Planner priority of forced sells (cash deficit), shown as urgent pulses.
+URGENT_PRIORITY = 1000
+
+
+@dataclass(frozen=True)
+class TreemapHolding:
+    symbol: str
+    weight: float
+    pnl_pct: float = 0.0
+    wave: int = WAVE_SINE
+    urgency: int = URGENCY_LOW
+
+
+@dataclass(frozen=True)
+class TreemapRegion:
+    symbol: str
+    x: int
+    y: int
+    w: int
+    h: int
+    wave: int
+    urgency: int
+    band: int
+    phase: int  # start phase in 32nds of a turn
+
+
+def pnl_band(pnl_pct: float) -> int:
+    """Map a P/L percentage onto the README's brightness bands (0..7)."""
+    return sum(1 for edge in PNL_BAND_EDGES if pnl_pct >= edge)
+
+
+def _worst_ratio(row: list[float], side: float) -> float:
+    total = sum(row)
+    return max(max(side * side * a / (total * total), (total * total) / (side * side * a)) for a in row)
+
+
+def squarify(weights: list[float], width: float, height: float) -> list[tuple[float, float, float, float]]:
+    """Squarified treemap (Bruls et al.) of weights over a width x height area.
+
+    Weights must be positive and sorted largest first. Returns (x, y, w, h) per
+    weight, in input order. Neighbouring rectangles share edge coordinates
+    exactly, so rounding them keeps the tiling gap-free.
+    """
+    total = sum(weights)
+    if total <= 0:
+        return []
+    areas = [w / total * width * height for w in weights]
+
+    rects: list[tuple[float, float, float, float]] = []
+    x, y, w, h = 0.0, 0.0, float(width), float(height)
+    i = 0
+    while i < len(areas):
+        side = min(w, h)
+        row = [areas[i]]
+        j = i + 1
+        while j < len(areas) and _worst_ratio(row + [areas[j]], side) <= _worst_ratio(row, side):
+            row.append(areas[j])
+            j += 1
+
+        row_area = sum(row)
+        if w >= h:
+            # Lay the row as a column along the left edge.
+            col_w = row_area / h if j < len(areas) else w
+            cy = y
+            for a in row:
+                rh = a / col_w
+                rects.append((x, cy, col_w, rh))
+                cy += rh
+            x += col_w
+            w -= col_w
+        else:
+            row_h = row_area / w if j < len(areas) else h
+            cx = x
+            for a in row:
+                rw = a / row_h
+                rects.append((cx, y, rw, row_h))
+                cx += rw
+            y += row_h
+            h -= row_h
+        i = j
+    return rects
+
+
+def _fold_tail(holdings: list[TreemapHolding], max_regions: int) -> list[TreemapHolding]:
+    """Keep the largest max_regions - 1 holdings and merge the rest into one."""
+    if len(holdings) <= max_regions:
+        return holdings
+    head, tail = holdings[: max_regions - 1], holdings[max_regions - 1 :]
+    weight = sum(h.weight for h in tail)
+    pnl = sum(h.pnl_pct * h.weight for h in tail) / weight if weight > 0 else 0.0
+    return head + [TreemapHolding(symbol="OTHER", weight=weight, pnl_pct=pnl)]
+
+
+def layout_treemap(
+    holdings: list[TreemapHolding],
+    *,
+    width: int = MATRIX_WIDTH,
+    height: int = MATRIX_HEIGHT,
+    max_regions: int = TREEMAP_MAX_REGIONS,
+) -> list[TreemapRegion]:
+    """Lay holdings out on the pixel grid; holdings too small for a pixel are dropped."""
+    ranked = sorted((h for h in holdings if h.weight > 0), key=lambda h: h.weight, reverse=True)
+    ranked = _fold_tail(ranked, max_regions)
+    rects = squarify([h.weight for h in ranked], width, height)
+
+    regions: list[TreemapRegion] = []
+    for index, (holding, (fx, fy, fw, fh)) in enumerate(zip(ranked, rects, strict=True)):
+        x0, y0 = round(fx), round(fy)
+        x1, y1 = min(width, round(fx + fw)), min(height, round(fy + fh))
+        if x1 <= x0 or y1 <= y0:
+            continue
+        regions.append(
+            TreemapRegion(
+                symbol=holding.symbol,
+                x=x0,
+                y=y0,
+                w=x1 - x0,
+                h=y1 - y0,
+                wave=holding.wave,
+                urgency=holding.urgency,
+                band=pnl_band(holding.pnl_pct),
+                # Stagger start phases so equal regions do not pulse in lockstep.
+                phase=(index * 7) % 32,
+            )
+        )
+    return regions
+
+
+def encode_treemap_frame(regions: list[TreemapRegion]) -> bytes:
+    """Pack regions into the updateTreemap payload."""
+    if len(regions) > TREEMAP_MAX_REGIONS:
+        raise ValueError(f"at most {TREEMAP_MAX_REGIONS} regions per frame")
+
+    out = bytearray((TREEMAP_FRAME_MAGIC, TREEMAP_FRAME_VERSION, len(regions)))
+    for r in regions:
+        if not (0 <= r.x and 1 <= r.w and r.x + r.w <= MATRIX_WIDTH):
+            raise ValueError(f"region {r.symbol} does not fit the matrix width")
+        if not (0 <= r.y and 1 <= r.h and r.y + r.h <= MATRIX_HEIGHT):
+            raise ValueError(f"region {r.symbol} does not fit the matrix height")
+        out.append(r.x << 4 | (r.w - 1))
+        out.append(r.y << 4 | (r.h - 1))
+        out.append((r.wave & 0x0F) << 4 | (r.urgency & 0x0F))
+        out.append((r.band & 0x07) << 5 | (r.phase & 0x1F))
+    return bytes(out)
+
+
+def decode_treemap_frame(data: bytes) -> list[TreemapRegion]:
+    """Inverse of encode_treemap_frame; symbols are not on the wire and come back empty."""
+    if len(data) < TREEMAP_FRAME_HEADER_SIZE:
+        raise ValueError("treemap frame too short")
+    magic, version, count = data[:TREEMAP_FRAME_HEADER_SIZE]
+    if magic != TREEMAP_FRAME_MAGIC or version != TREEMAP_FRAME_VERSION:
+        raise ValueError("not a treemap frame")
+    if len(data) != TREEMAP_FRAME_HEADER_SIZE + count * TREEMAP_REGION_SIZE:
+        raise ValueError("treemap frame length does not match count")
+
+    regions = []
+    for i in range(count):
+        b0, b1, b2, b3 = data[TREEMAP_FRAME_HEADER_SIZE + i * TREEMAP_REGION_SIZE :][:TREEMAP_REGION_SIZE]
+        regions.append(
+            TreemapRegion(
+                symbol="",
+                x=b0 >> 4,
+                y=b1 >> 4,
+                w=(b0 & 0x0F) + 1,
+                h=(b1 & 0x0F) + 1,
+                wave=b2 >> 4,
+                urgency=b2 & 0x0F,
+                band=b3 >> 5,
+                phase=b3 & 0x1F,
+            )
+        )
+    return regions
+
+
+def build_holdings(positions: list[dict[str, Any]], recommendations: list[Any]) -> list[TreemapHolding]:
+    """Turn DB positions and planner recommendations into treemap holdings.
+
+    Weight is the position's market value. A holding without a recommendation
+    is a slow sine; buys are rising saws, sells falling saws, convergence
+    fallbacks triangles (rebalance) and forced sells urgent pulses. Other
+    recommendations get NORMAL..HIGH urgency by priority rank.
+    """
+    recs = {}
+    for rec in recommendations or []:
+        sym = getattr(rec, "symbol", None)
+        if sym:
+            recs[str(sym)] = rec
+
+    ranked = sorted(
+        (r for r in recs.values() if float(getattr(r, "priority", 0) or 0) < URGENT_PRIORITY),
+        key=lambda r: float(getattr(r, "priority", 0) or 0),
+        reverse=True,
+    )
+    rank_urgency = {}
+    for i, rec in enumerate(ranked):
+        third = i * 3 // len(ranked)
+        rank_urgency[str(rec.symbol)] = (URGENCY_HIGH, URGENCY_ELEVATED, URGENCY_NORMAL)[third]
+
+    holdings = []
+    for p in positions:
+        sym = str(p["symbol"])
+        qty = float(p.get("quantity") or 0.0)
+        price = float(p.get("current_price") or 0.0)
+        avg_cost = float(p.get("avg_cost") or 0.0)
+        value = max(0.0, qty * price)
+        pnl_pct = (price - avg_cost) / avg_cost * 100 if avg_cost > 0 and price > 0 else 0.0
+
+        wave, urgency = WAVE_SINE, URGENCY_LOW
+        rec = recs.get(sym)
+        if rec is not None:
+            if float(getattr(rec, "priority", 0) or 0) >= URGENT_PRIORITY:
+                wave, urgency = WAVE_PULSE, URGENCY_URGENT
+            else:
+                if getattr(rec, "reason_code", None) == "convergence_fallback":
+                    wave = WAVE_TRIANGLE
+                elif rec.action == "sell":
+                    wave = WAVE_SAW_DOWN
+                else:
+                    wave = WAVE_SAW_UP
+                urgency = rank_urgency[sym]
+        holdings.append(TreemapHolding(symbol=sym, weight=value, pnl_pct=pnl_pct, wave=wave, urgency=urgency))
+    return holdings
@@ -99,6 +99,7 @@ DEFAULTS = {
     # LED Display (Arduino UNO Q orbital visualization)
     "led_display_enabled": False,  # Disabled by default for dev environments
     "led_brightness": 200,  # Global LED brightness 0-255
+    "led_mode": "abacus",  # Active MCU renderer, one of LED_MODES in sentinel/api/routers/settings.py
     # Cloudflare R2 Backup
     "r2_account_id": "",
     "r2_access_key": "",
@@ -143,6 +143,16 @@ class TestSyncPrices:
 
         assert mock_db.save_prices.await_count == 2
 
+    @pytest.mark.asyncio
+    async def test_sync_prices_invalidates_led_summary(self, mock_db, mock_broker, mock_cache):
+        """Verify the LED summary is rebuilt from the new prices."""
+        from sentinel.jobs.tasks import sync_prices
+
+        with patch("sentinel.jobs.tasks.invalidate_led_summary") as invalidate:
+            await sync_prices(mock_db, mock_broker, mock_cache)
+
+        invalidate.assert_called_once()
+
     @pytest.mark.asyncio
     async def test_sync_prices_fetches_in_chunks(self, mock_db, mock_broker, mock_cache):
         """Avoid one huge Tradernet history request for the whole active universe."""
@@ -52,6 +52,8 @@ async def test_led_bridge_health_defaults(temp_db_path):
     assert payload["last_success_at"] is None
     assert payload["is_stale"] is True
     assert payload["stale_threshold_seconds"] == 600
+    assert payload["last_sent_seq"] is None
+    assert payload["last_acked_seq"] is None
 
 
 @pytest.mark.asyncio
@@ -112,3 +114,103 @@ async def test_led_status_includes_bridge_health(temp_db_path):
     assert bridge["is_stale"] is True
     assert bridge["last_error"] == "Request 'hm.u' timed out after 10s"
     assert isinstance(status_payload["broker_connected"], bool)
+
+
+@pytest.mark.asyncio
+async def test_led_bridge_health_tracks_push_sequence(temp_db_path):
+    client = _build_client()
+    now = int(time.time())
+    body = {
+        "bridge_ok": False,
+        "last_attempt_ts": now,
+        "last_success_ts": now - 30,
+        "consecutive_failures": 1,
+        "last_error": "seq 42 not applied (MCU at 40)",
+        "last_sent_seq": 42,
+        "last_acked_seq": 40,
+    }
+    resp = client.post("/api/led/bridge/health", json=body)
+    assert resp.status_code == 200
+
+    read_payload = client.get("/api/led/bridge/health").json()
+    assert read_payload["last_sent_seq"] == 42
+    assert read_payload["last_acked_seq"] == 40
+
+
+@pytest.mark.asyncio
+async def test_led_bridge_health_keeps_mcu_stats(temp_db_path):
+    client = _build_client()
+    body = {
+        "bridge_ok": True,
+        "last_success_ts": int(time.time()),
+        "mcu_stats": {
+            "version": 1,
+            "window_ms": 60000,
+            "render_p99_us": 840,
+            "rpc_rejected": 2,
+            "stack_free_bytes": None,
+            "frames_elided": 41,
+            "unknown_counter": 7,
+        },
+    }
+    resp = client.post("/api/led/bridge/health", json=body)
+    assert resp.status_code == 200
+
+    stats = client.get("/api/led/bridge/health").json()["mcu_stats"]
+    assert stats["version"] == 1
+    assert stats["render_p99_us"] == 840
+    assert stats["rpc_rejected"] == 2
+    assert stats["stack_free_bytes"] is None
+    assert stats["heap_free_bytes"] is None
+    assert stats["frames_elided"] == 41
+    assert stats["frames_shown"] is None
+    assert "unknown_counter" not in stats
+
+
+@pytest.mark.asyncio
+async def test_led_bridge_health_without_mcu_stats(temp_db_path):
+    client = _build_client()
+    resp = client.post("/api/led/bridge/health", json={"bridge_ok": False})
+    assert resp.status_code == 200
+    assert resp.json()["mcu_stats"] is None
+
+
+@pytest.mark.asyncio
+async def test_led_bridge_health_keeps_recovery(temp_db_path):
+    client = _build_client()
+    now = int(time.time())
+    body = {
+        "bridge_ok": True,
+        "last_success_ts": now,
+        "recovery": {
+            "trigger": "consecutive_bridge_failures",
+            "started_ts": now - 4,
+            "in_progress": False,
+            "recovered_stage": "mcu_reset",
+            "time_to_recover_ms": 3140,
+            "stages": [
+                {"stage": "reconnect", "ok": False, "duration_ms": 820},
+                {"stage": "reboot_router", "ok": True, "duration_ms": 1},
+                {"stage": "mcu_reset", "ok": True, "duration_ms": 2320},
+            ],
+        },
+    }
+    resp = client.post("/api/led/bridge/health", json=body)
+    assert resp.status_code == 200
+
+    recovery = client.get("/api/led/bridge/health").json()["recovery"]
+    assert recovery["trigger"] == "consecutive_bridge_failures"
+    assert recovery["started_at"] is not None
+    assert recovery["in_progress"] is False
+    assert recovery["recovered_stage"] == "mcu_reset"
+    assert recovery["time_to_recover_ms"] == 3140
+    assert [s["stage"] for s in recovery["stages"]] == ["reconnect", "mcu_reset"]
+    assert recovery["stages"][1]["ok"] is True
+
+
+@pytest.mark.asyncio
+async def test_led_bridge_health_without_recovery(temp_db_path):
+    client = _build_client()
+    resp = client.post("/api/led/bridge/health", json={"bridge_ok": True})
+    assert resp.status_code == 200
+    assert resp.json()["recovery"] is None
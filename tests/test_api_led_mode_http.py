@@ -0,0 +1,99 @@
+"""HTTP-level tests for the LED renderer mode endpoints."""
+
+import os
+import tempfile
+
+import pytest
+import pytest_asyncio
+from fastapi import FastAPI
+from fastapi.testclient import TestClient
+
+from sentinel.api.routers.settings import led_router
+from sentinel.database import Database
+from sentinel.settings import Settings
+
+
+@pytest_asyncio.fixture
+async def temp_db_path():
+    fd, path = tempfile.mkstemp(suffix=".db")
+    os.close(fd)
+
+    db = Database(path)
+    await db.connect()
+    settings = Settings()
+    settings._db = db
+    await settings.init_defaults()
+
+    yield path
+
+    await db.close()
+    db.remove_from_cache()
+    for ext in ["", "-wal", "-shm"]:
+        p = path + ext
+        if os.path.exists(p):
+            os.unlink(p)
+
+
+def _build_client() -> TestClient:
+    app = FastAPI()
+    app.include_router(led_router, prefix="/api")
+    return TestClient(app)
+
+
+@pytest.mark.asyncio
+async def test_led_mode_defaults_to_abacus(temp_db_path):
+    client = _build_client()
+    resp = client.get("/api/led/mode")
+    assert resp.status_code == 200
+    payload = resp.json()
+    assert payload["mode"] == "abacus"
+    assert payload["mode_id"] == 0
+    assert payload["modes"] == ["abacus", "orbital", "heatmap", "treemap", "anim"]
+
+
+@pytest.mark.asyncio
+async def test_led_mode_set_and_read(temp_db_path):
+    client = _build_client()
+    resp = client.put("/api/led/mode", json={"mode": "heatmap"})
+    assert resp.status_code == 200
+    assert resp.json()["mode_id"] == 2
+
+    payload = client.get("/api/led/mode").json()
+    assert payload["mode"] == "heatmap"
+    assert payload["mode_id"] == 2
+
+
+@pytest.mark.asyncio
+async def test_led_mode_rejects_unknown(temp_db_path):
+    client = _build_client()
+    resp = client.put("/api/led/mode", json={"mode": "spiral"})
+    assert resp.status_code == 400
+
+    assert client.get("/api/led/mode").json()["mode"] == "abacus"
+
+
+@pytest.mark.asyncio
+async def test_led_anim_stores_a_valid_program(temp_db_path):
+    client = _build_client()
+    resp = client.put("/api/led/anim", json={"source": "LD X\nPUSH 30\nMUL\nLD P3\nPUSH 0\nOUT", "params": [200]})
+    assert resp.status_code == 200
+    payload = resp.json()
+    assert payload["params"] == [200]
+    assert payload["code_bytes"] == 10
+
+    resp = client.put("/api/led/anim", json={"frame_ms": 0})
+    assert resp.status_code == 200
+    assert resp.json()["source"].startswith("LD X")
+
+
+@pytest.mark.asyncio
+async def test_led_anim_rejects_what_the_mcu_would(temp_db_path):
+    client = _build_client()
+    resp = client.put("/api/led/anim", json={"source": "ADD\nOUT"})
+    assert resp.status_code == 400
+    assert "stack underflow" in resp.json()["detail"]
+
+    assert client.put("/api/led/anim", json={"frame_ms": 5}).status_code == 400
+    # Longer sleeps would starve the MCU's render-fed watchdog.
+    assert client.put("/api/led/anim", json={"frame_ms": 8000}).status_code == 400
+    assert client.put("/api/led/anim", json={"params": [1, 2, 3, 4, 5, 6]}).status_code == 400
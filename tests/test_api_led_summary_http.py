@@ -0,0 +1,159 @@
+"""HTTP-level tests for the cached /api/led/summary endpoint."""
+
+import asyncio
+import os
+import tempfile
+
+import pytest
+import pytest_asyncio
+from fastapi import FastAPI
+from fastapi.testclient import TestClient
+
+import sentinel.led.summary as led_summary
+from sentinel.api.dependencies import CommonDependencies
+from sentinel.api.routers.settings import get_common_deps, led_router
+from sentinel.broker import Broker
+from sentinel.currency import Currency
+from sentinel.database import Database
+from sentinel.settings import Settings
+
+
+@pytest_asyncio.fixture
+async def deps():
+    fd, path = tempfile.mkstemp(suffix=".db")
+    os.close(fd)
+    db = Database(path)
+    await db.connect()
+
+    settings = Settings()
+    settings._db = db
+    await settings.init_defaults()
+
+    yield CommonDependencies(
+        db=db,
+        settings=settings,
+        broker=Broker(),
+        currency=Currency(),
+    )
+
+    await db.close()
+    db.remove_from_cache()
+    for ext in ["", "-wal", "-shm"]:
+        p = path + ext
+        if os.path.exists(p):
+            os.unlink(p)
+
+
+@pytest.fixture
+def builds(monkeypatch):
+    """Replace the expensive summary build with a counted, settable one."""
+    state = {"count": 0, "summary": {"value": 48210, "return_pct": 7, "has_recs": True}}
+
+    async def fake_build(db, broker, settings, currency, recommendations=None):
+        state["count"] += 1
+        summary = dict(state["summary"])
+        await asyncio.sleep(state.get("delay", 0))
+        return summary
+
+    monkeypatch.setattr(led_summary, "_build", fake_build)
+    monkeypatch.setattr(Broker, "connected", property(lambda self: True))
+    led_summary.invalidate_led_summary()
+    yield state
+    led_summary.invalidate_led_summary()
+
+
+def _build_client(deps: CommonDependencies) -> TestClient:
+    app = FastAPI()
+    app.include_router(led_router, prefix="/api")
+
+    async def override_deps():
+        return deps
+
+    app.dependency_overrides[get_common_deps] = override_deps
+    return TestClient(app)
+
+
+@pytest.mark.asyncio
+async def test_led_summary_returns_display_fields(deps, builds):
+    client = _build_client(deps)
+    resp = client.get("/api/led/summary")
+    assert resp.status_code == 200
+    assert resp.json() == {"value": 48210, "return_pct": 7, "has_recs": True, "broker_connected": True}
+    assert resp.headers["ETag"].startswith('"')
+
+
+@pytest.mark.asyncio
+async def test_led_summary_not_modified_for_matching_etag(deps, builds):
+    client = _build_client(deps)
+    etag = client.get("/api/led/summary").headers["ETag"]
+
+    resp = client.get("/api/led/summary", headers={"If-None-Match": etag})
+    assert resp.status_code == 304
+    assert resp.headers["ETag"] == etag
+    assert resp.content == b""
+    assert builds["count"] == 1
+
+
+@pytest.mark.asyncio
+async def test_led_summary_rebuilds_after_invalidation(deps, builds):
+    client = _build_client(deps)
+    etag = client.get("/api/led/summary").headers["ETag"]
+
+    builds["summary"]["value"] = 48999
+    # Still cached: the job that changed the value has not invalidated yet.
+    assert client.get("/api/led/summary", headers={"If-None-Match": etag}).status_code == 304
+
+    led_summary.invalidate_led_summary()
+    resp = client.get("/api/led/summary", headers={"If-None-Match": etag})
+    assert resp.status_code == 200
+    assert resp.json()["value"] == 48999
+    assert resp.headers["ETag"] != etag
+    assert builds["count"] == 2
+
+
+@pytest.mark.asyncio
+async def test_led_summary_broker_flag_is_live(deps, builds, monkeypatch):
+    client = _build_client(deps)
+    etag = client.get("/api/led/summary").headers["ETag"]
+
+    monkeypatch.setattr(Broker, "connected", property(lambda self: False))
+    resp = client.get("/api/led/summary", headers={"If-None-Match": etag})
+    assert resp.status_code == 200
+    assert resp.json()["broker_connected"] is False
+    assert builds["count"] == 1
+
+
+@pytest.mark.asyncio
+async def test_led_summary_concurrent_misses_build_once(deps, builds):
+    builds["delay"] = 0.05
+    results = await asyncio.gather(
+        *(led_summary.get_led_summary(deps.db, deps.broker, deps.settings, deps.currency) for _ in range(8))
+    )
+    assert builds["count"] == 1
+    assert all(r["value"] == 48210 for r in results)
+
+
+@pytest.mark.asyncio
+async def test_led_summary_invalidation_during_build_is_not_cached(deps, builds):
+    builds["delay"] = 0.05
+    stale = asyncio.ensure_future(led_summary.get_led_summary(deps.db, deps.broker, deps.settings, deps.currency))
+    await asyncio.sleep(0.01)  # the first build has read the old value
+    builds["summary"]["value"] = 48999
+    led_summary.invalidate_led_summary()
+    fresh = await led_summary.get_led_summary(deps.db, deps.broker, deps.settings, deps.currency)
+    assert (await stale)["value"] == 48210
+    assert fresh["value"] == 48999
+    assert builds["count"] == 2
+    builds["delay"] = 0
+    assert (await led_summary.get_led_summary(deps.db, deps.broker, deps.settings, deps.currency))["value"] == 48999
+    assert builds["count"] == 2
+
+
+def test_etag_matches_parses_if_none_match():
+    etag = '"abc123"'
+    assert led_summary.etag_matches('"abc123"', etag)
+    assert led_summary.etag_matches('"x", W/"abc123"', etag)
+    assert led_summary.etag_matches("*", etag)
+    assert not led_summary.etag_matches('"abc1234"', etag)
+    assert not led_summary.etag_matches('"xabc123", "abc"', etag)
+    assert not led_summary.etag_matches("", etag)
@@ -0,0 +1,64 @@
+"""Golden-frame and benchmark checks for the LED firmware's host-native build.
+
+firmware/native compiles the multi-mode sketch and the SentinelLED renderers
+against stub Arduino/Bridge/Zephyr headers, drives a fixed scenario on a
+virtual clock and prints every frame pushed to the shield and the matrix.
+Any pixel change shows up as a diff against golden/multimode.txt; after an
+intended change, regenerate it with `make -C firmware/native golden-update`.
+"""
+
+import shutil
+import subprocess
+from pathlib import Path
+
+import pytest
+
+NATIVE_DIR = Path(__file__).resolve().parents[1] / "firmware" / "native"
+BINARY = NATIVE_DIR / "build" / "sentinel_native"
+GOLDEN = NATIVE_DIR / "golden" / "multimode.txt"
+
+pytestmark = pytest.mark.skipif(
+    shutil.which("make") is None or shutil.which("g++") is None,
+    reason="native firmware build needs make and g++",
+)
+
+
+def _build() -> None:
+    subprocess.run(["make", "-C", str(NATIVE_DIR), "--quiet", "all"], check=True, capture_output=True)
+
+
+def _run(*args: str) -> str:
+    _build()
+    result = subprocess.run([str(BINARY), *args], check=True, capture_output=True, text=True)
+    return result.stdout
+
+
+def test_frames_match_golden():
+    frames = _run("golden").splitlines()
+    expected = GOLDEN.read_text().splitlines()
+    for i, (got, want) in enumerate(zip(frames, expected)):
+        assert got == want, f"golden line {i + 1} differs:\n  got:  {got}\n  want: {want}"
+    assert len(frames) == len(expected)
+
+
+def test_golden_covers_every_mode_and_output():
+    frames = _run("golden").splitlines()
+    pushed = {tuple(line.split()[1:3]) for line in frames if line.startswith("t=")}
+    assert ("mode=0", "shield") in pushed
+    assert ("mode=1", "matrix") in pushed
+    assert ("mode=2", "shield") in pushed
+    assert ("mode=3", "matrix") in pushed  # treemap
+    assert ("mode=4", "shield") in pushed  # anim
+    assert {"mode.get=3", "mode.get=4"} <= set(frames)
+    assert "watchdog fed=1 quiet=1 bridge stalled=0 no frame=0" in frames
+    assert "orbital 1 fps matches 50 fps=1" in frames
+    assert "hm.s applied=4 rejected=1 skipped=2" in frames
+
+
+def test_bench_reports_every_case():
+    rows = [line.rsplit(None, 2) for line in _run("bench", "200").splitlines()]
+    names = {row[0] for row in rows}
+    assert {"abacus apply+render", "orbital render (40 bodies)", "heatmap render", "decode hm.b"} <= names
+    for _, ns, unit in rows:
+        assert unit == "ns/op"
+        assert float(ns) > 0
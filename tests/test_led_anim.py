@@ -0,0 +1,163 @@
+"""Tests for the LED animation VM assembler and anim.load / anim.set codecs."""
+
+import pytest
+
+from sentinel.led.anim import (
+    ANIM_CHUNK_HEADER_SIZE,
+    ANIM_CHUNK_MAX,
+    ANIM_CODE_MAX,
+    ANIM_HEADER_SIZE,
+    ANIM_MAGIC,
+    ANIM_MAX_FRAME_MS,
+    ANIM_PIXEL_BUDGET,
+    DEFAULT_ANIM_FRAME_MS,
+    DEFAULT_ANIM_SOURCE,
+    OPS,
+    REGISTERS,
+    AnimError,
+    anim_chunks,
+    anim_program_id,
+    assemble,
+    crc16_ccitt,
+    encode_anim_image,
+    encode_anim_params,
+    summary_params,
+    verify,
+)
+
+# The colour wash of firmware/native/harness.cpp (ANIM_WASH).
+WASH = """
+    LD X
+    PUSH 7
+    EQ
+    JZ lit
+    END
+lit:
+    LD P0
+    PHASE
+    LD X
+    PUSH 8192
+    MUL
+    ADD
+    SIN
+    PUSH 8
+    SHR
+    PUSH 128
+    ADD
+    LD P1
+    LD Y
+    PUSH 50
+    MUL
+    OUT
+"""
+
+
+class TestAssemble:
+    def test_matches_firmware_harness(self):
+        code = assemble(WASH)
+        assert code[:8] == bytes([0x03, 0x00, 0x01, 0x07, 0x1D, 0x31, 0x01, 0x00])
+        assert len(code) == 34
+        # anim.s id the native golden run reports for this program at 50 ms.
+        assert anim_program_id(encode_anim_image(code, 50)) == 0x709E
+
+    def test_push_picks_width(self):
+        code = assemble("PUSH -128\nPUSH 128\nPUSH 0x10\nOUT")
+        assert code == bytes([0x01, 0x80, 0x02, 0x80, 0x00, 0x01, 0x10, 0x3F])
+
+    def test_forward_jump_skips_past_operand(self):
+        code = assemble("PUSH 1\nJZ skip\nPUSH 2\nDROP\nskip:\nEND")
+        assert code == bytes([0x01, 0x01, 0x31, 0x03, 0x01, 0x02, 0x06, 0x00])
+
+    @pytest.mark.parametrize(
+        "source, message",
+        [
+            ("FROB", "unknown instruction"),
+            ("LD Q", "unknown register"),
+            ("PUSH 1\nST P0", "not writable"),
+            ("PUSH 1\nWAVE SQUIGGLE", "unknown wave"),
+            ("PUSH 40000", "does not fit"),
+            ("ADD", "stack underflow"),
+            ("back:\nJMP back", "jumps backwards"),
+            ("JMP nowhere", "unknown label"),
+            ("OUT 1", "no operand"),
+            ("PUSH 1\nJZ a\nPUSH 2\na:\nEND", "from a jump"),
+            ("\n".join(["PUSH 1"] * 9), "stack deeper"),
+        ],
+    )
+    def test_rejects(self, source, message):
+        with pytest.raises(AnimError, match=message):
+            assemble(source)
+
+    def test_instruction_budget(self):
+        assemble("\n".join(["PUSH 1", "DROP"] * (ANIM_PIXEL_BUDGET // 2)))
+        with pytest.raises(AnimError, match="instructions per pixel"):
+            assemble("\n".join(["PUSH 1", "DROP"] * (ANIM_PIXEL_BUDGET // 2 + 1)))
+
+    def test_default_program_fits(self):
+        code = assemble(DEFAULT_ANIM_SOURCE)
+        assert len(code) <= ANIM_CODE_MAX
+        assert verify(code) <= ANIM_PIXEL_BUDGET
+
+
+class TestVerify:
+    def test_jump_into_operand(self):
+        code = bytearray(assemble(WASH))
+        code[6] = 2  # JZ lands on PUSH8's operand
+        with pytest.raises(AnimError, match="jump into an operand"):
+            verify(bytes(code))
+
+    def test_unknown_opcode_and_truncated_operand(self):
+        with pytest.raises(AnimError, match="unknown opcode"):
+            verify(bytes([0x08]))
+        with pytest.raises(AnimError, match="past the end"):
+            verify(bytes([OPS["PUSH16"].code, 0x00]))
+
+    def test_unreachable_code_is_not_stack_checked(self):
+        assert verify(assemble("END\nADD")) == 2
+
+
+class TestImage:
+    def test_layout(self):
+        code = assemble("LD X\nLD Y\nLD I\nOUT")
+        image = encode_anim_image(code, 40)
+        assert image[0] == ANIM_MAGIC
+        assert int.from_bytes(image[2:4], "little") == 40
+        assert int.from_bytes(image[4:6], "little") == len(code)
+        assert image[ANIM_HEADER_SIZE:-2] == code
+        assert int.from_bytes(image[-2:], "little") == crc16_ccitt(image[:-2])
+
+    @pytest.mark.parametrize("frame_ms", [1, 15, ANIM_MAX_FRAME_MS + 1, 8000])
+    def test_frame_ms_range(self, frame_ms):
+        with pytest.raises(AnimError):
+            encode_anim_image(assemble("END"), frame_ms)
+
+    def test_frame_ms_limits(self):
+        code = assemble("END")
+        assert int.from_bytes(encode_anim_image(code, ANIM_MAX_FRAME_MS)[2:4], "little") == ANIM_MAX_FRAME_MS
+        assert int.from_bytes(encode_anim_image(code, 0)[2:4], "little") == 0
+
+    def test_chunks_reassemble(self):
+        image = encode_anim_image(assemble(DEFAULT_ANIM_SOURCE), DEFAULT_ANIM_FRAME_MS)
+        chunks = anim_chunks(image)
+        assert len(chunks) == -(-len(image) // ANIM_CHUNK_MAX)
+        rebuilt = b""
+        for chunk in chunks:
+            assert len(chunk) <= ANIM_CHUNK_HEADER_SIZE + ANIM_CHUNK_MAX
+            assert int.from_bytes(chunk[0:2], "little") == len(rebuilt)
+            assert int.from_bytes(chunk[2:4], "little") == len(image)
+            rebuilt += chunk[ANIM_CHUNK_HEADER_SIZE:]
+        assert rebuilt == image
+
+
+class TestParams:
+    def test_encode_clamps_and_sorts(self):
+        assert encode_anim_params({3: 70000, 0: -1}) == bytes([0, 0xFF, 0xFF, 3, 0xFF, 0x7F])
+
+    def test_encode_rejects_unknown_index(self):
+        with pytest.raises(AnimError):
+            encode_anim_params({8: 1})
+
+    def test_summary_params(self):
+        summary = {"value": 9000, "return_pct": -4, "has_recs": True, "broker_connected": False}
+        assert summary_params(summary) == {0: -4, 1: 1, 2: 0}
+        assert REGISTERS["P0"] == 8
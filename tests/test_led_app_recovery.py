@@ -0,0 +1,71 @@
+"""Tests for the UNO Q LED app's bridge recovery ladder (arduino-app/sentinel/python/main.py)."""
+
+import importlib.util
+import sys
+import types
+from pathlib import Path
+
+import pytest
+
+MAIN_PY = Path(__file__).resolve().parents[1] / "arduino-app" / "sentinel" / "python" / "main.py"
+
+
+class FakeBridge:
+    """arduino.app_utils.Bridge without any reconnect hooks."""
+
+    calls: list = []
+
+    @classmethod
+    def call(cls, method, *args, timeout=None):
+        cls.calls.append(method)
+        return True
+
+
+@pytest.fixture
+def app(monkeypatch):
+    app_utils = types.ModuleType("arduino.app_utils")
+    app_utils.App = object
+    app_utils.Bridge = FakeBridge
+    monkeypatch.setitem(sys.modules, "arduino", types.ModuleType("arduino"))
+    monkeypatch.setitem(sys.modules, "arduino.app_utils", app_utils)
+    if importlib.util.find_spec("requests") is None:
+        # The app image ships requests; the sentinel test env need not.
+        requests = types.ModuleType("requests")
+        requests.Session = lambda: types.SimpleNamespace(headers={})
+        monkeypatch.setitem(sys.modules, "requests", requests)
+    spec = importlib.util.spec_from_file_location("led_app_main", MAIN_PY)
+    module = importlib.util.module_from_spec(spec)
+    monkeypatch.setitem(sys.modules, spec.name, module)  # dataclasses resolve annotations through it
+    spec.loader.exec_module(module)
+    monkeypatch.setattr(module, "_report_bridge_health", lambda *a, **kw: None)
+    FakeBridge.calls = []
+    return module
+
+
+def test_reopen_without_hooks_raises(app):
+    with pytest.raises(RuntimeError):
+        app._reopen_bridge()
+
+
+def test_reopen_uses_available_hooks(app, monkeypatch):
+    used = []
+    monkeypatch.setattr(FakeBridge, "close", lambda: used.append("close"), raising=False)
+    monkeypatch.setattr(FakeBridge, "connect", lambda: used.append("connect"), raising=False)
+    app._reopen_bridge()
+    assert used == ["close", "connect"]
+
+
+def test_recover_escalates_past_unsupported_reconnect(app, monkeypatch):
+    resets = []
+    monkeypatch.setattr(app, "_reset_mcu", lambda: resets.append(True))
+    monkeypatch.setattr(app, "_RECOVERY_LADDER", (("reconnect", app._reopen_bridge), ("mcu_reset", app._reset_mcu)))
+    monkeypatch.setattr(app, "_force_restart", lambda reason: pytest.fail(f"restarted: {reason}"))
+
+    app._recover("stalled")
+
+    recovery = app._runtime.last_recovery
+    assert [(s["stage"], s["ok"]) for s in recovery["stages"]] == [("reconnect", False), ("mcu_reset", True)]
+    assert recovery["recovered_stage"] == "mcu_reset"
+    assert resets == [True]
+    # The reconnect stage never probed the old socket.
+    assert FakeBridge.calls == ["hm.s"]
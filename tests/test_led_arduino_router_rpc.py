@@ -0,0 +1,193 @@
+"""Tests for the multiplexed arduino-router MsgPack-RPC connection."""
+
+import asyncio
+import os
+import shutil
+import tempfile
+
+import pytest
+import pytest_asyncio
+
+from sentinel.led import msgpack_lite as msgpack
+from sentinel.led.arduino_router_rpc import NOTIFY, REQUEST, RESPONSE, AsyncMsgpackRpc, RpcError
+
+
+class _Peer:
+    """The router end of the socket: reads and writes raw MsgPack-RPC messages."""
+
+    def __init__(self, reader: asyncio.StreamReader, writer: asyncio.StreamWriter):
+        self.reader = reader
+        self.writer = writer
+        self._unpacker = msgpack.Unpacker()
+
+    async def recv(self):
+        while True:
+            for msg in self._unpacker:
+                return msg
+            data = await asyncio.wait_for(self.reader.read(4096), 2)
+            if not data:
+                raise ConnectionError("closed")
+            self._unpacker.feed(data)
+
+    async def send(self, msg) -> None:
+        self.writer.write(msgpack.packb(msg))
+        await self.writer.drain()
+
+
+@pytest_asyncio.fixture
+async def router():
+    tmpdir = tempfile.mkdtemp()
+    path = os.path.join(tmpdir, "router.sock")
+    peers: asyncio.Queue = asyncio.Queue()
+
+    async def on_connect(reader, writer):
+        await peers.put(_Peer(reader, writer))
+
+    server = await asyncio.start_unix_server(on_connect, path=path)
+    rpc = AsyncMsgpackRpc(path)
+    await rpc.connect()
+    peer = await asyncio.wait_for(peers.get(), 2)
+
+    yield rpc, peer
+
+    await rpc.close()
+    peer.writer.close()
+    server.close()
+    await server.wait_closed()
+    shutil.rmtree(tmpdir, ignore_errors=True)
+
+
+@pytest.mark.asyncio
+async def test_concurrent_calls_resolve_out_of_order(router):
+    rpc, peer = router
+    first = asyncio.create_task(rpc.call("a", 1))
+    second = asyncio.create_task(rpc.call("b", 2))
+
+    req_a = await peer.recv()
+    req_b = await peer.recv()
+    assert req_a[0] == REQUEST and req_a[2] == "a" and req_a[3] == [1]
+    assert req_b[0] == REQUEST and req_b[2] == "b" and req_b[3] == [2]
+    assert req_a[1] != req_b[1]
+
+    await peer.send([RESPONSE, req_b[1], None, "B"])
+    await peer.send([RESPONSE, req_a[1], None, "A"])
+    assert await second == "B"
+    assert await first == "A"
+
+
+@pytest.mark.asyncio
+async def test_error_response_raises_rpc_error(router):
+    rpc, peer = router
+    call = asyncio.create_task(rpc.call("boom"))
+    req = await peer.recv()
+    await peer.send([RESPONSE, req[1], [3, "nope"], None])
+    with pytest.raises(RpcError) as exc:
+        await call
+    assert exc.value.code == 3
+    assert exc.value.message == "nope"
+
+
+@pytest.mark.asyncio
+async def test_incoming_requests_are_served_concurrently(router):
+    rpc, peer = router
+    release = asyncio.Event()
+    started = []
+
+    async def slow(params):
+        started.append(params[0])
+        await release.wait()
+        return params[0] * 10
+
+    rpc.add_method("slow", slow)
+    rpc.add_method("fast", lambda params: "pong")
+
+    await peer.send([REQUEST, 1, "slow", [1]])
+    await peer.send([REQUEST, 2, "slow", [2]])
+    await peer.send([REQUEST, 3, "fast", []])
+
+    # The fast request is answered while both slow ones are still running.
+    assert await peer.recv() == [RESPONSE, 3, None, "pong"]
+    assert sorted(started) == [1, 2]
+
+    release.set()
+    responses = {tuple(m[:2]): m for m in [await peer.recv(), await peer.recv()]}
+    assert responses[(RESPONSE, 1)][3] == 10
+    assert responses[(RESPONSE, 2)][3] == 20
+
+
+@pytest.mark.asyncio
+async def test_unknown_method_and_handler_errors_are_reported(router):
+    rpc, peer = router
+
+    def broken(params):
+        raise ValueError("bad params")
+
+    rpc.add_method("broken", broken)
+    await peer.send([REQUEST, 7, "missing", []])
+    assert (await peer.recv())[2] == [0xFF, "unknown method: missing"]
+    await peer.send([REQUEST, 8, "broken", []])
+    assert (await peer.recv())[2] == [0xFF, "bad params"]
+
+
+@pytest.mark.asyncio
+async def test_notify_and_incoming_notifications(router):
+    rpc, peer = router
+    got = asyncio.Event()
+
+    async def tick(params):
+        got.set()
+
+    rpc.add_method("tick", tick)
+
+    await rpc.notify("hm.b", b"\x01")
+    assert await peer.recv() == [NOTIFY, "hm.b", [b"\x01"]]
+
+    await peer.send([NOTIFY, "tick", []])
+    await asyncio.wait_for(got.wait(), 2)
+
+
+@pytest.mark.asyncio
+async def test_disconnect_fails_pending_calls(router):
+    rpc, peer = router
+    call = asyncio.create_task(rpc.call("never"))
+    await peer.recv()
+    peer.writer.close()
+    with pytest.raises(ConnectionError):
+        await call
+    with pytest.raises(ConnectionError):
+        await rpc.serve_forever()
+
+
+@pytest.mark.asyncio
+async def test_corrupt_stream_fails_pending_calls(router):
+    rpc, peer = router
+    call = asyncio.create_task(rpc.call("never"))
+    await peer.recv()
+    peer.writer.write(b"\xc1")  # never a valid MsgPack type byte
+    await peer.writer.drain()
+    with pytest.raises(ConnectionError):
+        await asyncio.wait_for(call, 2)
+    assert not rpc.connected
+    with pytest.raises(ConnectionError):
+        await rpc.call("later", timeout=2)
+
+
+@pytest.mark.asyncio
+async def test_full_backlog_replies_busy(router):
+    rpc, peer = router
+    rpc._max_backlog = 2  # noqa: SLF001
+    release = asyncio.Event()
+
+    async def slow(params):
+        await release.wait()
+        return params[0]
+
+    rpc.add_method("slow", slow)
+    for msgid in (1, 2, 3):
+        await peer.send([REQUEST, msgid, "slow", [msgid]])
+
+    busy = await peer.recv()
+    assert busy[:2] == [RESPONSE, 3]
+    assert "busy" in busy[2][1]
+    release.set()
+    assert sorted([(await peer.recv())[3], (await peer.recv())[3]]) == [1, 2]
@@ -0,0 +1,84 @@
+"""Tests for the non-blocking LED text bridge."""
+
+import asyncio
+import threading
+import time
+
+import pytest
+
+from sentinel.led.bridge import LEDBridge
+
+
+class FakeBridge:
+    """Stands in for arduino.app_utils.Bridge; call() blocks like the real one."""
+
+    def __init__(self, delay: float = 0.0, result=True):
+        self.delay = delay
+        self.result = result
+        self.calls = []
+        self.threads = set()
+
+    def call(self, method, *args, timeout=None):
+        self.calls.append((method, args, timeout))
+        self.threads.add(threading.get_ident())
+        time.sleep(self.delay)
+        if method == "text.s":
+            return [2, 5, 1]
+        return self.result
+
+
+def _connected(fake: FakeBridge) -> LEDBridge:
+    bridge = LEDBridge()
+    bridge._bridge = fake
+    bridge._connected = True
+    return bridge
+
+
+@pytest.mark.asyncio
+async def test_set_and_queue_text_use_short_timeouts():
+    fake = FakeBridge()
+    bridge = _connected(fake)
+
+    assert await bridge.set_text("BUY $645.75 AMD.EU") is True
+    assert await bridge.queue_text("SELL $1,874.62 (51%) BYD.285.AS") is True
+
+    assert fake.calls == [
+        ("setText", ("BUY $645.75 AMD.EU",), LEDBridge.CALL_TIMEOUT),
+        ("queueText", ("SELL $1,874.62 (51%) BYD.285.AS",), LEDBridge.CALL_TIMEOUT),
+    ]
+    assert threading.get_ident() not in fake.threads
+
+
+@pytest.mark.asyncio
+async def test_queue_full_and_status():
+    bridge = _connected(FakeBridge(result=False))
+
+    assert await bridge.queue_text("BUY $1.00 X") is False
+    assert await bridge.text_status() == {"pending": 2, "shown": 5, "dropped": 1}
+
+
+@pytest.mark.asyncio
+async def test_slow_call_does_not_block_event_loop():
+    bridge = _connected(FakeBridge(delay=0.2))
+    ticks = 0
+
+    async def ticker():
+        nonlocal ticks
+        while True:
+            ticks += 1
+            await asyncio.sleep(0.01)
+
+    task = asyncio.create_task(ticker())
+    await bridge.set_text("BUY $645.75 AMD.EU")
+    task.cancel()
+
+    assert ticks >= 5
+
+
+@pytest.mark.asyncio
+async def test_disconnected_returns_false():
+    bridge = LEDBridge()
+
+    assert await bridge.set_text("x") is False
+    assert await bridge.queue_text("x") is False
+    assert await bridge.text_status() is None
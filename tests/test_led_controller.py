@@ -0,0 +1,77 @@
+"""Tests for the LED controller's trade queueing."""
+
+from types import SimpleNamespace
+
+import pytest
+
+from sentinel.led import controller as controller_module
+from sentinel.led.controller import LEDController
+
+
+class FakeBridge:
+    """The MCU text queue: QUEUE_LENGTH slots that scroll off as `shown` grows."""
+
+    QUEUE_LENGTH = 8
+
+    def __init__(self):
+        self.queue = []
+        self.sent = []
+
+    async def set_text(self, text):
+        self.queue = [text]
+        self.sent.append(text)
+        return True
+
+    async def queue_text(self, text):
+        if len(self.queue) >= self.QUEUE_LENGTH:
+            return False
+        self.queue.append(text)
+        self.sent.append(text)
+        return True
+
+    async def text_status(self):
+        return {"pending": len(self.queue), "shown": 0, "dropped": 0}
+
+
+def _rec(i):
+    return SimpleNamespace(action="buy", value_delta_eur=100.0 + i, current_value_eur=0, symbol=f"S{i}")
+
+
+@pytest.fixture
+def controller(monkeypatch):
+    recs = [_rec(i) for i in range(11)]
+    planner = SimpleNamespace(get_recommendations=lambda: _async(recs))
+    monkeypatch.setattr(controller_module, "Planner", lambda: planner)
+    monkeypatch.setattr(controller_module, "Settings", lambda: None)
+    ctl = LEDController()
+    ctl._bridge = FakeBridge()
+    return ctl
+
+
+async def _async(value):
+    return value
+
+
+@pytest.mark.asyncio
+async def test_trades_past_the_queue_wait_for_free_slots(controller):
+    bridge = controller._bridge
+    await controller._fetch_and_display()
+    assert len(bridge.sent) == 8
+    assert len(controller._pending) == 3
+
+    # Nothing scrolled off yet: nothing more fits.
+    await controller._top_up()
+    assert len(bridge.sent) == 8
+
+    del bridge.queue[:2]
+    await controller._top_up()
+    assert [t.split()[-1] for t in bridge.sent[8:]] == ["S8", "S9"]
+    assert len(controller._pending) == 1
+
+
+@pytest.mark.asyncio
+async def test_refresh_replaces_waiting_trades(controller):
+    await controller._fetch_and_display()
+    controller._planner.get_recommendations = lambda: _async([])
+    await controller._fetch_and_display()
+    assert controller._pending == []
@@ -0,0 +1,68 @@
+"""Tests for the LED display change events behind /api/led/events."""
+
+import inspect
+import json
+
+import pytest
+
+from sentinel.led.events import DISPLAY_JOB_SOURCES, DisplayEvents, SseParser, format_display_event, job_completed
+
+
+@pytest.mark.asyncio
+async def test_subscriber_coalesces_changes():
+    events = DisplayEvents()
+    with events.subscribe() as sub:
+        events.publish("prices")
+        events.publish("portfolio")
+        events.publish("prices")
+        assert await sub.wait(timeout=1) == ["portfolio", "prices"]
+        assert await sub.wait(timeout=0.01) == []
+
+
+@pytest.mark.asyncio
+async def test_publish_reaches_every_subscriber():
+    events = DisplayEvents()
+    with events.subscribe() as first, events.subscribe() as second:
+        assert events.subscriber_count == 2
+        events.publish("planner")
+        assert await first.wait(timeout=1) == ["planner"]
+        assert await second.wait(timeout=1) == ["planner"]
+    assert events.subscriber_count == 0
+
+
+@pytest.mark.asyncio
+async def test_job_completed_maps_display_jobs(monkeypatch):
+    events = DisplayEvents()
+    monkeypatch.setattr("sentinel.led.events.display_events", events)
+    with events.subscribe() as sub:
+        job_completed("sync:metadata")
+        assert await sub.wait(timeout=0.01) == []
+        job_completed("sync:portfolio")
+        job_completed("planning:refresh")
+        assert await sub.wait(timeout=1) == ["planner", "portfolio"]
+
+
+def test_display_event_round_trips_through_parser():
+    summary = {"value": 48210, "return_pct": 7, "has_recs": True, "broker_connected": False}
+    text = format_display_event(["prices"], summary, '"abc"')
+    parser = SseParser()
+    parsed = [e for e in (parser.feed(line) for line in text.split("\n")) if e is not None]
+    assert len(parsed) == 1
+    event, data = parsed[0]
+    assert event == "display"
+    assert json.loads(data) == {"sources": ["prices"], "etag": '"abc"', "summary": summary}
+
+
+def test_parser_skips_comments_and_joins_data_lines():
+    parser = SseParser()
+    lines = [": keepalive", "", "data: a", "data: b", ""]
+    assert [parser.feed(line) for line in lines] == [None, None, None, None, ("message", "a\nb")]
+
+
+def test_every_display_job_invalidates_the_summary():
+    # A job that publishes without invalidating would re-send the stale cached summary.
+    from sentinel.jobs.runner import TASK_REGISTRY
+
+    for job_type in DISPLAY_JOB_SOURCES:
+        task, _ = TASK_REGISTRY[job_type]
+        assert "invalidate_led_summary()" in inspect.getsource(task), job_type
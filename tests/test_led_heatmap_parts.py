@@ -0,0 +1,88 @@
+"""Tests for the NeoPixel heatmap part builder and heatmap/bin frame codec."""
+
+import pytest
+
+from sentinel.led.heatmap_parts import (
+    HEATMAP_FRAME_HEADER_SIZE,
+    HEATMAP_FRAME_MAGIC,
+    HEATMAP_FRAME_VERSION,
+    SecurityScore,
+    build_sorted_parts,
+    decode_heatmap_frame,
+    encode_heatmap_frame,
+    heatmap_before_after,
+    quantize_score,
+)
+
+
+class TestBuildSortedParts:
+    def test_counts_follow_weights_and_are_sorted(self):
+        parts = build_sorted_parts(
+            [SecurityScore("A", 0.75, 0.2), SecurityScore("B", 0.25, -0.1)],
+            total_parts=4,
+        )
+        assert parts == [-0.1, 0.2, 0.2, 0.2]
+
+    def test_empty_scores_give_zeros(self):
+        assert build_sorted_parts([], total_parts=3) == [0.0, 0.0, 0.0]
+
+
+class TestHeatmapBeforeAfter:
+    def test_after_follows_recommendations(self):
+        class Rec:
+            symbol = "B"
+            value_delta_eur = 200.0
+
+        positions = [
+            {"symbol": "A", "quantity": 10, "current_price": 30, "avg_cost": 20},
+            {"symbol": "B", "quantity": 10, "current_price": 10, "avg_cost": 20},
+        ]
+        before, after = heatmap_before_after(positions, [Rec()])
+        assert len(before) == len(after) == 40
+        # A (+50%) is 3/4 of the value before, half of it after B's buy.
+        assert before.count(0.5) == 30
+        assert after.count(0.5) == 20
+        assert after.count(-0.5) == 20
+
+    def test_no_positions_give_zeros(self):
+        assert heatmap_before_after([], []) == ([0.0] * 40, [0.0] * 40)
+
+
+class TestHeatmapFrame:
+    def test_quantize_score_clamps_to_int8_range(self):
+        assert quantize_score(0.5) == 127
+        assert quantize_score(-0.5) == -127
+        assert quantize_score(3.0) == 127
+        assert quantize_score(0.0) == 0
+
+    def test_header_and_size(self):
+        frame = encode_heatmap_frame([0.0] * 40, [0.1] * 40, flags=0x01)
+        assert len(frame) == HEATMAP_FRAME_HEADER_SIZE + 80
+        assert frame[:4] == bytes((HEATMAP_FRAME_MAGIC, HEATMAP_FRAME_VERSION, 40, 0x01))
+
+    def test_round_trip_within_one_step(self):
+        before = [-0.5 + i / 39 for i in range(40)]
+        after = list(reversed(before))
+        got_before, got_after, flags = decode_heatmap_frame(encode_heatmap_frame(before, after))
+        assert flags == 0
+        step = 0.5 / 127
+        assert all(abs(a - b) <= step / 2 + 1e-9 for a, b in zip(before, got_before, strict=True))
+        assert all(abs(a - b) <= step / 2 + 1e-9 for a, b in zip(after, got_after, strict=True))
+
+    def test_much_smaller_than_float_arrays(self):
+        from sentinel.led.msgpack_lite import packb
+
+        before = [0.123] * 40
+        after = [-0.321] * 40
+        assert len(packb(encode_heatmap_frame(before, after))) * 8 < len(packb([before, after]))
+
+    def test_rejects_mismatched_lengths(self):
+        with pytest.raises(ValueError):
+            encode_heatmap_frame([0.0] * 40, [0.0] * 39)
+
+    def test_decode_rejects_bad_frames(self):
+        frame = encode_heatmap_frame([0.0] * 40, [0.0] * 40)
+        with pytest.raises(ValueError):
+            decode_heatmap_frame(frame[:-1])
+        with pytest.raises(ValueError):
+            decode_heatmap_frame(b"X" + frame[1:])
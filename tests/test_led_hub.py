@@ -0,0 +1,186 @@
+"""Tests for the display hub behind /api/led/hub and the orbital payload it carries."""
+
+import json
+
+import pytest
+
+from sentinel.led import hub as hub_module
+from sentinel.led.events import DisplayEvents
+from sentinel.led.hub import HUB_ACK_GRACE_SECONDS, DisplayHub
+from sentinel.led.orbital import (
+    ORBIT_INNER,
+    ORBIT_OUTER,
+    ORBIT_SUN,
+    ORBITAL_MAX_BODIES,
+    PATTERN_BLINK,
+    PATTERN_BREATHE,
+    PATTERN_FADE_IN,
+    PATTERN_PULSE,
+    build_orbital_bodies,
+    encode_orbital_state,
+)
+from sentinel.led.treemap import WAVE_PULSE, WAVE_SAW_UP, TreemapHolding
+
+
+class CountingBuild:
+    def __init__(self, value=1000):
+        self.calls = 0
+        self.value = value
+        self.fail = False
+
+    async def __call__(self):
+        self.calls += 1
+        if self.fail:
+            raise RuntimeError("planner down")
+        return {"value": self.value}, {"mode_id": 0, "heatmap": "48"}
+
+
+def _event_data(bundle):
+    return json.loads(bundle.event.split("data: ", 1)[1])
+
+
+@pytest.mark.asyncio
+async def test_builds_once_for_every_unit():
+    events = DisplayEvents()
+    hub, build = DisplayHub(events), CountingBuild()
+    with hub.connect("desk"), hub.connect("shelf"):
+        first = await hub.current(build, ["connect"])
+        second = await hub.current(build, ["connect"])
+        assert first is second
+        assert build.calls == 1
+        events.publish("prices")
+        third = await hub.current(build, ["prices"])
+        assert build.calls == 2
+        # Same content: rebuilt, but not a new generation to re-send.
+        assert third is first
+        build.value = 2000
+        events.publish("portfolio")
+        fourth = await hub.current(build, ["portfolio"])
+        assert fourth.generation == first.generation + 1
+        assert _event_data(fourth)["summary"] == {"value": 2000}
+        assert _event_data(fourth)["sources"] == ["portfolio"]
+
+
+@pytest.mark.asyncio
+async def test_failed_rebuild_keeps_bundle():
+    events = DisplayEvents()
+    hub, build = DisplayHub(events), CountingBuild()
+    first = await hub.current(build, ["connect"])
+    build.fail = True
+    events.publish("prices")
+    assert await hub.current(build, ["prices"]) is first
+    # A failure counts as this version's build; the next change retries.
+    assert await hub.current(build, ["prices"]) is first
+    assert build.calls == 2
+
+
+@pytest.mark.asyncio
+async def test_first_build_failure_raises():
+    hub, build = DisplayHub(DisplayEvents()), CountingBuild()
+    build.fail = True
+    with pytest.raises(RuntimeError):
+        await hub.current(build, ["connect"])
+
+
+@pytest.mark.asyncio
+async def test_rebuilds_after_ttl(monkeypatch):
+    events = DisplayEvents()
+    hub, build = DisplayHub(events), CountingBuild()
+    now = [1000.0]
+    monkeypatch.setattr(hub_module.time, "time", lambda: now[0])
+    await hub.current(build, ["connect"])
+    now[0] += hub_module.HUB_REBUILD_SECONDS + 1
+    await hub.current(build, ["connect"])
+    assert build.calls == 2
+
+
+@pytest.mark.asyncio
+async def test_unit_delivery_ack_and_status(monkeypatch):
+    hub, build = DisplayHub(DisplayEvents()), CountingBuild()
+    now = [1000.0]
+    monkeypatch.setattr(hub_module.time, "time", lambda: now[0])
+    with hub.connect("desk") as unit:
+        bundle = await hub.current(build, ["connect"])
+        hub.delivered(unit, bundle)
+        assert unit.status(now[0]) == "ok"
+        now[0] += HUB_ACK_GRACE_SECONDS + 1
+        assert unit.status(now[0]) == "lagging"
+        # An ack cannot claim more than was delivered.
+        hub.ack("desk", {"generation": bundle.generation + 5, "applied_seq": 7, "bridge_ok": True, "mode_id": 2})
+        assert unit.acked_generation == bundle.generation
+        assert unit.status(now[0]) == "ok"
+        hub.ack("desk", {"generation": bundle.generation, "bridge_ok": False, "error": "timeout"})
+        assert unit.status(now[0]) == "failing"
+        status = hub.status()
+        assert status["generation"] == bundle.generation
+        assert status["units"][0]["applied_seq"] == 7
+        assert status["units"][0]["last_error"] == "timeout"
+        assert not hub.forget("desk")
+    assert unit.status(now[0]) == "offline"
+    assert hub.ack("nobody", {}) is None
+    assert hub.forget("desk")
+    assert hub.status()["units"] == []
+
+
+@pytest.mark.asyncio
+async def test_build_hub_payloads_runs_the_planner_once(monkeypatch):
+    from sentinel.led import summary as summary_module
+
+    runs, passed = [], []
+
+    async def fake_recommendations(db, broker, settings, currency):
+        runs.append(True)
+        return []
+
+    async def fake_build(db, broker, settings, currency, recommendations=None):
+        passed.append(recommendations)
+        return {"value": 1000, "return_pct": 0, "has_recs": bool(recommendations)}
+
+    class FakeDb:
+        async def get_all_positions(self):
+            return []
+
+    monkeypatch.setattr(summary_module, "led_recommendations", fake_recommendations)
+    monkeypatch.setattr(summary_module, "_build", fake_build)
+    summary_module.invalidate_led_summary()
+    try:
+        broker = type("Broker", (), {"connected": True})()
+        summary, payloads = await hub_module.build_hub_payloads(FakeDb(), broker, None, None, 0)
+    finally:
+        summary_module.invalidate_led_summary()
+    assert runs == [True]
+    assert passed == [[]]
+    assert summary["has_recs"] is False
+    assert set(payloads) == {"mode_id", "heatmap", "orbital", "treemap"}
+
+
+class TestOrbital:
+    def test_sun_then_alternating_rings(self):
+        holdings = [TreemapHolding(f"S{i}", 100 - i) for i in range(8)]
+        bodies = build_orbital_bodies(holdings)
+        assert [b.orbit for b in bodies] == [ORBIT_SUN] * 4 + [ORBIT_INNER, ORBIT_OUTER] * 2
+        assert len({b.id for b in bodies}) == len(bodies)
+
+    def test_patterns(self):
+        bodies = build_orbital_bodies(
+            [
+                TreemapHolding("A", 4, wave=WAVE_PULSE),
+                TreemapHolding("B", 3, wave=WAVE_SAW_UP),
+                TreemapHolding("C", 2, pnl_pct=-12),
+                TreemapHolding("D", 1),
+            ]
+        )
+        assert [b.pattern for b in bodies] == [PATTERN_BLINK, PATTERN_FADE_IN, PATTERN_PULSE, PATTERN_BREATHE]
+
+    def test_ids_are_stable(self):
+        few = {b.symbol: b.id for b in build_orbital_bodies([TreemapHolding("AAPL", 2), TreemapHolding("MSFT", 1)])}
+        more = build_orbital_bodies([TreemapHolding("MSFT", 5), TreemapHolding("AAPL", 2), TreemapHolding("X", 1)])
+        assert {b.symbol: b.id for b in more if b.symbol in few} == few
+
+    def test_encode_caps_and_layout(self):
+        bodies = build_orbital_bodies([TreemapHolding(f"S{i}", 100 - i) for i in range(60)])
+        assert len(bodies) == ORBITAL_MAX_BODIES
+        state = encode_orbital_state(bodies)
+        assert state[0] == ORBITAL_MAX_BODIES
+        assert len(state) == 1 + 3 * ORBITAL_MAX_BODIES
+        assert tuple(state[1:4]) == (bodies[0].id, bodies[0].pattern, bodies[0].orbit)
@@ -0,0 +1,224 @@
+"""Tests for the bridge RPC record/replay load-test harness."""
+
+import asyncio
+import io
+import os
+import shutil
+import struct
+import tempfile
+
+import pytest
+
+from sentinel.led import msgpack_lite as msgpack
+from sentinel.led.anim import crc16_ccitt
+from sentinel.led.arduino_router_rpc import NOTIFY, REQUEST, RESPONSE, AsyncMsgpackRpc
+from sentinel.led.rpc_bench import (
+    DEFAULT_MIX,
+    MCU_STATS_FIELDS,
+    RecordingProxy,
+    TraceEvent,
+    combine_mcu_stats,
+    dump_event,
+    encode_hm_frame,
+    format_report,
+    load_event,
+    parse_mix,
+    percentile,
+    replay_schedule,
+    reseq_hm_frame,
+    run_load,
+    synthetic_schedule,
+)
+
+
+class FakeBoard:
+    """arduino-router with an MCU behind it: applies hm.b frames, losing the seqs in `drop`."""
+
+    def __init__(self, drop=()):
+        self.applied = 0
+        self.skipped = 0
+        self.drop = set(drop)
+        self.decoded = 0
+        self.calls = []
+        self.writers = []
+
+    def handle(self, method, params):
+        self.calls.append(method)
+        if method == "hm.s":
+            return [self.applied, 0, self.skipped]
+        if method == "diag/stats":
+            stats = [1000] * len(MCU_STATS_FIELDS)
+            stats[MCU_STATS_FIELDS.index("rpc_decoded")] = self.decoded
+            self.decoded = 0
+            return stats
+        self.decoded += 1
+        if method == "hm.b":
+            seq = struct.unpack_from("<I", params[0], 8)[0]
+            if seq in self.drop:
+                return None
+            if self.applied and seq > self.applied + 1:
+                self.skipped += seq - self.applied - 1
+            self.applied = seq
+        return True
+
+    async def serve(self, reader, writer):
+        self.writers.append(writer)
+        unpacker = msgpack.Unpacker()
+        while True:
+            data = await reader.read(4096)
+            if not data:
+                return
+            unpacker.feed(data)
+            for msg in unpacker:
+                if msg[0] == REQUEST:
+                    writer.write(msgpack.packb([RESPONSE, msg[1], None, self.handle(msg[2], msg[3])]))
+                elif msg[0] == NOTIFY:
+                    self.handle(msg[1], msg[2])
+            await writer.drain()
+
+
+async def _with_board(board, body):
+    tmpdir = tempfile.mkdtemp()
+    path = os.path.join(tmpdir, "router.sock")
+    server = await asyncio.start_unix_server(board.serve, path=path)
+    try:
+        return await body(tmpdir, path)
+    finally:
+        for writer in board.writers:
+            writer.close()
+        server.close()
+        await server.wait_closed()
+        await asyncio.sleep(0.01)
+        shutil.rmtree(tmpdir, ignore_errors=True)
+
+
+def test_percentile_nearest_rank():
+    values = list(range(1, 101))
+    assert percentile(values, 50) == 50
+    assert percentile(values, 99) == 99
+    assert percentile([5.0], 99) == 5.0
+    assert percentile([], 50) is None
+
+
+def test_trace_round_trip_keeps_bins():
+    ev = TraceEvent(1.5, "out", "call", "updateState", [b"\x01\x02\x03\x04"])
+    assert load_event(dump_event(ev)) == ev
+    res = TraceEvent(1.6, "in", "result", "heatmap/bin", result=b"\x48\x01", rtt_ms=3.0)
+    assert load_event(dump_event(res)) == res
+
+
+def test_replay_schedule_scales_and_skips_board_calls():
+    events = [
+        TraceEvent(10.0, "out", "call", "$/register", ["heatmap/bin"]),
+        TraceEvent(10.0, "out", "call", "hm.b", [b"x"]),
+        TraceEvent(12.0, "in", "call", "heatmap/bin", []),
+        TraceEvent(20.0, "out", "notify", "heatmap/changed", []),
+    ]
+    ops = replay_schedule(events, speed=1000)
+    assert [(op.at, op.method, op.notify) for op in ops] == [(0.0, "hm.b", False), (0.01, "heatmap/changed", True)]
+    with pytest.raises(ValueError):
+        replay_schedule(events, speed=1001)
+
+
+def test_synthetic_schedule_is_seeded():
+    ops = synthetic_schedule(DEFAULT_MIX, rate=100, duration=2, seed=7)
+    assert len(ops) == 200
+    assert ops[1].at == pytest.approx(0.01)
+    assert {op.method for op in ops} == set(DEFAULT_MIX)
+    assert ops == synthetic_schedule(DEFAULT_MIX, rate=100, duration=2, seed=7)
+    with pytest.raises(ValueError):
+        parse_mix("hm.b=1,frobnicate=2")
+
+
+def test_reseq_hm_frame_rewrites_crc():
+    frame = reseq_hm_frame(encode_hm_frame(1234, -5, 3, 0), 42)
+    assert struct.unpack_from("<I", frame, 8)[0] == 42
+    assert struct.unpack_from("<H", frame, 12)[0] == crc16_ccitt(frame[:12])
+
+
+def test_combine_mcu_stats():
+    a = dict.fromkeys(MCU_STATS_FIELDS, 0) | {"window_ms": 1000, "render_mean_us": 100, "render_max_us": 300}
+    b = dict(a) | {"window_ms": 3000, "render_mean_us": 200, "render_max_us": 200, "rpc_rejected": 2}
+    total = combine_mcu_stats([a, b])
+    assert total["window_ms"] == 4000
+    assert total["render_mean_us"] == 175
+    assert total["render_max_us"] == 300
+    assert total["rpc_rejected"] == 2
+
+
+@pytest.mark.asyncio
+async def test_run_load_reports_latency_and_drops():
+    board = FakeBoard(drop={3})
+
+    async def body(tmpdir, path):
+        rpc = AsyncMsgpackRpc(path)
+        await rpc.connect()
+        try:
+            ops = synthetic_schedule({"hm.b": 3, "setBrightness": 1}, rate=400, duration=0.1, seed=1)
+            return await run_load(rpc, ops, stats_interval=0.05, settle=0)
+        finally:
+            await rpc.close()
+
+    report = await _with_board(board, body)
+    assert report["ops"] == 40
+    assert report["errors"] == report["timeouts"] == 0
+    assert report["rtt_ms"]["p50"] is not None
+    assert report["rtt_ms"]["p50"] <= report["rtt_ms"]["p99"] <= report["rtt_ms"]["max"]
+    assert set(report["by_method"]) == {"hm.b", "setBrightness"}
+    # Seq 3 never applied: skipped when seq 4 arrived.
+    assert report["dropped_frames"] == 1
+    assert report["mcu"]["rpc_decoded"] == 40
+    assert sum(w["calls"] for w in report["windows"]) == 40
+    assert "rtt p99 ms" in format_report(report, report)
+
+
+@pytest.mark.asyncio
+async def test_run_load_counts_every_skipped_frame():
+    board = FakeBoard(drop={3, 4, 5, 9})
+
+    async def body(tmpdir, path):
+        rpc = AsyncMsgpackRpc(path)
+        await rpc.connect()
+        try:
+            ops = synthetic_schedule({"hm.b": 1}, rate=400, duration=0.03, seed=1)
+            return await run_load(rpc, ops, stats_interval=0.05, settle=0)
+        finally:
+            await rpc.close()
+
+    report = await _with_board(board, body)
+    assert report["ops"] == 12
+    # Two jumps ahead (2 -> 6, 8 -> 10), but four frames lost.
+    assert board.skipped == 4
+    assert report["dropped_frames"] == 4
+
+
+@pytest.mark.asyncio
+async def test_recording_proxy_captures_calls_and_results():
+    board = FakeBoard()
+    trace = io.StringIO()
+
+    async def body(tmpdir, path):
+        listen = os.path.join(tmpdir, "record.sock")
+        proxy = RecordingProxy(listen, path, trace)
+        await proxy.start()
+        rpc = AsyncMsgpackRpc(listen)
+        await rpc.connect()
+        try:
+            await rpc.call("setBrightness", 80, timeout=2)
+            await rpc.call("diag/stats", timeout=2)  # not a recorded method
+            await rpc.notify("heatmap/changed")
+            await asyncio.sleep(0.05)
+        finally:
+            await rpc.close()
+            await proxy.close()
+
+    await _with_board(board, body)
+    events = [load_event(line) for line in trace.getvalue().splitlines()]
+    assert [(e.dir, e.kind, e.method) for e in events] == [
+        ("out", "call", "setBrightness"),
+        ("out", "result", "setBrightness"),
+        ("out", "notify", "heatmap/changed"),
+    ]
+    assert events[0].params == [80]
+    assert events[1].result is True and events[1].rtt_ms >= 0
+    assert board.calls == ["setBrightness", "diag/stats", "heatmap/changed"]
@@ -0,0 +1,127 @@
+"""Tests for the LED treemap layout and updateTreemap frame codec."""
+
+from types import SimpleNamespace
+
+import pytest
+
+from sentinel.led.treemap import (
+    MATRIX_HEIGHT,
+    MATRIX_WIDTH,
+    TREEMAP_FRAME_HEADER_SIZE,
+    TREEMAP_FRAME_MAGIC,
+    TREEMAP_MAX_REGIONS,
+    TREEMAP_REGION_SIZE,
+    URGENCY_LOW,
+    URGENCY_URGENT,
+    WAVE_PULSE,
+    WAVE_SAW_DOWN,
+    WAVE_SAW_UP,
+    WAVE_SINE,
+    TreemapHolding,
+    TreemapRegion,
+    build_holdings,
+    decode_treemap_frame,
+    encode_treemap_frame,
+    layout_treemap,
+    pnl_band,
+)
+
+
+def _coverage(regions):
+    grid = [[None] * MATRIX_WIDTH for _ in range(MATRIX_HEIGHT)]
+    for i, r in enumerate(regions):
+        for y in range(r.y, r.y + r.h):
+            for x in range(r.x, r.x + r.w):
+                assert grid[y][x] is None, f"regions overlap at ({x}, {y})"
+                grid[y][x] = i
+    return grid
+
+
+class TestLayout:
+    def test_regions_tile_the_matrix(self):
+        weights = [30, 20, 12, 10, 8, 6, 5, 4, 2, 1, 1]
+        regions = layout_treemap([TreemapHolding(f"S{i}", w) for i, w in enumerate(weights)])
+
+        grid = _coverage(regions)
+        assert all(cell is not None for row in grid for cell in row)
+
+    def test_larger_weight_gets_more_pixels(self):
+        regions = layout_treemap([TreemapHolding("BIG", 3.0), TreemapHolding("SMALL", 1.0)])
+        area = {r.symbol: r.w * r.h for r in regions}
+        assert area["BIG"] > area["SMALL"]
+        assert area["BIG"] + area["SMALL"] == MATRIX_WIDTH * MATRIX_HEIGHT
+
+    def test_many_holdings_fold_into_other(self):
+        holdings = [TreemapHolding(f"S{i}", 100 - i) for i in range(60)]
+        regions = layout_treemap(holdings)
+        assert len(regions) <= TREEMAP_MAX_REGIONS
+        assert regions[-1].symbol == "OTHER" or all(r.symbol != "OTHER" for r in regions)
+
+    def test_empty_portfolio_has_no_regions(self):
+        assert layout_treemap([]) == []
+        assert layout_treemap([TreemapHolding("ZERO", 0.0)]) == []
+
+
+class TestPnlBand:
+    def test_band_edges_follow_readme(self):
+        assert pnl_band(-35.0) == 0
+        assert pnl_band(-15.0) == 1
+        assert pnl_band(-1.0) == 3
+        assert pnl_band(0.0) == 4
+        assert pnl_band(7.0) == 5
+        assert pnl_band(25.0) == 7
+
+
+class TestFrame:
+    def test_round_trip(self):
+        regions = [
+            TreemapRegion("A", 0, 0, 6, 8, WAVE_SINE, URGENCY_LOW, 7, 0),
+            TreemapRegion("B", 6, 0, 7, 8, WAVE_PULSE, URGENCY_URGENT, 0, 31),
+        ]
+        frame = encode_treemap_frame(regions)
+        assert frame[:3] == bytes((TREEMAP_FRAME_MAGIC, 1, 2))
+        assert len(frame) == TREEMAP_FRAME_HEADER_SIZE + 2 * TREEMAP_REGION_SIZE
+        assert frame[3:7] == bytes((0x05, 0x07, 0x00, 0xE0))
+
+        decoded = decode_treemap_frame(frame)
+        assert [(r.x, r.y, r.w, r.h, r.wave, r.urgency, r.band, r.phase) for r in decoded] == [
+            (0, 0, 6, 8, WAVE_SINE, URGENCY_LOW, 7, 0),
+            (6, 0, 7, 8, WAVE_PULSE, URGENCY_URGENT, 0, 31),
+        ]
+
+    def test_max_frame_fits_packet(self):
+        regions = [TreemapRegion("X", 0, 0, 1, 1, 0, 0, 0, 0)] * TREEMAP_MAX_REGIONS
+        assert len(encode_treemap_frame(regions)) < 128
+
+    def test_rejects_out_of_bounds_region(self):
+        with pytest.raises(ValueError):
+            encode_treemap_frame([TreemapRegion("X", 10, 0, 4, 1, 0, 0, 0, 0)])
+
+    def test_decode_rejects_bad_length(self):
+        with pytest.raises(ValueError):
+            decode_treemap_frame(bytes((TREEMAP_FRAME_MAGIC, 1, 2, 0, 0, 0, 0)))
+
+
+class TestBuildHoldings:
+    def test_actions_map_to_waveforms(self):
+        positions = [
+            {"symbol": "HOLD", "quantity": 10, "current_price": 12.0, "avg_cost": 10.0},
+            {"symbol": "BUY", "quantity": 5, "current_price": 10.0, "avg_cost": 10.0},
+            {"symbol": "SELL", "quantity": 5, "current_price": 8.0, "avg_cost": 10.0},
+            {"symbol": "CASH", "quantity": 1, "current_price": 50.0, "avg_cost": 50.0},
+        ]
+        recs = [
+            SimpleNamespace(symbol="BUY", action="buy", priority=5.0, reason_code=None),
+            SimpleNamespace(symbol="SELL", action="sell", priority=2.0, reason_code=None),
+            SimpleNamespace(symbol="CASH", action="sell", priority=1000, reason_code=None),
+        ]
+        holdings = {h.symbol: h for h in build_holdings(positions, recs)}
+
+        assert holdings["HOLD"].wave == WAVE_SINE
+        assert holdings["HOLD"].urgency == URGENCY_LOW
+        assert holdings["HOLD"].weight == pytest.approx(120.0)
+        assert holdings["HOLD"].pnl_pct == pytest.approx(20.0)
+        assert holdings["BUY"].wave == WAVE_SAW_UP
+        assert holdings["SELL"].wave == WAVE_SAW_DOWN
+        assert holdings["BUY"].urgency > holdings["SELL"].urgency
+        assert (holdings["CASH"].wave, holdings["CASH"].urgency) == (WAVE_PULSE, URGENCY_URGENT)
@@ -0,0 +1,150 @@
+"""Tests for the msgpack_lite encoder/decoders used on the arduino-router socket."""
+
+import time
+
+import pytest
+
+from sentinel.led import msgpack_lite as msgpack
+
+SAMPLES = [
+    None,
+    True,
+    False,
+    0,
+    127,
+    -32,
+    255,
+    65535,
+    2**32 + 1,
+    -129,
+    -(2**40),
+    1.5,
+    "",
+    "heatmap/get",
+    "x" * 300,
+    b"",
+    b"\x01\x02",
+    bytes(300),
+    list(range(20)),
+    {"a": 1, "b": [1, 2, {"c": None}]},
+    [0, 7, "hm.b", [b"\x01" * 14]],
+]
+
+
+def _decode_all(unpacker, data: bytes) -> list:
+    unpacker.feed(data)
+    return list(unpacker)
+
+
+def _as_bytes(obj):
+    if isinstance(obj, memoryview):
+        return obj.tobytes()
+    if isinstance(obj, list):
+        return [_as_bytes(x) for x in obj]
+    if isinstance(obj, dict):
+        return {k: _as_bytes(v) for k, v in obj.items()}
+    return obj
+
+
+class TestRoundTrip:
+    @pytest.mark.parametrize("obj", SAMPLES)
+    def test_unpacker(self, obj):
+        assert _decode_all(msgpack.Unpacker(), msgpack.packb(obj)) == [obj]
+
+    @pytest.mark.parametrize("obj", SAMPLES)
+    def test_stream_unpacker(self, obj):
+        got = _decode_all(msgpack.StreamUnpacker(), msgpack.packb(obj))
+        assert [_as_bytes(x) for x in got] == [obj]
+
+
+class TestStreamUnpacker:
+    def test_bin_is_a_view_into_the_fed_chunk(self):
+        data = msgpack.packb([b"abc", b"de"])
+        u = msgpack.StreamUnpacker()
+        (msg,) = _decode_all(u, data)
+        assert isinstance(msg[0], memoryview)
+        assert msg[0].readonly
+        assert msg[0].obj is data
+        assert msg[0] == b"abc"
+
+    def test_copy_mode_returns_bytes(self):
+        (msg,) = _decode_all(msgpack.StreamUnpacker(zero_copy=False), msgpack.packb(b"abc"))
+        assert isinstance(msg, bytes)
+
+    def test_split_feeds_and_views_survive_later_feeds(self):
+        data = msgpack.packb([1, b"first"]) + msgpack.packb([2, b"second"])
+        u = msgpack.StreamUnpacker()
+        out = []
+        for i in range(len(data)):
+            u.feed(data[i : i + 1])
+            out.extend(u)
+        u.feed(msgpack.packb("tail"))
+        out.extend(u)
+        assert [_as_bytes(m) for m in out] == [[1, b"first"], [2, b"second"], "tail"]
+
+
+class TestPackInto:
+    def test_writes_at_offset_and_returns_end(self):
+        buf = bytearray(64)
+        end = msgpack.pack_into(buf, [1, "a"], offset=4)
+        assert bytes(buf[4:end]) == msgpack.packb([1, "a"])
+
+    def test_too_small_raises(self):
+        with pytest.raises(ValueError):
+            msgpack.pack_into(bytearray(4), "longer than four bytes")
+
+    def test_packer_reuses_its_buffer(self):
+        packer = msgpack.Packer()
+        first = packer.pack([1, 2, 3]).tobytes()
+        second = packer.pack(bytes(100)).tobytes()
+        assert first == msgpack.packb([1, 2, 3])
+        assert second == msgpack.packb(bytes(100))
+
+    def test_packer_tolerates_a_held_view(self):
+        packer = msgpack.Packer()
+        held = packer.pack("first")
+        assert packer.pack("second").tobytes() == msgpack.packb("second")
+        assert held.tobytes() == msgpack.packb("first")
+
+
+def test_streaming_decode_benchmark():
+    """Micro-benchmark: router-style traffic through both decoders.
+
+    Prints timings (run with -s); only correctness is asserted, because wall
+    time on shared CI is too noisy to gate on.
+    """
+    msgs = [[1, i, None, [b"\x01" * 84, "ok", i * 1.5]] for i in range(200)]
+    stream = b"".join(msgpack.packb(m) for m in msgs)
+    chunks = [stream[i : i + 512] for i in range(0, len(stream), 512)]
+    rounds = 20
+
+    def run(make):
+        count = 0
+        start = time.perf_counter()
+        for _ in range(rounds):
+            u = make()
+            for c in chunks:
+                u.feed(c)
+                for _msg in u:
+                    count += 1
+        return time.perf_counter() - start, count
+
+    legacy_s, legacy_n = run(msgpack.Unpacker)
+    stream_s, stream_n = run(msgpack.StreamUnpacker)
+    assert legacy_n == stream_n == len(msgs) * rounds
+
+    packer = msgpack.Packer()
+    start = time.perf_counter()
+    for m in msgs * rounds:
+        msgpack.packb(m)
+    packb_s = time.perf_counter() - start
+    start = time.perf_counter()
+    for m in msgs * rounds:
+        packer.pack(m)
+    packer_s = time.perf_counter() - start
+
+    print(
+        f"\nunpack: Unpacker {legacy_s * 1e3:.1f} ms, StreamUnpacker {stream_s * 1e3:.1f} ms; "
+        f"pack: packb {packb_s * 1e3:.1f} ms, Packer {packer_s * 1e3:.1f} ms "
+        f"({len(msgs) * rounds} messages)"
+    )